@@ -7,7 +7,9 @@
 #ifndef OWT_QUIC_TRANSPORT_FACTORY_H_
 #define OWT_QUIC_TRANSPORT_FACTORY_H_
 
+#include <cstddef>
 #include "owt/quic/export.h"
+#include "owt/quic/quic_transport_server_interface.h"
 
 namespace owt {
 namespace quic {
@@ -38,6 +40,47 @@ class OWT_EXPORT QuicTransportFactory {
       int port,
       const char* pfx_path,
       const char* password) = 0;
+  // Create a server directly over Quic with certificate, key and secret file,
+  // and `options`. A sharded server is created if `options.io_thread_count` is
+  // greater than 1, see CreateShardedQuicTransportServer. Ownership of returned
+  // value is moved to caller. Returns nullptr if creation is failed.
+  virtual QuicTransportServerInterface* CreateQuicTransportServer(
+      int port,
+      const char* cert_file,
+      const char* key_file,
+      const char* secret_path,
+      const ServerOptions& options) = 0;
+  // Create a server directly over Quic with pkcs12 file and `options`. See the
+  // overload above.
+  virtual QuicTransportServerInterface* CreateQuicTransportServer(
+      int port,
+      const char* pfx_path,
+      const char* password,
+      const ServerOptions& options) = 0;
+  // Create a server directly over Quic which processes packets on
+  // `io_thread_count` IO threads. Each thread has its own socket listening on
+  // `port` with SO_REUSEPORT, and its own Quic dispatcher and crypto config.
+  // The kernel distributes packets among threads. Connection IDs issued by the
+  // server identify the owning thread, so packets are still processed by the
+  // owner after a client's address changes. Sessions of all threads are
+  // reported to the same visitor. Only IETF Quic versions are accepted. A
+  // single thread server is created if `io_thread_count` is less than 2 or the
+  // platform doesn't support SO_REUSEPORT. At most 256 threads are supported.
+  // Ownership of returned value is moved to caller. Returns nullptr if
+  // creation is failed.
+  virtual QuicTransportServerInterface* CreateShardedQuicTransportServer(
+      int port,
+      size_t io_thread_count,
+      const char* cert_file,
+      const char* key_file,
+      const char* secret_path) = 0;
+  // Create a server directly over Quic with pkcs12 file, which processes
+  // packets on `io_thread_count` IO threads. See the overload above.
+  virtual QuicTransportServerInterface* CreateShardedQuicTransportServer(
+      int port,
+      size_t io_thread_count,
+      const char* pfx_path,
+      const char* password) = 0;
   // Create a Quic client. It will not connect to the given
   // `url` immediately after creation.
   virtual QuicTransportClientInterface* CreateQuicTransportClient(
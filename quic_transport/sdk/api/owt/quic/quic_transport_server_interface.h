@@ -7,11 +7,117 @@
 #ifndef OWT_QUIC_TRANSPORT_SERVER_INTERFACE_H_
 #define OWT_QUIC_TRANSPORT_SERVER_INTERFACE_H_
 
+#include <cstddef>
+#include <cstdint>
 #include "owt/quic/export.h"
 #include "owt/quic/quic_transport_session_interface.h"
 
 namespace owt {
 namespace quic {
+// Stats for a server's UDP socket and handshakes.
+struct OWT_EXPORT ServerStats {
+  // Maximum number of packets read by one system call.
+  uint32_t packet_read_batch_size;
+  // Packets read from the socket.
+  uint64_t packets_read;
+  // System calls made to read packets.
+  uint64_t packet_read_calls;
+  // Packets forwarded to other shards of a sharded server, because their
+  // connections are owned by other shards. Always 0 for unsharded servers.
+  uint64_t packets_forwarded;
+  // Completed handshakes without session resumption.
+  uint64_t full_handshakes;
+  // Completed handshakes resuming a session with a ticket. They don't need a
+  // signature.
+  uint64_t resumed_handshakes;
+  // Resumed handshakes whose 0-RTT data is accepted.
+  uint64_t zero_rtt_handshakes;
+  // Handshake signatures waiting for or running on the thread pool. Always 0
+  // when ServerOptions::async_signing is false.
+  uint32_t pending_signatures;
+  // Handshake signatures computed on the thread pool.
+  uint64_t signatures_computed;
+  // Sum of signing latencies in microseconds, including time waiting for a
+  // worker. signing_time_us / signatures_computed is the average latency.
+  uint64_t signing_time_us;
+};
+
+// Options of a server. They are applied when the server is created. Numeric
+// options set to 0 keep the SDK's default values, which are sized for a few
+// connections. Servers handling many connections usually need larger socket
+// buffers and read budgets.
+struct OWT_EXPORT ServerOptions {
+  ServerOptions()
+      : io_thread_count(1),
+        initial_session_flow_control_window(0),
+        initial_stream_flow_control_window(0),
+        socket_receive_buffer_size(0),
+        socket_send_buffer_size(0),
+        max_reads_per_event(0),
+        max_new_connections_per_event(0),
+        max_incoming_bidirectional_streams(0),
+        max_incoming_unidirectional_streams(0),
+        idle_timeout_ms(0),
+        max_packet_size(0),
+        packet_read_batch_size(0),
+        udp_gro_enabled(false),
+        drain_timeout_ms(0),
+        async_signing(true),
+        session_tickets_enabled(true),
+        session_ticket_key_file(nullptr),
+        zero_rtt_enabled(true) {}
+  // Number of IO threads processing packets. See
+  // QuicTransportFactory::CreateShardedQuicTransportServer.
+  size_t io_thread_count;
+  // Flow control windows advertised to clients in bytes. Default values are 1
+  // MB for a session and 64 KB for a stream.
+  uint32_t initial_session_flow_control_window;
+  uint32_t initial_stream_flow_control_window;
+  // Socket buffer sizes in bytes. Default values are 1 MB on Linux.
+  uint32_t socket_receive_buffer_size;
+  uint32_t socket_send_buffer_size;
+  // Maximum number of packets read each time the socket becomes readable.
+  // Default value is 32.
+  uint32_t max_reads_per_event;
+  // Maximum number of connections created each time the socket becomes
+  // readable. Other new connections wait for next time. Default value is 16.
+  uint32_t max_new_connections_per_event;
+  // Maximum number of streams a client can open concurrently in a session.
+  // Default values are chosen by Quic stack.
+  uint32_t max_incoming_bidirectional_streams;
+  uint32_t max_incoming_unidirectional_streams;
+  // A connection is closed when it's idle for this period. Default value is
+  // chosen by Quic stack.
+  uint32_t idle_timeout_ms;
+  // Maximum size of packets sent by the server in bytes, excluding IP and UDP
+  // headers. Default value is chosen by Quic stack.
+  uint32_t max_packet_size;
+  // See QuicTransportServerInterface::SetPacketReadBatchSize.
+  uint32_t packet_read_batch_size;
+  // See QuicTransportServerInterface::SetUdpGroEnabled.
+  bool udp_gro_enabled;
+  // Time in milliseconds existing sessions have to finish after
+  // QuicTransportServerInterface::Stop is called. Sessions still open are
+  // closed afterwards. Default value is 10 seconds.
+  uint32_t drain_timeout_ms;
+  // Computes handshake signatures on a thread pool instead of IO thread, so
+  // expensive RSA or ECDSA operations don't delay packets of established
+  // sessions.
+  bool async_signing;
+  // Issues TLS session tickets, so returning clients resume their sessions
+  // without a new signature.
+  bool session_tickets_enabled;
+  // Path of a file with session ticket keys shared by servers in different
+  // processes. Each line is a 16 bytes key in hex, and the first one encrypts
+  // new tickets. The file is read again when it's modified. If it's nullptr,
+  // random keys are generated and rotated every 12 hours.
+  const char* session_ticket_key_file;
+  // Accepts 0-RTT data from resumed clients. Such data can be replayed, so
+  // applications should only act on idempotent requests before the handshake
+  // completes.
+  bool zero_rtt_enabled;
+};
+
 // A server accepts direct Quic connections.
 class OWT_EXPORT QuicTransportServerInterface {
  public:
@@ -27,9 +133,24 @@ class OWT_EXPORT QuicTransportServerInterface {
   };
   virtual ~QuicTransportServerInterface() = default;
   virtual int Start() = 0;
+  // Stops accepting new connections. Sessions still open after
+  // ServerOptions::drain_timeout_ms are closed. Visitor::OnEnded is called when
+  // all sessions are closed.
   virtual void Stop() = 0;
   virtual void SetVisitor(Visitor* visitor) = 0;
   virtual int GetListenPort() = 0;
+  // Sets the maximum number of packets read from the socket by one system call.
+  // It must be called before Start. Default value is 16. Platforms without
+  // recvmmsg always read one packet at a time.
+  virtual void SetPacketReadBatchSize(uint32_t batch_size) = 0;
+  // Enables or disables UDP GRO on the server's socket. It must be called
+  // before Start. It's disabled by default. When enabled, the kernel may
+  // coalesce datagrams from the same client, which are split into QUIC packets
+  // before processing. Ignored if the platform doesn't support it.
+  virtual void SetUdpGroEnabled(bool enabled) = 0;
+  // Gets a snapshot of stats of the server's socket. It may block the calling
+  // thread until IO thread collects stats.
+  virtual ServerStats GetStats() = 0;
 };
 }  // namespace quic
 }
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_QUIC_TRANSPORT_ASYNC_PROOF_SOURCE_H_
+#define OWT_QUIC_TRANSPORT_ASYNC_PROOF_SOURCE_H_
+
+#include <memory>
+#include <string>
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "net/third_party/quiche/src/quiche/quic/core/crypto/proof_source.h"
+
+namespace net {
+
+// Wraps a proof source, and signs with it on the thread pool. Results are
+// posted back to the thread calling GetProof or ComputeTlsSignature, so a
+// handshake waiting for its signature doesn't block packet processing of other
+// connections. The wrapped proof source must be thread safe for signing.
+// Other methods are forwarded synchronously. Only used on IO thread.
+class AsyncProofSource : public quic::ProofSource {
+ public:
+  explicit AsyncProofSource(std::unique_ptr<quic::ProofSource> proof_source);
+  ~AsyncProofSource() override;
+  AsyncProofSource(const AsyncProofSource&) = delete;
+  AsyncProofSource& operator=(const AsyncProofSource&) = delete;
+
+  // Overrides quic::ProofSource.
+  void GetProof(const quic::QuicSocketAddress& server_address,
+                const quic::QuicSocketAddress& client_address,
+                const std::string& hostname,
+                const std::string& server_config,
+                quic::QuicTransportVersion quic_version,
+                absl::string_view chlo_hash,
+                std::unique_ptr<Callback> callback) override;
+
+  quiche::QuicheReferenceCountedPointer<quic::ProofSource::Chain> GetCertChain(
+      const quic::QuicSocketAddress& server_address,
+      const quic::QuicSocketAddress& client_address,
+      const std::string& hostname,
+      bool* cert_matched_sni) override;
+
+  void ComputeTlsSignature(
+      const quic::QuicSocketAddress& server_address,
+      const quic::QuicSocketAddress& client_address,
+      const std::string& hostname,
+      uint16_t signature_algorithm,
+      absl::string_view in,
+      std::unique_ptr<SignatureCallback> callback) override;
+
+  absl::InlinedVector<uint16_t, 8> SupportedTlsSignatureAlgorithms()
+      const override;
+
+  TicketCrypter* GetTicketCrypter() override;
+
+  // Signing operations queued or running on the thread pool.
+  uint32_t pending_signatures() const { return pending_signatures_; }
+  // Signing operations finished, successful or not.
+  uint64_t signatures_computed() const { return signatures_computed_; }
+  // Sum of the time from requesting a signature to getting its result on IO
+  // thread, including time waiting for a worker.
+  base::TimeDelta total_signing_time() const { return total_signing_time_; }
+
+ private:
+  class PostingCallback;
+  class PostingSignatureCallback;
+  // Owns the wrapped proof source. Signing tasks keep a reference, so it lives
+  // until the last of them is done.
+  class Signer : public base::RefCountedThreadSafe<Signer> {
+   public:
+    explicit Signer(std::unique_ptr<quic::ProofSource> proof_source);
+    Signer(const Signer&) = delete;
+    Signer& operator=(const Signer&) = delete;
+
+    quic::ProofSource* proof_source() const { return proof_source_.get(); }
+
+   private:
+    friend class base::RefCountedThreadSafe<Signer>;
+    ~Signer();
+
+    std::unique_ptr<quic::ProofSource> proof_source_;
+  };
+
+  // Called on IO thread when a signature requested at `start_time` is ready.
+  void OnSignatureComputed(base::TimeTicks start_time);
+
+  scoped_refptr<Signer> signer_;
+  uint32_t pending_signatures_;
+  uint64_t signatures_computed_;
+  base::TimeDelta total_signing_time_;
+
+  base::WeakPtrFactory<AsyncProofSource> weak_factory_{this};
+};
+
+}  // namespace net
+
+#endif  // OWT_QUIC_TRANSPORT_ASYNC_PROOF_SOURCE_H_
@@ -6,15 +6,20 @@
 
 #include "owt/quic/logging.h"
 #include "owt/quic_transport/sdk/impl/quic_transport_factory_impl.h"
+#include <algorithm>
 #include "base/at_exit.h"
 #include "base/bind.h"
 #include "base/command_line.h"
 #include "base/logging.h"
+#include "base/strings/string_util.h"
 #include "base/task/thread_pool/thread_pool_instance.h"
 #include "base/threading/thread.h"
 #include "owt/quic_transport/sdk/impl/proof_source_owt.h"
 #include "owt/quic_transport/sdk/impl/quic_transport_owt_client_impl.h"
 #include "owt/quic_transport/sdk/impl/quic_transport_owt_server_impl.h"
+#include "owt/quic_transport/sdk/impl/quic_transport_sharded_server.h"
+#include "owt/quic_transport/sdk/impl/session_ticket_crypter.h"
+#include "owt/quic_transport/sdk/impl/shared_session_cache.h"
 #include "net/quic/crypto/proof_source_chromium.h"
 #include "net/quic/platform/impl/quic_chromium_clock.h"
 #include "net/quic/quic_chromium_alarm_factory.h"
@@ -29,6 +34,70 @@
 namespace owt {
 namespace quic {
 
+namespace {
+constexpr base::TimeDelta kSessionTicketKeyRotationInterval = base::Hours(12);
+
+// `ticket_keys` is nullptr if session tickets are disabled.
+std::unique_ptr<::quic::ProofSource> CreateProofSource(
+    const char* cert_file,
+    const char* key_file,
+    scoped_refptr<net::SessionTicketKeys> ticket_keys) {
+  auto proof_source = std::make_unique<net::ProofSourceChromium>();
+  if (!proof_source->Initialize(
+      base::FilePath(cert_file),
+      base::FilePath(key_file), base::FilePath())) {
+    LOG(ERROR) << "Failed to initialize proof source.";
+    return nullptr;
+  }
+  if (ticket_keys) {
+    proof_source->SetTicketCrypter(
+        std::make_unique<net::SessionTicketCrypter>(std::move(ticket_keys)));
+  }
+  return proof_source;
+}
+
+std::unique_ptr<::quic::ProofSource> CreateProofSource(
+    const char* pfx_path,
+    const char* password,
+    scoped_refptr<net::SessionTicketKeys> ticket_keys) {
+  auto proof_source = std::make_unique<ProofSourceOwt>();
+  if (!proof_source->Initialize(
+      base::FilePath::FromUTF8Unsafe(pfx_path),
+      std::string(password))) {
+    LOG(ERROR) << "Failed to initialize proof source.";
+    return nullptr;
+  }
+  if (ticket_keys) {
+    proof_source->SetTicketCrypter(
+        std::make_unique<net::SessionTicketCrypter>(std::move(ticket_keys)));
+  }
+  return proof_source;
+}
+
+// Keys are shared by all shards of a server, so a client resumes its session
+// no matter which shard receives its packets. Returns false if the key file is
+// invalid.
+bool CreateSessionTicketKeys(
+    const ServerOptions& options,
+    scoped_refptr<net::SessionTicketKeys>* ticket_keys) {
+  if (!options.session_tickets_enabled) {
+    return true;
+  }
+  if (!options.session_ticket_key_file) {
+    *ticket_keys =
+        net::SessionTicketKeys::CreateRandom(kSessionTicketKeyRotationInterval);
+    return true;
+  }
+  *ticket_keys = net::SessionTicketKeys::CreateFromFile(
+      base::FilePath::FromUTF8Unsafe(options.session_ticket_key_file));
+  if (!*ticket_keys) {
+    LOG(ERROR) << "Failed to load session ticket keys.";
+    return false;
+  }
+  return true;
+}
+}  // namespace
+
 // FakeProofVerifier for client
 class FakeProofVerifier : public ::quic::ProofVerifier {
  public:
@@ -97,33 +166,88 @@ QuicTransportServerInterface* QuicTransportFactoryImpl::CreateQuicTransportServe
     const char* cert_file,
     const char* key_file,
     const char* secret_path) {
-  auto proof_source = std::make_unique<net::ProofSourceChromium>();
-  if (!proof_source->Initialize(
-      base::FilePath(cert_file),
-      base::FilePath(key_file), base::FilePath())) {
-    LOG(ERROR) << "Failed to initialize proof source.";
+  return CreateQuicTransportServer(port, cert_file, key_file, secret_path,
+                                   ServerOptions());
+}
+
+QuicTransportServerInterface* QuicTransportFactoryImpl::CreateQuicTransportServer(
+    int port,
+    const char* pfx_path,
+    const char* password) {
+  return CreateQuicTransportServer(port, pfx_path, password, ServerOptions());
+}
+
+QuicTransportServerInterface* QuicTransportFactoryImpl::CreateQuicTransportServer(
+    int port,
+    const char* cert_path,
+    const char* key_path,
+    const char* secret_path,
+    const ServerOptions& options) {
+  scoped_refptr<net::SessionTicketKeys> ticket_keys;
+  if (!CreateSessionTicketKeys(options, &ticket_keys)) {
     return nullptr;
   }
-  return CreateQuicTransportServerOnIOThread(port, std::move(proof_source));
+  std::vector<std::unique_ptr<::quic::ProofSource>> proof_sources;
+  for (size_t i = 0; i < std::max<size_t>(options.io_thread_count, 1); i++) {
+    auto proof_source = CreateProofSource(cert_path, key_path, ticket_keys);
+    if (!proof_source) {
+      return nullptr;
+    }
+    proof_sources.push_back(std::move(proof_source));
+  }
+  return CreateShardedQuicTransportServer(port, std::move(proof_sources),
+                                          options);
 }
 
 QuicTransportServerInterface* QuicTransportFactoryImpl::CreateQuicTransportServer(
     int port,
     const char* pfx_path,
-    const char* password) {
-  auto proof_source = std::make_unique<ProofSourceOwt>();
-  if (!proof_source->Initialize(
-      base::FilePath::FromUTF8Unsafe(pfx_path),
-      std::string(password))) {
-    LOG(ERROR) << "Failed to initialize proof source.";
+    const char* password,
+    const ServerOptions& options) {
+  scoped_refptr<net::SessionTicketKeys> ticket_keys;
+  if (!CreateSessionTicketKeys(options, &ticket_keys)) {
     return nullptr;
   }
-  return CreateQuicTransportServerOnIOThread(port, std::move(proof_source));
+  std::vector<std::unique_ptr<::quic::ProofSource>> proof_sources;
+  for (size_t i = 0; i < std::max<size_t>(options.io_thread_count, 1); i++) {
+    auto proof_source = CreateProofSource(pfx_path, password, ticket_keys);
+    if (!proof_source) {
+      return nullptr;
+    }
+    proof_sources.push_back(std::move(proof_source));
+  }
+  return CreateShardedQuicTransportServer(port, std::move(proof_sources),
+                                          options);
+}
+
+QuicTransportServerInterface*
+QuicTransportFactoryImpl::CreateShardedQuicTransportServer(
+    int port,
+    size_t io_thread_count,
+    const char* cert_path,
+    const char* key_path,
+    const char* secret_path) {
+  ServerOptions options;
+  options.io_thread_count = io_thread_count;
+  return CreateQuicTransportServer(port, cert_path, key_path, secret_path,
+                                   options);
+}
+
+QuicTransportServerInterface*
+QuicTransportFactoryImpl::CreateShardedQuicTransportServer(
+    int port,
+    size_t io_thread_count,
+    const char* pfx_path,
+    const char* password) {
+  ServerOptions options;
+  options.io_thread_count = io_thread_count;
+  return CreateQuicTransportServer(port, pfx_path, password, options);
 }
 
 QuicTransportServerInterface* QuicTransportFactoryImpl::CreateQuicTransportServerOnIOThread(
     int port,
-    std::unique_ptr<::quic::ProofSource> proof_source) {
+    std::unique_ptr<::quic::ProofSource> proof_source,
+    const ServerOptions& options) {
   QuicTransportServerInterface* result(nullptr);
   base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
                            base::WaitableEvent::InitialState::NOT_SIGNALED);
@@ -131,6 +255,7 @@ QuicTransportServerInterface* QuicTransportFactoryImpl::CreateQuicTransportServe
       FROM_HERE,
       base::BindOnce(
           [](int port, std::unique_ptr<::quic::ProofSource> proof_source,
+             const ServerOptions& options,
              base::Thread* io_thread, base::Thread* event_thread,
              QuicTransportServerInterface** result, base::WaitableEvent* event) {
 
@@ -140,17 +265,57 @@ QuicTransportServerInterface* QuicTransportFactoryImpl::CreateQuicTransportServe
             *result = new net::QuicTransportOwtServerImpl(
                 port, std::move(proof_source), config, 
                 ::quic::QuicCryptoServerConfig::ConfigOptions(),
-                ::quic::AllSupportedVersions(),
+                ::quic::AllSupportedVersions(), options,
                 io_thread, event_thread);
             event->Signal();
           },
-          port, std::move(proof_source), base::Unretained(io_thread_.get()),
+          port, std::move(proof_source), options,
+          base::Unretained(io_thread_.get()),
           base::Unretained(event_thread_.get()), base::Unretained(&result),
           base::Unretained(&done)));
   done.Wait();
   return result;
 }
 
+QuicTransportServerInterface*
+QuicTransportFactoryImpl::CreateShardedQuicTransportServer(
+    int port,
+    std::vector<std::unique_ptr<::quic::ProofSource>> proof_sources,
+    const ServerOptions& options) {
+#ifdef OWT_QUIC_USE_RECVMMSG
+  if (proof_sources.size() > 256) {
+    LOG(ERROR) << "At most 256 IO threads are supported.";
+    return nullptr;
+  }
+  if (proof_sources.size() > 1) {
+    return new net::QuicTransportShardedServer(port, std::move(proof_sources),
+                                               options, event_thread_.get());
+  }
+#else
+  LOG_IF(WARNING, proof_sources.size() > 1)
+      << "Sharded server is not supported on this platform.";
+#endif
+  return CreateQuicTransportServerOnIOThread(port, std::move(proof_sources[0]),
+                                             options);
+}
+
+scoped_refptr<net::SharedSessionCache>
+QuicTransportFactoryImpl::SessionCacheForFingerprints(
+    const std::vector<::quic::CertificateFingerprint>& fingerprints) {
+  std::vector<std::string> values;
+  for (const auto& fingerprint : fingerprints) {
+    values.push_back(fingerprint.algorithm + ":" + fingerprint.fingerprint);
+  }
+  std::sort(values.begin(), values.end());
+  const std::string key = base::JoinString(values, ",");
+  base::AutoLock lock(session_caches_lock_);
+  scoped_refptr<net::SharedSessionCache>& session_cache = session_caches_[key];
+  if (!session_cache) {
+    session_cache = base::MakeRefCounted<net::SharedSessionCache>();
+  }
+  return session_cache;
+}
+
 void QuicTransportFactoryImpl::Init() {
   base::CommandLine::Init(0, nullptr);
   base::CommandLine* command_line(base::CommandLine::ForCurrentProcess());
@@ -190,6 +355,7 @@ QuicTransportFactoryImpl::CreateQuicTransportClient(
       base::BindOnce(
           [](const char* host, int port,
              const std::vector<::quic::CertificateFingerprint>& fingerprints,
+             scoped_refptr<net::SharedSessionCache> session_cache,
              base::Thread* io_thread, base::Thread* event_thread,
              owt::quic::QuicTransportClientInterface** result, base::WaitableEvent* event) {
             ::quic::QuicIpAddress ip_addr;
@@ -215,10 +381,12 @@ QuicTransportFactoryImpl::CreateQuicTransportClient(
 
             *result = new net::QuicTransportOwtClientImpl(
                 ::quic::QuicSocketAddress(ip_addr, port), server_id, versions, fingerprints,
-                io_thread, event_thread);
+                session_cache->CreateClientCache(), io_thread, event_thread);
             event->Signal();
           },
-          base::Unretained(host), port, server_certificate_fingerprints, base::Unretained(io_thread_.get()),
+          base::Unretained(host), port, server_certificate_fingerprints,
+          SessionCacheForFingerprints(server_certificate_fingerprints),
+          base::Unretained(io_thread_.get()),
           base::Unretained(event_thread_.get()), base::Unretained(&result),
           base::Unretained(&done)));
   done.Wait();
@@ -7,9 +7,13 @@
 #ifndef OWT_QUIC_TRANSPORT_FACTORY_IMPL_H_
 #define OWT_QUIC_TRANSPORT_FACTORY_IMPL_H_
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
+#include "base/memory/scoped_refptr.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
 #include "owt/quic/export.h"
 #include "owt/quic/quic_transport_factory.h"
 #include "owt/quic_transport/sdk/impl/proof_source_owt.h"
@@ -32,6 +36,10 @@ class Thread;
 class AtExitManager;
 }  // namespace base
 
+namespace net {
+class SharedSessionCache;
+}  // namespace net
+
 namespace owt {
 namespace quic {
 
@@ -50,6 +58,28 @@ class OWT_EXPORT QuicTransportFactoryImpl : public owt::quic::QuicTransportFacto
     int port,
     const char* pfx_path,
     const char* password) override;
+  QuicTransportServerInterface* CreateQuicTransportServer(
+      int port,
+      const char* cert_path,
+      const char* key_path,
+      const char* secret_path,
+      const ServerOptions& options) override;
+  QuicTransportServerInterface* CreateQuicTransportServer(
+      int port,
+      const char* pfx_path,
+      const char* password,
+      const ServerOptions& options) override;
+  QuicTransportServerInterface* CreateShardedQuicTransportServer(
+      int port,
+      size_t io_thread_count,
+      const char* cert_path,
+      const char* key_path,
+      const char* secret_path) override;
+  QuicTransportServerInterface* CreateShardedQuicTransportServer(
+      int port,
+      size_t io_thread_count,
+      const char* pfx_path,
+      const char* password) override;
   QuicTransportClientInterface* CreateQuicTransportClient(
       const char* host,
       int port) override;
@@ -58,12 +88,28 @@ class OWT_EXPORT QuicTransportFactoryImpl : public owt::quic::QuicTransportFacto
   void Init();
   QuicTransportServerInterface* CreateQuicTransportServerOnIOThread(
       int port,
-      std::unique_ptr<::quic::ProofSource> proof_source);
+      std::unique_ptr<::quic::ProofSource> proof_source,
+      const ServerOptions& options);
+  QuicTransportServerInterface* CreateShardedQuicTransportServer(
+      int port,
+      std::vector<std::unique_ptr<::quic::ProofSource>> proof_sources,
+      const ServerOptions& options);
+  // Returns the session cache of clients verifying servers with
+  // `fingerprints`, or with the default verifier if it's empty.
+  scoped_refptr<net::SharedSessionCache> SessionCacheForFingerprints(
+      const std::vector<::quic::CertificateFingerprint>& fingerprints);
 
   std::unique_ptr<base::AtExitManager> at_exit_manager_;
   std::unique_ptr<base::Thread> io_thread_;
   std::unique_ptr<base::Thread> event_thread_;
   std::vector<::quic::CertificateFingerprint> server_certificate_fingerprints;
+  // Shared by clients created by this factory with the same certificate
+  // fingerprints, so reconnecting to a server resumes the previous session.
+  // A session is only resumed by clients trusting the server the same way as
+  // the client establishing it. Key is the sorted fingerprints.
+  base::Lock session_caches_lock_;
+  std::map<std::string, scoped_refptr<net::SharedSessionCache>>
+      session_caches_ GUARDED_BY(session_caches_lock_);
 };
 
 }  // namespace quic
@@ -62,6 +62,7 @@ QuicTransportOwtClientImpl::QuicTransportOwtClientImpl(
     const quic::QuicServerId& server_id,
     const quic::ParsedQuicVersionVector& supported_versions,
     const std::vector<::quic::CertificateFingerprint> server_certificate_fingerprints,
+    std::unique_ptr<quic::SessionCache> session_cache,
     base::Thread* io_thread,
     base::Thread* event_thread)
     : quic::QuicTransportOwtClientBase(
@@ -72,7 +73,7 @@ QuicTransportOwtClientImpl::QuicTransportOwtClientImpl(
           CreateQuicAlarmFactory(),
           base::WrapUnique(CreateNetworkHelper()),
           CreateProofVerifier(&clock_, server_certificate_fingerprints),
-          nullptr,
+          std::move(session_cache),
           io_thread->task_runner().get(),
           event_thread->task_runner().get()),
       event_runner_(event_thread->task_runner()),
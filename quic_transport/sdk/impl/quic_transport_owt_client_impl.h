@@ -37,10 +37,12 @@ class QuicTransportOwtClientImpl : public quic::QuicTransportOwtClientBase,
  public:
 
   // Create a quic client, which will have events managed by the message loop.
+  // Sessions in `session_cache` are resumed if it's not nullptr.
   QuicTransportOwtClientImpl(quic::QuicSocketAddress server_address,
                    const quic::QuicServerId& server_id,
                    const quic::ParsedQuicVersionVector& supported_versions,
                    const std::vector<::quic::CertificateFingerprint> server_certificate_fingerprints,
+                   std::unique_ptr<quic::SessionCache> session_cache,
                    base::Thread* io_thread,
                    base::Thread* event_thread);
 
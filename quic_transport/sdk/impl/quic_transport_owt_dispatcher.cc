@@ -26,7 +26,12 @@ QuicTransportOwtDispatcher::QuicTransportOwtDispatcher(
                      expected_server_connection_id_length, generator),
       task_runner_(io_runner),
       event_runner_(event_runner),
-      visitor_(nullptr){}
+      visitor_(nullptr),
+      max_packet_size_(0),
+      zero_rtt_enabled_(true),
+      full_handshakes_(0),
+      resumed_handshakes_(0),
+      zero_rtt_handshakes_(0) {}
 
 QuicTransportOwtDispatcher::~QuicTransportOwtDispatcher() = default;
 
@@ -48,13 +53,30 @@ std::unique_ptr<QuicSession> QuicTransportOwtDispatcher::CreateQuicSession(
   auto session = std::make_unique<QuicTransportOwtServerSession>(
       connection, this, config(), GetSupportedVersions(), session_helper(),
       crypto_config(), compressed_certs_cache(), task_runner_, event_runner_);
+  session->set_handshake_observer(this);
+  session->set_zero_rtt_enabled(zero_rtt_enabled_);
   session->Initialize();
+  if (max_packet_size_ > 0) {
+    connection->SetMaxPacketLength(max_packet_size_);
+  }
   if (visitor_) {
     visitor_->OnSessionCreated(session.get());
   }
   return session;
 }
 
+void QuicTransportOwtDispatcher::OnHandshakeComplete(bool resumed,
+                                                     bool zero_rtt) {
+  if (!resumed) {
+    full_handshakes_++;
+    return;
+  }
+  resumed_handshakes_++;
+  if (zero_rtt) {
+    zero_rtt_handshakes_++;
+  }
+}
+
 // Called when the connection is closed after the streams have been closed.
   void QuicTransportOwtDispatcher::OnConnectionClosed(QuicConnectionId server_connection_id,
                                     QuicErrorCode error,
@@ -13,7 +13,9 @@
 
 namespace quic {
 
-class QuicTransportOwtDispatcher : public QuicDispatcher {
+class QuicTransportOwtDispatcher
+    : public QuicDispatcher,
+      public QuicTransportOwtServerSession::HandshakeObserver {
  public:
   // Visitor receives callbacks from the QuicRawDispatcher.
   class QUIC_EXPORT_PRIVATE Visitor {
@@ -52,6 +54,21 @@ class QuicTransportOwtDispatcher : public QuicDispatcher {
                                     ConnectionCloseSource source) override;
 
   void set_visitor(Visitor* visitor) { visitor_ = visitor; }
+  // Maximum size of packets sent by sessions created afterwards. 0 keeps
+  // QuicConnection's default.
+  void set_max_packet_size(QuicByteCount max_packet_size) {
+    max_packet_size_ = max_packet_size;
+  }
+  // Whether sessions created afterwards accept 0-RTT data.
+  void set_zero_rtt_enabled(bool enabled) { zero_rtt_enabled_ = enabled; }
+
+  // Completed handshakes by kind. Resumed handshakes include 0-RTT ones.
+  uint64_t full_handshakes() const { return full_handshakes_; }
+  uint64_t resumed_handshakes() const { return resumed_handshakes_; }
+  uint64_t zero_rtt_handshakes() const { return zero_rtt_handshakes_; }
+
+  // Implement QuicTransportOwtServerSession::HandshakeObserver
+  void OnHandshakeComplete(bool resumed, bool zero_rtt) override;
 
  protected:
   std::unique_ptr<QuicSession> CreateQuicSession(
@@ -66,6 +83,11 @@ class QuicTransportOwtDispatcher : public QuicDispatcher {
   base::SingleThreadTaskRunner* task_runner_;
   base::SingleThreadTaskRunner* event_runner_;
   Visitor* visitor_;
+  QuicByteCount max_packet_size_;
+  bool zero_rtt_enabled_;
+  uint64_t full_handshakes_;
+  uint64_t resumed_handshakes_;
+  uint64_t zero_rtt_handshakes_;
 };
 
 }  // namespace quic
@@ -6,7 +6,11 @@
 
 #include <string.h>
 
+#include <algorithm>
+#include <utility>
+
 #include "base/location.h"
+#include "base/numerics/safe_conversions.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "net/base/ip_endpoint.h"
 #include "net/base/net_errors.h"
@@ -21,18 +25,36 @@
 #include "net/tools/quic/quic_simple_server_packet_writer.h"
 #include "net/tools/quic/quic_simple_server_session_helper.h"
 #include "net/quic/address_utils.h"
+#include "owt/quic_transport/sdk/impl/async_proof_source.h"
+
+#ifdef OWT_QUIC_USE_RECVMMSG
+#include "owt/quic_transport/sdk/impl/udp_batch_packet_writer.h"
+#endif
 
 namespace net {
 
 namespace {
 
 const char kSourceAddressTokenSecret[] = "secret";
-const size_t kNumSessionsToCreatePerSocketEvent = 16;
+const size_t kDefaultMaxNewConnectionsPerEvent = 16;
+const size_t kDefaultMaxReadsPerEvent = 32;
+const uint32_t kDefaultPacketReadBatchSize = 16;
+const base::TimeDelta kDefaultDrainTimeout = base::Seconds(10);
+const base::TimeDelta kDrainCheckInterval = base::Milliseconds(100);
 
 // Allocate some extra space so we can send an error if the client goes over
 // the limit.
 const int kReadBufferSize = 16 * quic::kMaxIncomingPacketSize;
 
+std::unique_ptr<quic::ProofSource> MaybeSignAsync(
+    std::unique_ptr<quic::ProofSource> proof_source,
+    bool async_signing) {
+  if (!async_signing) {
+    return proof_source;
+  }
+  return std::make_unique<AsyncProofSource>(std::move(proof_source));
+}
+
 }  // namespace
 
 
@@ -42,9 +64,11 @@ QuicTransportOwtServerImpl::QuicTransportOwtServerImpl(
     const quic::QuicConfig& config,
     const quic::QuicCryptoServerConfig::ConfigOptions& crypto_config_options,
     const quic::ParsedQuicVersionVector& supported_versions,
+    const owt::quic::ServerOptions& options,
     base::Thread* io_thread,
     base::Thread* event_thread)
     : port_(port),
+      reuse_port_(false),
       version_manager_(supported_versions),
       helper_(
           new QuicChromiumConnectionHelper(&clock_,
@@ -56,19 +80,49 @@ QuicTransportOwtServerImpl::QuicTransportOwtServerImpl(
       crypto_config_options_(crypto_config_options),
       crypto_config_(kSourceAddressTokenSecret,
                      quic::QuicRandom::GetInstance(),
-                     std::move(proof_source),
+                     MaybeSignAsync(std::move(proof_source),
+                                    options.async_signing),
                      quic::KeyExchangeSource::Default()),
+      async_proof_source_(
+          options.async_signing
+              ? static_cast<AsyncProofSource*>(crypto_config_.proof_source())
+              : nullptr),
       read_pending_(false),
       synchronous_read_count_(0),
       read_buffer_(base::MakeRefCounted<IOBufferWithSize>(kReadBufferSize)),
+      socket_receive_buffer_size_(
+          base::saturated_cast<int>(options.socket_receive_buffer_size)),
+      socket_send_buffer_size_(
+          base::saturated_cast<int>(options.socket_send_buffer_size)),
+      max_reads_per_event_(options.max_reads_per_event > 0
+                               ? options.max_reads_per_event
+                               : kDefaultMaxReadsPerEvent),
+      max_new_connections_per_event_(
+          options.max_new_connections_per_event > 0
+              ? options.max_new_connections_per_event
+              : kDefaultMaxNewConnectionsPerEvent),
+      max_packet_size_(options.max_packet_size),
+      drain_timeout_(options.drain_timeout_ms > 0
+                         ? base::Milliseconds(options.drain_timeout_ms)
+                         : kDefaultDrainTimeout),
+      zero_rtt_enabled_(options.zero_rtt_enabled),
+      packet_read_batch_size_(options.packet_read_batch_size > 0
+                                  ? options.packet_read_batch_size
+                                  : kDefaultPacketReadBatchSize),
+      udp_gro_enabled_(options.udp_gro_enabled),
+      packets_read_(0),
+      packet_read_calls_(0),
+      packets_forwarded_(0),
+      draining_(false),
+      stopped_(false),
       task_runner_(io_thread->task_runner()),
       event_runner_(event_thread->task_runner()),
-      connection_id_generator_(quic::kQuicDefaultConnectionIdLength),
       weak_factory_(this) {
-  Initialize();
+  Initialize(options);
 }
 
-void QuicTransportOwtServerImpl::Initialize() {
+void QuicTransportOwtServerImpl::Initialize(
+    const owt::quic::ServerOptions& options) {
 #if MMSG_MORE
   use_recvmmsg_ = true;
 #endif
@@ -77,16 +131,34 @@ void QuicTransportOwtServerImpl::Initialize() {
   // sensible value for a server: 1 MB for session, 64 KB for each stream.
   const uint32_t kInitialSessionFlowControlWindow = 1 * 1024 * 1024;  // 1 MB
   const uint32_t kInitialStreamFlowControlWindow = 64 * 1024;         // 64 KB
-  if (config_.GetInitialStreamFlowControlWindowToSend() ==
-      quic::kMinimumFlowControlSendWindow) {
+  if (options.initial_stream_flow_control_window > 0) {
+    config_.SetInitialStreamFlowControlWindowToSend(
+        options.initial_stream_flow_control_window);
+  } else if (config_.GetInitialStreamFlowControlWindowToSend() ==
+             quic::kMinimumFlowControlSendWindow) {
     config_.SetInitialStreamFlowControlWindowToSend(
         kInitialStreamFlowControlWindow);
   }
-  if (config_.GetInitialSessionFlowControlWindowToSend() ==
-      quic::kMinimumFlowControlSendWindow) {
+  if (options.initial_session_flow_control_window > 0) {
+    config_.SetInitialSessionFlowControlWindowToSend(
+        options.initial_session_flow_control_window);
+  } else if (config_.GetInitialSessionFlowControlWindowToSend() ==
+             quic::kMinimumFlowControlSendWindow) {
     config_.SetInitialSessionFlowControlWindowToSend(
         kInitialSessionFlowControlWindow);
   }
+  if (options.max_incoming_bidirectional_streams > 0) {
+    config_.SetMaxBidirectionalStreamsToSend(
+        options.max_incoming_bidirectional_streams);
+  }
+  if (options.max_incoming_unidirectional_streams > 0) {
+    config_.SetMaxUnidirectionalStreamsToSend(
+        options.max_incoming_unidirectional_streams);
+  }
+  if (options.idle_timeout_ms > 0) {
+    config_.SetIdleNetworkTimeout(
+        quic::QuicTime::Delta::FromMilliseconds(options.idle_timeout_ms));
+  }
 
   std::unique_ptr<quic::CryptoHandshakeMessage> scfg(
       crypto_config_.AddDefaultConfig(helper_->GetRandomGenerator(),
@@ -95,18 +167,61 @@ void QuicTransportOwtServerImpl::Initialize() {
 }
 
 QuicTransportOwtServerImpl::~QuicTransportOwtServerImpl() {
-
+  // Shards are deleted on their IO threads.
+  if (!shard_inboxes_.empty()) {
+    shard_inboxes_[connection_id_generator_.shard_index()]->SetConsumer(
+        nullptr);
+  }
 }
 
 int QuicTransportOwtServerImpl::Start() {
-      task_runner_->PostTask(
+  task_runner_->PostTask(
       FROM_HERE,
-      base::BindOnce(&QuicTransportOwtServerImpl::StartOnCurrentThread, weak_factory_.GetWeakPtr()));
-      return true;
+      base::BindOnce(
+          base::IgnoreResult(&QuicTransportOwtServerImpl::StartOnCurrentThread),
+          weak_factory_.GetWeakPtr()));
+  return true;
 }
 
-void QuicTransportOwtServerImpl::StartOnCurrentThread() {
-// Determine IP address to connect to from supplied hostname.
+bool QuicTransportOwtServerImpl::StartAndWait() {
+  DCHECK(!task_runner_->BelongsToCurrentThread());
+  bool result = false;
+  base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                           base::WaitableEvent::InitialState::NOT_SIGNALED);
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](QuicTransportOwtServerImpl* server, bool* result,
+             base::WaitableEvent* event) {
+            *result = server->StartOnCurrentThread();
+            event->Signal();
+          },
+          base::Unretained(this), base::Unretained(&result),
+          base::Unretained(&done)));
+  done.Wait();
+  return result;
+}
+
+bool QuicTransportOwtServerImpl::StartOnCurrentThread() {
+#ifdef OWT_QUIC_USE_RECVMMSG
+  std::unique_ptr<UdpServerSocketPosix> posix_socket =
+      std::make_unique<UdpServerSocketPosix>();
+  if (reuse_port_) {
+    posix_socket->AllowReusePort();
+  }
+  posix_socket->SetBufferSizes(socket_receive_buffer_size_,
+                               socket_send_buffer_size_);
+  int rc = posix_socket->Listen(port_);
+  if (rc < 0) {
+    LOG(ERROR) << "Listen() failed: " << ErrorToString(rc);
+    return false;
+  }
+  posix_socket_.swap(posix_socket);
+  self_address_ = posix_socket_->local_address();
+  server_address_ = ToIPEndPoint(self_address_);
+#else
+  LOG_IF(WARNING, reuse_port_) << "SO_REUSEPORT is not supported.";
+  // Determine IP address to connect to from supplied hostname.
   net::IPAddress ip = net::IPAddress::IPv6AllZeros();
 
   std::unique_ptr<UDPServerSocket> socket(
@@ -117,18 +232,23 @@ void QuicTransportOwtServerImpl::StartOnCurrentThread() {
   int rc = socket->Listen(net::IPEndPoint(ip, port_));
   if (rc < 0) {
     LOG(ERROR) << "Listen() failed: " << ErrorToString(rc);
+    return false;
   }
 
   // These send and receive buffer sizes are sized for a single connection,
   // because the default usage of QuicTransportOwtServerImpl is as a test server with
   // one or two clients.  Adjust higher for use with many clients.
   rc = socket->SetReceiveBufferSize(
-      static_cast<int32_t>(quic::kDefaultSocketReceiveBuffer));
+      socket_receive_buffer_size_ > 0
+          ? socket_receive_buffer_size_
+          : static_cast<int32_t>(quic::kDefaultSocketReceiveBuffer));
   if (rc < 0) {
     LOG(ERROR) << "SetReceiveBufferSize() failed: " << ErrorToString(rc);
   }
 
-  rc = socket->SetSendBufferSize(320 * quic::kMaxIncomingPacketSize);
+  rc = socket->SetSendBufferSize(socket_send_buffer_size_ > 0
+                                     ? socket_send_buffer_size_
+                                     : 320 * quic::kMaxIncomingPacketSize);
   if (rc < 0) {
     LOG(ERROR) << "SetSendBufferSize() failed: " << ErrorToString(rc);
   }
@@ -136,11 +256,13 @@ void QuicTransportOwtServerImpl::StartOnCurrentThread() {
   rc = socket->GetLocalAddress(&server_address_);
   if (rc < 0) {
     LOG(ERROR) << "GetLocalAddress() failed: " << ErrorToString(rc);
+    return false;
   }
 
-  LOG(INFO) << "Listening on " << server_address_.ToString();
-
   socket_.swap(socket);
+#endif
+
+  LOG(INFO) << "Listening on " << server_address_.ToString();
 
   port_ = server_address_.port();
 
@@ -150,31 +272,121 @@ void QuicTransportOwtServerImpl::StartOnCurrentThread() {
       std::unique_ptr<quic::QuicCryptoServerStream::Helper>(
           new QuicSimpleServerSessionHelper(quic::QuicRandom::GetInstance())),
       std::unique_ptr<quic::QuicAlarmFactory>(alarm_factory_), quic::kQuicDefaultConnectionIdLength, connection_id_generator_, task_runner_.get(), event_runner_.get()));
+  dispatcher_->set_max_packet_size(max_packet_size_);
+  dispatcher_->set_zero_rtt_enabled(zero_rtt_enabled_);
+  if (!shard_inboxes_.empty()) {
+    shard_inboxes_[connection_id_generator_.shard_index()]->SetConsumer(this);
+  }
+#ifdef OWT_QUIC_USE_RECVMMSG
+  dispatcher_->InitializeWithWriter(
+      new UdpBatchPacketWriter(posix_socket_->fd(), dispatcher_.get()));
+  dispatcher_->set_visitor(this);
+
+  StartBatchReading();
+#else
   QuicSimpleServerPacketWriter* writer =
       new QuicSimpleServerPacketWriter(socket_.get(), dispatcher_.get());
   dispatcher_->InitializeWithWriter(writer);
   dispatcher_->set_visitor(this);
 
   StartReading();
-
+#endif
+  return true;
 }
 
 void QuicTransportOwtServerImpl::Stop() {
+  GracefulStop(base::BindOnce(
+      [](QuicTransportOwtServerImpl* server) {
+        server->event_runner_->PostTask(
+            FROM_HERE, base::BindOnce(&QuicTransportOwtServerImpl::ServerEnded,
+                                      base::Unretained(server)));
+      },
+      base::Unretained(this)));
+}
+
+void QuicTransportOwtServerImpl::GracefulStop(base::OnceClosure on_stopped) {
   task_runner_->PostTask(
       FROM_HERE,
-      base::BindOnce(&QuicTransportOwtServerImpl::StopOnCurrentThread, weak_factory_.GetWeakPtr()));
+      base::BindOnce(&QuicTransportOwtServerImpl::GracefulStopOnCurrentThread,
+                     weak_factory_.GetWeakPtr(), std::move(on_stopped)));
 }
 
-void QuicTransportOwtServerImpl::StopOnCurrentThread() {
-  // Before we shut down the epoll server, give all active sessions a chance to
-  // notify clients that they're closing.
-  dispatcher_->Shutdown();
+void QuicTransportOwtServerImpl::GracefulStopOnCurrentThread(
+    base::OnceClosure on_stopped) {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  if (stopped_) {
+    std::move(on_stopped).Run();
+    return;
+  }
+  if (draining_) {
+    // Runs after the ongoing drain is completed.
+    on_stopped_callbacks_.push_back(std::move(on_stopped));
+    return;
+  }
+  if (!dispatcher_) {
+    // Not started.
+    stopped_ = true;
+    std::move(on_stopped).Run();
+    return;
+  }
+  draining_ = true;
+  on_stopped_callbacks_.push_back(std::move(on_stopped));
+  // Buffered CHLOs are dropped, and new connections are rejected. Packets of
+  // existing sessions are still processed.
+  dispatcher_->StopAcceptingNewConnections();
+  dispatcher_->PerformActionOnActiveSessions([](quic::QuicSession* session) {
+    if (!quic::VersionHasIetfQuicFrames(session->transport_version())) {
+      session->SendGoAway(quic::QUIC_PEER_GOING_AWAY, "Server is stopping.");
+    }
+  });
+  drain_deadline_ = base::TimeTicks::Now() + drain_timeout_;
+  LOG(INFO) << "Draining " << dispatcher_->NumSessions() << " sessions.";
+  CheckDrained();
+}
 
-  if (!socket_) {
+void QuicTransportOwtServerImpl::CheckDrained() {
+  DCHECK(draining_);
+  const size_t session_count = dispatcher_->NumSessions();
+  if (session_count > 0 && base::TimeTicks::Now() < drain_deadline_) {
+    task_runner_->PostDelayedTask(
+        FROM_HERE,
+        base::BindOnce(&QuicTransportOwtServerImpl::CheckDrained,
+                       weak_factory_.GetWeakPtr()),
+        kDrainCheckInterval);
     return;
   }
-  socket_->Close();
-  socket_.reset();
+  LOG_IF(INFO, session_count > 0)
+      << "Drain timeout expired, closing " << session_count << " sessions.";
+  // Give sessions still open a chance to notify clients that they're closing.
+  dispatcher_->Shutdown();
+  draining_ = false;
+  stopped_ = true;
+  if (!shard_inboxes_.empty()) {
+    shard_inboxes_[connection_id_generator_.shard_index()]->SetConsumer(
+        nullptr);
+  }
+
+#ifdef OWT_QUIC_USE_RECVMMSG
+  read_watcher_.reset();
+  batch_reader_.reset();
+  posix_socket_.reset();
+#endif
+  if (socket_) {
+    socket_->Close();
+    socket_.reset();
+  }
+  // A callback may destroy this server.
+  std::vector<base::OnceClosure> callbacks;
+  callbacks.swap(on_stopped_callbacks_);
+  for (auto& callback : callbacks) {
+    std::move(callback).Run();
+  }
+}
+
+void QuicTransportOwtServerImpl::ServerEnded() {
+  if (visitor_) {
+    visitor_->OnEnded();
+  }
 }
 
 void QuicTransportOwtServerImpl::SetVisitor(owt::quic::QuicTransportServerInterface::Visitor* visitor) { 
@@ -222,6 +434,160 @@ int QuicTransportOwtServerImpl::GetListenPort() {
   return port_;
 }
 
+void QuicTransportOwtServerImpl::SetPacketReadBatchSize(uint32_t batch_size) {
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](base::WeakPtr<QuicTransportOwtServerImpl> server,
+             uint32_t batch_size) {
+            if (server) {
+              server->packet_read_batch_size_ = batch_size;
+            }
+          },
+          weak_factory_.GetWeakPtr(), batch_size));
+}
+
+void QuicTransportOwtServerImpl::SetUdpGroEnabled(bool enabled) {
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](base::WeakPtr<QuicTransportOwtServerImpl> server, bool enabled) {
+            if (server) {
+              server->udp_gro_enabled_ = enabled;
+            }
+          },
+          weak_factory_.GetWeakPtr(), enabled));
+}
+
+void QuicTransportOwtServerImpl::SetReusePort(bool enabled) {
+  reuse_port_ = enabled;
+}
+
+void QuicTransportOwtServerImpl::SetListenPort(uint16_t port) {
+  port_ = port;
+}
+
+void QuicTransportOwtServerImpl::SetShard(
+    uint8_t shard_index,
+    std::vector<ShardPacketInbox*> inboxes) {
+  DCHECK_LT(shard_index, inboxes.size());
+  connection_id_generator_.set_shard_index(shard_index);
+  shard_inboxes_ = std::move(inboxes);
+}
+
+owt::quic::ServerStats QuicTransportOwtServerImpl::GetStats() {
+  owt::quic::ServerStats stats = owt::quic::ServerStats();
+  if (task_runner_->BelongsToCurrentThread()) {
+    FillStatsOnCurrentThread(&stats);
+    return stats;
+  }
+  base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                           base::WaitableEvent::InitialState::NOT_SIGNALED);
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](QuicTransportOwtServerImpl* server, owt::quic::ServerStats* stats,
+             base::WaitableEvent* event) {
+            server->FillStatsOnCurrentThread(stats);
+            event->Signal();
+          },
+          base::Unretained(this), base::Unretained(&stats),
+          base::Unretained(&done)));
+  done.Wait();
+  return stats;
+}
+
+void QuicTransportOwtServerImpl::FillStatsOnCurrentThread(
+    owt::quic::ServerStats* stats) {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  stats->packets_forwarded = packets_forwarded_;
+  if (dispatcher_) {
+    stats->full_handshakes = dispatcher_->full_handshakes();
+    stats->resumed_handshakes = dispatcher_->resumed_handshakes();
+    stats->zero_rtt_handshakes = dispatcher_->zero_rtt_handshakes();
+  }
+  if (async_proof_source_) {
+    stats->pending_signatures = async_proof_source_->pending_signatures();
+    stats->signatures_computed = async_proof_source_->signatures_computed();
+    stats->signing_time_us =
+        async_proof_source_->total_signing_time().InMicroseconds();
+  }
+#ifdef OWT_QUIC_USE_RECVMMSG
+  if (batch_reader_) {
+    stats->packet_read_batch_size = batch_reader_->batch_size();
+    stats->packets_read = batch_reader_->packets_read();
+    stats->packet_read_calls = batch_reader_->read_calls();
+    return;
+  }
+  stats->packet_read_batch_size = packet_read_batch_size_;
+#else
+  stats->packet_read_batch_size = 1;
+#endif
+  stats->packets_read = packets_read_;
+  stats->packet_read_calls = packet_read_calls_;
+}
+
+#ifdef OWT_QUIC_USE_RECVMMSG
+void QuicTransportOwtServerImpl::StartBatchReading() {
+  bool gro_enabled = false;
+  if (udp_gro_enabled_) {
+    gro_enabled = posix_socket_->EnableGro() == OK;
+  }
+  batch_reader_ = std::make_unique<UdpBatchReader>(packet_read_batch_size_,
+                                                   gro_enabled, &clock_);
+  // The watcher keeps notifying while the socket is readable, so
+  // ReadPacketBatch doesn't reschedule itself.
+  read_watcher_ = base::FileDescriptorWatcher::WatchReadable(
+      posix_socket_->fd(),
+      base::BindRepeating(&QuicTransportOwtServerImpl::ReadPacketBatch,
+                          base::Unretained(this)));
+}
+
+void QuicTransportOwtServerImpl::ReadPacketBatch() {
+  dispatcher_->ProcessBufferedChlos(max_new_connections_per_event_);
+  int result = batch_reader_->ReadPackets(
+      posix_socket_->fd(),
+      std::max<size_t>(max_reads_per_event_, batch_reader_->batch_size()),
+      this);
+  if (result == OK || result == ERR_IO_PENDING) {
+    return;
+  }
+  LOG(ERROR) << "QuicRawServer read failed: " << ErrorToString(result);
+  // Stop watching, otherwise the failed read repeats until the drain ends.
+  read_watcher_.reset();
+  Stop();
+}
+
+void QuicTransportOwtServerImpl::OnPacketRead(
+    const quic::QuicReceivedPacket& packet,
+    const quic::QuicSocketAddress& peer_address) {
+  if (!shard_inboxes_.empty()) {
+    absl::optional<uint8_t> shard =
+        ShardConnectionIdGenerator::ShardOfPacket(packet.data(),
+                                                  packet.length());
+    // Indexes out of range are not issued by this server. Such packets are
+    // processed here, and the dispatcher decides what to do with them.
+    if (shard.has_value() && *shard < shard_inboxes_.size() &&
+        *shard != connection_id_generator_.shard_index()) {
+      shard_inboxes_[*shard]->Push(self_address_, peer_address, packet);
+      packets_forwarded_++;
+      return;
+    }
+  }
+  dispatcher_->ProcessPacket(self_address_, peer_address, packet);
+}
+#endif
+
+void QuicTransportOwtServerImpl::OnForwardedPacket(
+    const quic::QuicSocketAddress& self_address,
+    const quic::QuicSocketAddress& peer_address,
+    const quic::QuicReceivedPacket& packet) {
+  if (!dispatcher_) {
+    return;
+  }
+  dispatcher_->ProcessPacket(self_address, peer_address, packet);
+}
+
 void QuicTransportOwtServerImpl::ScheduleReadPackets() {
   task_runner_->PostTask(FROM_HERE,
                          base::BindOnce(&QuicTransportOwtServerImpl::StartReading,
@@ -229,9 +595,12 @@ void QuicTransportOwtServerImpl::ScheduleReadPackets() {
 }
 
 void QuicTransportOwtServerImpl::StartReading() {
+  if (stopped_) {
+    return;
+  }
   if (synchronous_read_count_ == 0) {
     // Only process buffered packets once per message loop.
-    dispatcher_->ProcessBufferedChlos(kNumSessionsToCreatePerSocketEvent);
+    dispatcher_->ProcessBufferedChlos(max_new_connections_per_event_);
   }
 
   if (read_pending_) {
@@ -242,6 +611,7 @@ void QuicTransportOwtServerImpl::StartReading() {
   int result = socket_->RecvFrom(
       read_buffer_.get(), read_buffer_->size(), &client_address_,
       base::BindOnce(&QuicTransportOwtServerImpl::OnReadComplete, base::Unretained(this)));
+  packet_read_calls_++;
 
   if (result == ERR_IO_PENDING) {
     synchronous_read_count_ = 0;
@@ -255,7 +625,7 @@ void QuicTransportOwtServerImpl::StartReading() {
     return;
   }
 
-  if (++synchronous_read_count_ > 32) {
+  if (static_cast<size_t>(++synchronous_read_count_) > max_reads_per_event_) {
     synchronous_read_count_ = 0;
     // Schedule the processing through the message loop to 1) prevent infinite
     // recursion and 2) avoid blocking the thread for too long.
@@ -279,6 +649,7 @@ void QuicTransportOwtServerImpl::OnReadComplete(int result) {
     return;
   }
 
+  packets_read_++;
   quic::QuicReceivedPacket packet(read_buffer_->data(), result,
                                   helper_->GetClock()->Now(), false);
   dispatcher_->ProcessPacket(
@@ -8,6 +8,7 @@
 #define QUIC_TRANSPORT_OWT_SERVER_IMPL_H_
 
 #include <memory>
+#include <vector>
 
 #include "absl/base/macros.h"
 #include "net/base/io_buffer.h"
@@ -16,15 +17,28 @@
 #include "net/quic/quic_chromium_alarm_factory.h"
 #include "net/quic/quic_chromium_connection_helper.h"
 #include "net/third_party/quiche/src/quiche/quic/core/crypto/quic_crypto_server_config.h"
-#include "net/third_party/quiche/src/quiche/quic/core/deterministic_connection_id_generator.h"
 #include "net/third_party/quiche/src/quiche/quic/core/quic_config.h"
 #include "net/third_party/quiche/src/quiche/quic/core/quic_version_manager.h"
 #include "net/quic/platform/impl/quic_chromium_clock.h"
 #include "owt/quic_transport/sdk/impl/quic_transport_owt_dispatcher.h"
 #include "owt/quic/quic_transport_server_interface.h"
+#include "owt/quic_transport/sdk/impl/async_proof_source.h"
 #include "owt/quic_transport/sdk/impl/proof_source_owt.h"
+#include "owt/quic_transport/sdk/impl/shard_connection_id_generator.h"
+#include "owt/quic_transport/sdk/impl/shard_packet_inbox.h"
+#include "base/callback.h"
+#include "base/synchronization/waitable_event.h"
 #include "base/task/single_thread_task_runner.h"
 #include "base/threading/thread.h"
+#include "base/time/time.h"
+#include "build/build_config.h"
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+#define OWT_QUIC_USE_RECVMMSG 1
+#include "base/files/file_descriptor_watcher_posix.h"
+#include "owt/quic_transport/sdk/impl/udp_batch_reader.h"
+#include "owt/quic_transport/sdk/impl/udp_server_socket_posix.h"
+#endif
 
 namespace net {
 
@@ -36,8 +50,13 @@ class QuicDispatcher;
 }  // namespace quic
 namespace net {
 
+// On Linux, packets are read in batches by recvmmsg.
 class QuicTransportOwtServerImpl 
       : public owt::quic::QuicTransportServerInterface,
+#ifdef OWT_QUIC_USE_RECVMMSG
+        public UdpBatchReader::Visitor,
+#endif
+        public ShardPacketInbox::Consumer,
         public quic::QuicTransportOwtDispatcher::Visitor {
  public:
   QuicTransportOwtServerImpl(
@@ -51,6 +70,7 @@ class QuicTransportOwtServerImpl
       const quic::QuicConfig& config,
       const quic::QuicCryptoServerConfig::ConfigOptions& crypto_config_options,
       const quic::ParsedQuicVersionVector& supported_versions,
+      const owt::quic::ServerOptions& options,
       base::Thread* io_thread,
       base::Thread* event_thread);
 
@@ -59,15 +79,53 @@ class QuicTransportOwtServerImpl
   // Implement quic::QuicTransportServerInterface
   // Start listening on the specified address. Returns an error code.
   int Start() override;
-  // Server deletion is imminent. Start cleaning up.
+  // Stops accepting new connections, and notifies the visitor after existing
+  // sessions are closed.
   void Stop() override;
   void SetVisitor(owt::quic::QuicTransportServerInterface::Visitor* visitor) override;
   int GetListenPort() override;
+  void SetPacketReadBatchSize(uint32_t batch_size) override;
+  void SetUdpGroEnabled(bool enabled) override;
+  owt::quic::ServerStats GetStats() override;
+
+  // Lets other servers listen on the same port with SO_REUSEPORT. Must be
+  // called before Start. Only supported on Linux.
+  void SetReusePort(bool enabled);
+  // Overrides the port passed to the constructor. Must be called before Start.
+  void SetListenPort(uint16_t port);
+  // Like Start, but blocks until the socket is listening. Returns false if the
+  // server fails to listen. Must not be called on IO thread.
+  bool StartAndWait();
+  // Makes this server shard `shard_index` of a sharded server. Connection IDs
+  // issued by this server carry `shard_index`. Short header packets carrying
+  // another shard's index are pushed to `inboxes[index]`. `inboxes` are
+  // indexed by shard, and they must outlive this server. Must be called before
+  // Start.
+  void SetShard(uint8_t shard_index, std::vector<ShardPacketInbox*> inboxes);
+  // Stops accepting new connections and sends GOAWAY to existing sessions of
+  // Google QUIC versions. IETF QUIC has no GOAWAY without HTTP/3, so those
+  // sessions are expected to be closed by the application. Sessions still open
+  // when the drain timeout expires are closed. Then the server stops reading
+  // packets and runs `on_stopped` on IO thread. Calling it again while draining
+  // runs `on_stopped` after the drain, and calling it after the server is
+  // stopped runs `on_stopped` immediately.
+  void GracefulStop(base::OnceClosure on_stopped);
 
   // Implement quic::QuicTransportOwtDispatcher::Visitor
   void OnSessionCreated(quic::QuicTransportOwtServerSession* session) override;
   void OnSessionClosed(quic::QuicConnectionId sessionId) override;
 
+#ifdef OWT_QUIC_USE_RECVMMSG
+  // Implement UdpBatchReader::Visitor
+  void OnPacketRead(const quic::QuicReceivedPacket& packet,
+                    const quic::QuicSocketAddress& peer_address) override;
+#endif
+
+  // Implement ShardPacketInbox::Consumer
+  void OnForwardedPacket(const quic::QuicSocketAddress& self_address,
+                         const quic::QuicSocketAddress& peer_address,
+                         const quic::QuicReceivedPacket& packet) override;
+
   // Start reading on the socket. On asynchronous reads, this registers
   // OnReadComplete as the callback, which will then call StartReading again.
   void StartReading();
@@ -83,15 +141,28 @@ class QuicTransportOwtServerImpl
  private:
 
   // Initialize the internal state of the server.
-  void Initialize();
-
-  void StartOnCurrentThread();
-  void StopOnCurrentThread();
+  void Initialize(const owt::quic::ServerOptions& options);
+
+  // Returns false if the server fails to listen.
+  bool StartOnCurrentThread();
+  void GracefulStopOnCurrentThread(base::OnceClosure on_stopped);
+  // Closes remaining sessions and the socket when all sessions are closed or
+  // the drain deadline is reached. Otherwise, checks again later.
+  void CheckDrained();
+  void ServerEnded();
   void ScheduleReadPackets();
   void NewSessionCreated(quic::QuicTransportOwtServerSession* session);
   void SessionClosed(quic::QuicConnectionId sessionId);
+  void FillStatsOnCurrentThread(owt::quic::ServerStats* stats);
+#ifdef OWT_QUIC_USE_RECVMMSG
+  // Starts watching the socket, and reads packets in batches when it's
+  // readable.
+  void StartBatchReading();
+  void ReadPacketBatch();
+#endif
 
   int port_;
+  bool reuse_port_;
 
   quic::QuicVersionManager version_manager_;
 
@@ -118,6 +189,8 @@ class QuicTransportOwtServerImpl
   quic::QuicCryptoServerConfig::ConfigOptions crypto_config_options_;
   // crypto_config_ contains crypto parameters for the handshake.
   quic::QuicCryptoServerConfig crypto_config_;
+  // Owned by `crypto_config_`. Null if signing is synchronous.
+  AsyncProofSource* async_proof_source_;
 
   // The address that the server listens on.
   IPEndPoint server_address_;
@@ -136,13 +209,43 @@ class QuicTransportOwtServerImpl
   // The source address of the current read.
   IPEndPoint client_address_;
 
+  const int socket_receive_buffer_size_;
+  const int socket_send_buffer_size_;
+  const size_t max_reads_per_event_;
+  const size_t max_new_connections_per_event_;
+  const quic::QuicByteCount max_packet_size_;
+  const base::TimeDelta drain_timeout_;
+  const bool zero_rtt_enabled_;
+
+  // Read stats. Only accessed on IO thread.
+  uint32_t packet_read_batch_size_;
+  bool udp_gro_enabled_;
+  uint64_t packets_read_;
+  uint64_t packet_read_calls_;
+  uint64_t packets_forwarded_;
+
+  // Drain state. Only accessed on IO thread.
+  bool draining_;
+  bool stopped_;
+  base::TimeTicks drain_deadline_;
+  std::vector<base::OnceClosure> on_stopped_callbacks_;
+
+#ifdef OWT_QUIC_USE_RECVMMSG
+  std::unique_ptr<UdpServerSocketPosix> posix_socket_;
+  std::unique_ptr<UdpBatchReader> batch_reader_;
+  std::unique_ptr<base::FileDescriptorWatcher::Controller> read_watcher_;
+  quic::QuicSocketAddress self_address_;
+#endif
+
 
   scoped_refptr<base::SingleThreadTaskRunner> task_runner_;
   scoped_refptr<base::SingleThreadTaskRunner> event_runner_;
 
   owt::quic::QuicTransportServerInterface::Visitor* visitor_;
 
-  quic::DeterministicConnectionIdGenerator connection_id_generator_;
+  ShardConnectionIdGenerator connection_id_generator_;
+  // Inboxes of all shards when this server is a shard. Empty otherwise.
+  std::vector<ShardPacketInbox*> shard_inboxes_;
 
   base::WeakPtrFactory<QuicTransportOwtServerImpl> weak_factory_;
 
@@ -33,7 +33,9 @@ QuicTransportOwtServerSession::QuicTransportOwtServerSession(
       helper_(helper),
       task_runner_(io_runner),
       event_runner_(event_runner),
-      visitor_(nullptr) {
+      visitor_(nullptr),
+      handshake_observer_(nullptr),
+      zero_rtt_enabled_(true) {
 }
 
 QuicTransportOwtServerSession::~QuicTransportOwtServerSession() {
@@ -56,6 +58,20 @@ void QuicTransportOwtServerSession::Initialize() {
   QuicSession::Initialize();
 }
 
+void QuicTransportOwtServerSession::OnTlsHandshakeComplete() {
+  QuicSession::OnTlsHandshakeComplete();
+  if (handshake_observer_) {
+    handshake_observer_->OnHandshakeComplete(crypto_stream_->IsResumption(),
+                                             crypto_stream_->IsZeroRtt());
+  }
+}
+
+QuicSSLConfig QuicTransportOwtServerSession::GetSSLConfig() const {
+  QuicSSLConfig ssl_config = QuicSession::GetSSLConfig();
+  ssl_config.early_data_enabled = zero_rtt_enabled_;
+  return ssl_config;
+}
+
 QuicCryptoServerStreamBase* QuicTransportOwtServerSession::GetMutableCryptoStream() {
   return crypto_stream_.get();
 }
@@ -25,6 +25,15 @@ class QUIC_EXPORT_PRIVATE QuicTransportOwtServerSession
     : public QuicSession,
       public owt::quic::QuicTransportSessionInterface {
  public:
+  // Observes TLS handshake of this session. Methods are called on IO thread.
+  class HandshakeObserver {
+   public:
+    virtual ~HandshakeObserver() = default;
+    // Called when the handshake is complete. `resumed` is true if a session
+    // ticket is accepted, and `zero_rtt` is true if early data is accepted.
+    virtual void OnHandshakeComplete(bool resumed, bool zero_rtt) = 0;
+  };
+
   // Does not take ownership of |connection| or |visitor|.
   QuicTransportOwtServerSession(QuicConnection* connection,
                  QuicSession::Visitor* visitor,
@@ -42,6 +51,18 @@ class QUIC_EXPORT_PRIVATE QuicTransportOwtServerSession
 
   void Initialize() override;
 
+  // `observer` must outlive this session.
+  void set_handshake_observer(HandshakeObserver* observer) {
+    handshake_observer_ = observer;
+  }
+  // Whether 0-RTT data from resumed clients is accepted. Must be called before
+  // Initialize. Default is true.
+  void set_zero_rtt_enabled(bool enabled) { zero_rtt_enabled_ = enabled; }
+
+  // Overrides QuicSession.
+  void OnTlsHandshakeComplete() override;
+  QuicSSLConfig GetSSLConfig() const override;
+
   const QuicCryptoServerStreamBase* crypto_stream() const {
     return crypto_stream_.get();
   }
@@ -134,6 +155,8 @@ class QUIC_EXPORT_PRIVATE QuicTransportOwtServerSession
   base::SingleThreadTaskRunner* task_runner_;
   base::SingleThreadTaskRunner* event_runner_;
   owt::quic::QuicTransportSessionInterface::Visitor* visitor_;
+  HandshakeObserver* handshake_observer_;
+  bool zero_rtt_enabled_;
 };
 
 }  // namespace quic
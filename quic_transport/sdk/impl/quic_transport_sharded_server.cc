@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "owt/quic_transport/sdk/impl/quic_transport_sharded_server.h"
+#include <limits>
+#include <string>
+#include <utility>
+#include "base/barrier_closure.h"
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/check.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/waitable_event.h"
+#include "net/third_party/quiche/src/quiche/quic/core/quic_versions.h"
+
+namespace net {
+
+namespace {
+// Versions which allow the server to replace client chosen connection IDs, so
+// all connection IDs in short header packets are issued by a shard.
+quic::ParsedQuicVersionVector ShardableVersions() {
+  quic::ParsedQuicVersionVector versions;
+  for (const quic::ParsedQuicVersion& version : quic::AllSupportedVersions()) {
+    if (version.AllowsVariableLengthConnectionIds()) {
+      versions.push_back(version);
+    }
+  }
+  return versions;
+}
+}  // namespace
+
+QuicTransportShardedServer::QuicTransportShardedServer(
+    int port,
+    std::vector<std::unique_ptr<quic::ProofSource>> proof_sources,
+    const owt::quic::ServerOptions& options,
+    base::Thread* event_thread)
+    : event_runner_(event_thread->task_runner()),
+      visitor_(nullptr) {
+  CHECK(!proof_sources.empty());
+  CHECK_LE(proof_sources.size(),
+           static_cast<size_t>(std::numeric_limits<uint8_t>::max()) + 1);
+  for (size_t i = 0; i < proof_sources.size(); i++) {
+    auto io_thread = std::make_unique<base::Thread>(
+        "quic_transport_server_io_thread_" + base::NumberToString(i));
+    io_thread->StartWithOptions(
+        base::Thread::Options(base::MessagePumpType::IO, 0));
+    inboxes_.push_back(
+        std::make_unique<ShardPacketInbox>(io_thread->task_runner()));
+    io_threads_.push_back(std::move(io_thread));
+  }
+  std::vector<ShardPacketInbox*> inboxes;
+  for (auto& inbox : inboxes_) {
+    inboxes.push_back(inbox.get());
+  }
+  for (size_t i = 0; i < proof_sources.size(); i++) {
+    base::Thread* io_thread = io_threads_[i].get();
+    // Like QuicTransportFactoryImpl, a server is created on its IO thread.
+    QuicTransportOwtServerImpl* shard(nullptr);
+    base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                             base::WaitableEvent::InitialState::NOT_SIGNALED);
+    io_thread->task_runner()->PostTask(
+        FROM_HERE,
+        base::BindOnce(
+            [](int port, std::unique_ptr<quic::ProofSource> proof_source,
+               const owt::quic::ServerOptions& options,
+               base::Thread* io_thread, base::Thread* event_thread,
+               QuicTransportOwtServerImpl** result,
+               base::WaitableEvent* event) {
+              *result = new QuicTransportOwtServerImpl(
+                  port, std::move(proof_source), quic::QuicConfig(),
+                  quic::QuicCryptoServerConfig::ConfigOptions(),
+                  ShardableVersions(), options, io_thread, event_thread);
+              event->Signal();
+            },
+            port, std::move(proof_sources[i]), options,
+            base::Unretained(io_thread),
+            base::Unretained(event_thread), base::Unretained(&shard),
+            base::Unretained(&done)));
+    done.Wait();
+    shard->SetReusePort(true);
+    shard->SetShard(static_cast<uint8_t>(i), inboxes);
+    shards_.emplace_back(shard);
+  }
+}
+
+QuicTransportShardedServer::~QuicTransportShardedServer() {
+  for (size_t i = 0; i < shards_.size(); i++) {
+    io_threads_[i]->task_runner()->DeleteSoon(FROM_HERE,
+                                              std::move(shards_[i]));
+  }
+  shards_.clear();
+  // Stopping a thread runs its pending tasks, including deleting its shard.
+  for (auto& io_thread : io_threads_) {
+    io_thread->Stop();
+  }
+}
+
+int QuicTransportShardedServer::Start() {
+  // The first shard picks a port if it's not specified. Others listen on the
+  // same port.
+  if (!shards_[0]->StartAndWait()) {
+    LOG(ERROR) << "Failed to start server shard 0.";
+    return false;
+  }
+  const int port = shards_[0]->GetListenPort();
+  for (size_t i = 1; i < shards_.size(); i++) {
+    shards_[i]->SetListenPort(port);
+    if (!shards_[i]->StartAndWait()) {
+      LOG(ERROR) << "Failed to start server shard " << i << ".";
+      StopShards(i);
+      return false;
+    }
+  }
+  LOG(INFO) << "QUIC server runs " << shards_.size() << " shards on port "
+            << port;
+  return true;
+}
+
+void QuicTransportShardedServer::Stop() {
+  // Shards drain in parallel. The visitor is notified once when the last shard
+  // is stopped.
+  base::RepeatingClosure on_shard_stopped = base::BarrierClosure(
+      shards_.size(),
+      base::BindOnce(
+          [](scoped_refptr<base::SingleThreadTaskRunner> event_runner,
+             owt::quic::QuicTransportServerInterface::Visitor* visitor) {
+            if (!visitor) {
+              return;
+            }
+            event_runner->PostTask(
+                FROM_HERE,
+                base::BindOnce(&owt::quic::QuicTransportServerInterface::
+                                   Visitor::OnEnded,
+                               base::Unretained(visitor)));
+          },
+          event_runner_, base::Unretained(visitor_)));
+  for (auto& shard : shards_) {
+    shard->GracefulStop(on_shard_stopped);
+  }
+}
+
+void QuicTransportShardedServer::SetVisitor(
+    owt::quic::QuicTransportServerInterface::Visitor* visitor) {
+  visitor_ = visitor;
+  for (auto& shard : shards_) {
+    shard->SetVisitor(visitor);
+  }
+}
+
+int QuicTransportShardedServer::GetListenPort() {
+  return shards_[0]->GetListenPort();
+}
+
+void QuicTransportShardedServer::SetPacketReadBatchSize(uint32_t batch_size) {
+  for (auto& shard : shards_) {
+    shard->SetPacketReadBatchSize(batch_size);
+  }
+}
+
+void QuicTransportShardedServer::SetUdpGroEnabled(bool enabled) {
+  for (auto& shard : shards_) {
+    shard->SetUdpGroEnabled(enabled);
+  }
+}
+
+owt::quic::ServerStats QuicTransportShardedServer::GetStats() {
+  owt::quic::ServerStats stats = owt::quic::ServerStats();
+  for (auto& shard : shards_) {
+    owt::quic::ServerStats shard_stats = shard->GetStats();
+    stats.packet_read_batch_size = shard_stats.packet_read_batch_size;
+    stats.packets_read += shard_stats.packets_read;
+    stats.packet_read_calls += shard_stats.packet_read_calls;
+    stats.packets_forwarded += shard_stats.packets_forwarded;
+    stats.full_handshakes += shard_stats.full_handshakes;
+    stats.resumed_handshakes += shard_stats.resumed_handshakes;
+    stats.zero_rtt_handshakes += shard_stats.zero_rtt_handshakes;
+    stats.pending_signatures += shard_stats.pending_signatures;
+    stats.signatures_computed += shard_stats.signatures_computed;
+    stats.signing_time_us += shard_stats.signing_time_us;
+  }
+  return stats;
+}
+
+void QuicTransportShardedServer::StopShards(size_t count) {
+  // Shards just started have no sessions, so they stop right away.
+  for (size_t i = 0; i < count; i++) {
+    shards_[i]->GracefulStop(base::DoNothing());
+  }
+}
+
+}  // namespace net
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_QUIC_TRANSPORT_QUIC_TRANSPORT_SHARDED_SERVER_H_
+#define OWT_QUIC_TRANSPORT_QUIC_TRANSPORT_SHARDED_SERVER_H_
+
+#include <memory>
+#include <vector>
+#include "base/memory/scoped_refptr.h"
+#include "base/task/single_thread_task_runner.h"
+#include "base/threading/thread.h"
+#include "net/third_party/quiche/src/quiche/quic/core/crypto/proof_source.h"
+#include "owt/quic/quic_transport_server_interface.h"
+#include "owt/quic_transport/sdk/impl/quic_transport_owt_server_impl.h"
+#include "owt/quic_transport/sdk/impl/shard_packet_inbox.h"
+
+namespace net {
+
+// A QUIC server listening on one port with several SO_REUSEPORT sockets. Each
+// socket is served by a shard, which is a QuicTransportOwtServerImpl running on
+// its own IO thread with its own dispatcher and crypto config. The kernel
+// distributes incoming packets among shards by 4-tuple hash. Server connection
+// IDs carry the index of the shard owning the connection, so when a client's
+// address changes, the shard receiving its packets forwards them to the owner
+// through the owner's ShardPacketInbox. Only versions allowing variable length
+// connection IDs are supported. All shards share `event_thread`, so sessions
+// from all of them are reported to one visitor on the same thread. Linux only.
+class QuicTransportShardedServer
+    : public owt::quic::QuicTransportServerInterface {
+ public:
+  // One shard is created for each proof source. At most 256 shards are
+  // supported. `options` are applied to every shard.
+  QuicTransportShardedServer(
+      int port,
+      std::vector<std::unique_ptr<quic::ProofSource>> proof_sources,
+      const owt::quic::ServerOptions& options,
+      base::Thread* event_thread);
+  ~QuicTransportShardedServer() override;
+  QuicTransportShardedServer(const QuicTransportShardedServer&) = delete;
+  QuicTransportShardedServer& operator=(const QuicTransportShardedServer&) =
+      delete;
+
+  // Overrides owt::quic::QuicTransportServerInterface.
+  int Start() override;
+  void Stop() override;
+  void SetVisitor(
+      owt::quic::QuicTransportServerInterface::Visitor* visitor) override;
+  int GetListenPort() override;
+  void SetPacketReadBatchSize(uint32_t batch_size) override;
+  void SetUdpGroEnabled(bool enabled) override;
+  owt::quic::ServerStats GetStats() override;
+
+  size_t shard_count() const { return shards_.size(); }
+
+ private:
+  // Stops the first `count` shards after another shard fails to start.
+  void StopShards(size_t count);
+
+  // Inboxes are destroyed after `io_threads_` are stopped.
+  std::vector<std::unique_ptr<ShardPacketInbox>> inboxes_;
+  std::vector<std::unique_ptr<base::Thread>> io_threads_;
+  // Each shard is deleted on its IO thread.
+  std::vector<std::unique_ptr<QuicTransportOwtServerImpl>> shards_;
+  scoped_refptr<base::SingleThreadTaskRunner> event_runner_;
+  owt::quic::QuicTransportServerInterface::Visitor* visitor_;
+};
+
+}  // namespace net
+
+#endif  // OWT_QUIC_TRANSPORT_QUIC_TRANSPORT_SHARDED_SERVER_H_
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "owt/quic_transport/sdk/impl/shard_connection_id_generator.h"
+#include "net/third_party/quiche/src/quiche/quic/core/quic_constants.h"
+
+namespace net {
+
+namespace {
+// Bit 7 of the first byte is set for long header packets.
+const uint8_t kLongHeaderBit = 0x80;
+}  // namespace
+
+ShardConnectionIdGenerator::ShardConnectionIdGenerator()
+    : quic::DeterministicConnectionIdGenerator(
+          quic::kQuicDefaultConnectionIdLength),
+      shard_index_(0) {}
+
+absl::optional<quic::QuicConnectionId>
+ShardConnectionIdGenerator::GenerateNextConnectionId(
+    const quic::QuicConnectionId& original) {
+  absl::optional<quic::QuicConnectionId> connection_id =
+      quic::DeterministicConnectionIdGenerator::GenerateNextConnectionId(
+          original);
+  if (connection_id.has_value() && !connection_id->IsEmpty()) {
+    connection_id->mutable_data()[0] = static_cast<char>(shard_index_);
+  }
+  return connection_id;
+}
+
+absl::optional<quic::QuicConnectionId>
+ShardConnectionIdGenerator::MaybeReplaceConnectionId(
+    const quic::QuicConnectionId& original,
+    const quic::ParsedQuicVersion& version) {
+  if (!version.AllowsVariableLengthConnectionIds()) {
+    return quic::DeterministicConnectionIdGenerator::MaybeReplaceConnectionId(
+        original, version);
+  }
+  // The result only depends on `original`, so retransmitted initial packets
+  // map to the same connection.
+  return GenerateNextConnectionId(original);
+}
+
+// static
+absl::optional<uint8_t> ShardConnectionIdGenerator::ShardOfPacket(
+    const char* data,
+    size_t length) {
+  if (length < 1 + quic::kQuicDefaultConnectionIdLength ||
+      (static_cast<uint8_t>(data[0]) & kLongHeaderBit)) {
+    return absl::nullopt;
+  }
+  return static_cast<uint8_t>(data[1]);
+}
+
+}  // namespace net
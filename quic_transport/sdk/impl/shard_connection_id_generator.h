@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_QUIC_TRANSPORT_SHARD_CONNECTION_ID_GENERATOR_H_
+#define OWT_QUIC_TRANSPORT_SHARD_CONNECTION_ID_GENERATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "absl/types/optional.h"
+#include "net/third_party/quiche/src/quiche/quic/core/deterministic_connection_id_generator.h"
+#include "net/third_party/quiche/src/quiche/quic/core/quic_connection_id.h"
+#include "net/third_party/quiche/src/quiche/quic/core/quic_versions.h"
+
+namespace net {
+
+// Generates server connection IDs whose first byte is the index of the shard
+// owning the connection. Other bytes are generated by
+// DeterministicConnectionIdGenerator. When a client's address changes, the
+// kernel may deliver its packets to another shard, which finds the owner from
+// the connection ID. Client chosen connection IDs are always replaced for
+// versions allowing variable length connection IDs, so every connection ID
+// used in short header packets carries a shard index.
+class ShardConnectionIdGenerator
+    : public quic::DeterministicConnectionIdGenerator {
+ public:
+  ShardConnectionIdGenerator();
+  ShardConnectionIdGenerator(const ShardConnectionIdGenerator&) = delete;
+  ShardConnectionIdGenerator& operator=(const ShardConnectionIdGenerator&) =
+      delete;
+
+  // Overrides quic::DeterministicConnectionIdGenerator.
+  absl::optional<quic::QuicConnectionId> GenerateNextConnectionId(
+      const quic::QuicConnectionId& original) override;
+  absl::optional<quic::QuicConnectionId> MaybeReplaceConnectionId(
+      const quic::QuicConnectionId& original,
+      const quic::ParsedQuicVersion& version) override;
+
+  // Returns the shard index carried by the destination connection ID of a
+  // short header packet. Returns absl::nullopt for long header packets. They
+  // are only sent during the handshake, when the client's address doesn't
+  // change, so they are processed by the shard receiving them.
+  static absl::optional<uint8_t> ShardOfPacket(const char* data,
+                                               size_t length);
+
+  void set_shard_index(uint8_t shard_index) { shard_index_ = shard_index; }
+  uint8_t shard_index() const { return shard_index_; }
+
+ private:
+  uint8_t shard_index_;
+};
+
+}  // namespace net
+
+#endif  // OWT_QUIC_TRANSPORT_SHARD_CONNECTION_ID_GENERATOR_H_
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "owt/quic_transport/sdk/impl/shard_connection_id_generator.h"
+#include <vector>
+#include "net/third_party/quiche/src/quiche/quic/core/quic_constants.h"
+#include "net/third_party/quiche/src/quiche/quic/test_tools/quic_test_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+
+namespace {
+// Returns a packet with `first_byte` followed by `connection_id`.
+std::vector<char> PacketWithConnectionId(
+    uint8_t first_byte,
+    const quic::QuicConnectionId& connection_id) {
+  std::vector<char> packet;
+  packet.push_back(static_cast<char>(first_byte));
+  packet.insert(packet.end(), connection_id.data(),
+                connection_id.data() + connection_id.length());
+  // Some payload.
+  packet.resize(packet.size() + 20);
+  return packet;
+}
+}  // namespace
+
+TEST(ShardConnectionIdGeneratorTest, GeneratedIdCarriesShardIndex) {
+  ShardConnectionIdGenerator generator;
+  generator.set_shard_index(3);
+  absl::optional<quic::QuicConnectionId> connection_id =
+      generator.GenerateNextConnectionId(quic::test::TestConnectionId(1));
+  ASSERT_TRUE(connection_id.has_value());
+  EXPECT_EQ(connection_id->length(), quic::kQuicDefaultConnectionIdLength);
+  EXPECT_EQ(static_cast<uint8_t>(connection_id->data()[0]), 3u);
+}
+
+TEST(ShardConnectionIdGeneratorTest, ReplacesClientChosenId) {
+  ShardConnectionIdGenerator generator;
+  generator.set_shard_index(5);
+  const quic::QuicConnectionId original = quic::test::TestConnectionId(42);
+  absl::optional<quic::QuicConnectionId> replaced =
+      generator.MaybeReplaceConnectionId(original,
+                                         quic::ParsedQuicVersion::RFCv1());
+  ASSERT_TRUE(replaced.has_value());
+  EXPECT_NE(*replaced, original);
+  EXPECT_EQ(replaced->length(), quic::kQuicDefaultConnectionIdLength);
+  EXPECT_EQ(static_cast<uint8_t>(replaced->data()[0]), 5u);
+  // Retransmitted initial packets get the same connection ID.
+  EXPECT_EQ(generator.MaybeReplaceConnectionId(
+                original, quic::ParsedQuicVersion::RFCv1()),
+            replaced);
+  // Other shards generate other connection IDs.
+  ShardConnectionIdGenerator other_generator;
+  other_generator.set_shard_index(6);
+  EXPECT_NE(other_generator.MaybeReplaceConnectionId(
+                original, quic::ParsedQuicVersion::RFCv1()),
+            replaced);
+}
+
+TEST(ShardConnectionIdGeneratorTest, KeepsIdForFixedLengthVersions) {
+  ShardConnectionIdGenerator generator;
+  generator.set_shard_index(5);
+  EXPECT_FALSE(generator
+                   .MaybeReplaceConnectionId(quic::test::TestConnectionId(42),
+                                             quic::ParsedQuicVersion::Q046())
+                   .has_value());
+}
+
+TEST(ShardConnectionIdGeneratorTest, ShardOfShortHeaderPacket) {
+  ShardConnectionIdGenerator generator;
+  generator.set_shard_index(7);
+  absl::optional<quic::QuicConnectionId> connection_id =
+      generator.GenerateNextConnectionId(quic::test::TestConnectionId(1));
+  ASSERT_TRUE(connection_id.has_value());
+  std::vector<char> packet = PacketWithConnectionId(0x40, *connection_id);
+  EXPECT_EQ(
+      ShardConnectionIdGenerator::ShardOfPacket(packet.data(), packet.size()),
+      7u);
+}
+
+TEST(ShardConnectionIdGeneratorTest, NoShardOfLongHeaderPacket) {
+  std::vector<char> packet =
+      PacketWithConnectionId(0xc0, quic::test::TestConnectionId(1));
+  EXPECT_FALSE(
+      ShardConnectionIdGenerator::ShardOfPacket(packet.data(), packet.size())
+          .has_value());
+}
+
+TEST(ShardConnectionIdGeneratorTest, NoShardOfTruncatedPacket) {
+  const char packet[] = {0x40, 0x01};
+  EXPECT_FALSE(
+      ShardConnectionIdGenerator::ShardOfPacket(packet, sizeof(packet))
+          .has_value());
+}
+
+}  // namespace test
+}  // namespace net
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "owt/quic_transport/sdk/impl/shard_packet_inbox.h"
+#include <cstring>
+#include <memory>
+#include <utility>
+#include "base/bind.h"
+#include "base/check.h"
+#include "base/location.h"
+
+namespace net {
+
+struct ShardPacketInbox::Packet {
+  quic::QuicSocketAddress self_address;
+  quic::QuicSocketAddress peer_address;
+  quic::QuicTime receipt_time = quic::QuicTime::Zero();
+  std::unique_ptr<char[]> data;
+  size_t length = 0;
+  Packet* next = nullptr;
+};
+
+ShardPacketInbox::ShardPacketInbox(
+    scoped_refptr<base::SingleThreadTaskRunner> task_runner)
+    : task_runner_(std::move(task_runner)),
+      head_(nullptr),
+      delivery_scheduled_(false),
+      consumer_(nullptr) {}
+
+ShardPacketInbox::~ShardPacketInbox() {
+  Packet* packet = head_.exchange(nullptr);
+  while (packet) {
+    std::unique_ptr<Packet> deleted(packet);
+    packet = packet->next;
+  }
+}
+
+void ShardPacketInbox::Push(const quic::QuicSocketAddress& self_address,
+                            const quic::QuicSocketAddress& peer_address,
+                            const quic::QuicReceivedPacket& packet) {
+  Packet* forwarded = new Packet;
+  forwarded->self_address = self_address;
+  forwarded->peer_address = peer_address;
+  forwarded->receipt_time = packet.receipt_time();
+  forwarded->data = std::make_unique<char[]>(packet.length());
+  memcpy(forwarded->data.get(), packet.data(), packet.length());
+  forwarded->length = packet.length();
+  Packet* head = head_.load(std::memory_order_relaxed);
+  do {
+    forwarded->next = head;
+  } while (!head_.compare_exchange_weak(head, forwarded));
+  // Deliver clears `delivery_scheduled_` before taking packets, so either it
+  // takes this packet, or another task is posted here.
+  if (!delivery_scheduled_.exchange(true)) {
+    task_runner_->PostTask(FROM_HERE,
+                           base::BindOnce(&ShardPacketInbox::Deliver,
+                                          base::Unretained(this)));
+  }
+}
+
+void ShardPacketInbox::SetConsumer(Consumer* consumer) {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  consumer_ = consumer;
+}
+
+void ShardPacketInbox::Deliver() {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  delivery_scheduled_.store(false);
+  Packet* head = head_.exchange(nullptr);
+  // Reverse the stack, so packets are delivered in the order they arrived.
+  Packet* packets = nullptr;
+  while (head) {
+    Packet* next = head->next;
+    head->next = packets;
+    packets = head;
+    head = next;
+  }
+  while (packets) {
+    std::unique_ptr<Packet> forwarded(packets);
+    packets = forwarded->next;
+    if (!consumer_) {
+      continue;
+    }
+    quic::QuicReceivedPacket packet(forwarded->data.get(), forwarded->length,
+                                    forwarded->receipt_time, false);
+    consumer_->OnForwardedPacket(forwarded->self_address,
+                                 forwarded->peer_address, packet);
+  }
+}
+
+}  // namespace net
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_QUIC_TRANSPORT_SHARD_PACKET_INBOX_H_
+#define OWT_QUIC_TRANSPORT_SHARD_PACKET_INBOX_H_
+
+#include <atomic>
+#include "base/memory/scoped_refptr.h"
+#include "base/task/single_thread_task_runner.h"
+#include "net/third_party/quiche/src/quiche/quic/core/quic_packets.h"
+#include "net/third_party/quiche/src/quiche/quic/platform/api/quic_socket_address.h"
+
+namespace net {
+
+// Packets forwarded to a shard by other shards of a sharded server. Packets can
+// be pushed on any thread without locks. They are delivered to the consumer on
+// the shard's IO thread, in the order they are pushed by each thread.
+class ShardPacketInbox {
+ public:
+  class Consumer {
+   public:
+    virtual ~Consumer() = default;
+    virtual void OnForwardedPacket(
+        const quic::QuicSocketAddress& self_address,
+        const quic::QuicSocketAddress& peer_address,
+        const quic::QuicReceivedPacket& packet) = 0;
+  };
+
+  // `task_runner` runs tasks on the shard's IO thread. The inbox must outlive
+  // the thread, since delivery tasks don't hold a reference to it.
+  explicit ShardPacketInbox(
+      scoped_refptr<base::SingleThreadTaskRunner> task_runner);
+  ~ShardPacketInbox();
+  ShardPacketInbox(const ShardPacketInbox&) = delete;
+  ShardPacketInbox& operator=(const ShardPacketInbox&) = delete;
+
+  // Copies `packet` to the inbox. It can be called on any thread.
+  void Push(const quic::QuicSocketAddress& self_address,
+            const quic::QuicSocketAddress& peer_address,
+            const quic::QuicReceivedPacket& packet);
+  // Sets the consumer. Packets are dropped when consumer is null. Must be
+  // called on the shard's IO thread.
+  void SetConsumer(Consumer* consumer);
+
+ private:
+  struct Packet;
+
+  // Delivers all pushed packets to the consumer. Runs on the shard's IO thread.
+  void Deliver();
+
+  scoped_refptr<base::SingleThreadTaskRunner> task_runner_;
+  // A lock-free stack of packets, newest first.
+  std::atomic<Packet*> head_;
+  // True when a Deliver task is posted but hasn't started taking packets.
+  std::atomic<bool> delivery_scheduled_;
+  Consumer* consumer_;
+};
+
+}  // namespace net
+
+#endif  // OWT_QUIC_TRANSPORT_SHARD_PACKET_INBOX_H_
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "owt/quic_transport/sdk/impl/shard_packet_inbox.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include "base/bind.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/task_environment.h"
+#include "base/threading/thread.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "net/third_party/quiche/src/quiche/quic/core/quic_time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+
+class PacketCollector : public ShardPacketInbox::Consumer {
+ public:
+  void OnForwardedPacket(const quic::QuicSocketAddress& self_address,
+                         const quic::QuicSocketAddress& peer_address,
+                         const quic::QuicReceivedPacket& packet) override {
+    packets.emplace_back(packet.data(), packet.length());
+    peer_addresses.push_back(peer_address);
+  }
+  std::vector<std::string> packets;
+  std::vector<quic::QuicSocketAddress> peer_addresses;
+};
+
+class ShardPacketInboxTest : public testing::Test {
+ public:
+  ShardPacketInboxTest()
+      : inbox_(base::ThreadTaskRunnerHandle::Get()),
+        self_address_(quic::QuicIpAddress::Loopback4(), 443),
+        peer_address_(quic::QuicIpAddress::Loopback4(), 10000) {}
+
+ protected:
+  void Push(const std::string& data) {
+    quic::QuicReceivedPacket packet(data.data(), data.size(),
+                                    quic::QuicTime::Zero());
+    inbox_.Push(self_address_, peer_address_, packet);
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  ShardPacketInbox inbox_;
+  quic::QuicSocketAddress self_address_;
+  quic::QuicSocketAddress peer_address_;
+  PacketCollector collector_;
+};
+
+TEST_F(ShardPacketInboxTest, DeliversInPushOrder) {
+  inbox_.SetConsumer(&collector_);
+  Push("packet0");
+  Push("packet1");
+  Push("packet2");
+  // Packets are delivered by a task on the shard's thread.
+  EXPECT_TRUE(collector_.packets.empty());
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(collector_.packets,
+            std::vector<std::string>({"packet0", "packet1", "packet2"}));
+  EXPECT_EQ(collector_.peer_addresses[0], peer_address_);
+  // Packets pushed after a delivery schedule another one.
+  Push("packet3");
+  task_environment_.RunUntilIdle();
+  ASSERT_EQ(collector_.packets.size(), 4u);
+  EXPECT_EQ(collector_.packets[3], "packet3");
+}
+
+TEST_F(ShardPacketInboxTest, DropsPacketsWithoutConsumer) {
+  Push("dropped");
+  task_environment_.RunUntilIdle();
+  inbox_.SetConsumer(&collector_);
+  Push("delivered");
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(collector_.packets, std::vector<std::string>({"delivered"}));
+}
+
+TEST_F(ShardPacketInboxTest, ConcurrentPushes) {
+  const size_t thread_count = 4;
+  const size_t packets_per_thread = 1000;
+  inbox_.SetConsumer(&collector_);
+  std::vector<std::unique_ptr<base::Thread>> threads;
+  for (size_t i = 0; i < thread_count; i++) {
+    auto thread = std::make_unique<base::Thread>(
+        "shard_packet_inbox_test_" + base::NumberToString(i));
+    ASSERT_TRUE(thread->Start());
+    thread->task_runner()->PostTask(
+        FROM_HERE,
+        base::BindOnce(
+            [](ShardPacketInbox* inbox, quic::QuicSocketAddress self_address,
+               quic::QuicSocketAddress peer_address, size_t thread_index,
+               size_t count) {
+              for (size_t j = 0; j < count; j++) {
+                std::string data = base::NumberToString(thread_index) + ":" +
+                                   base::NumberToString(j);
+                quic::QuicReceivedPacket packet(data.data(), data.size(),
+                                                quic::QuicTime::Zero());
+                inbox->Push(self_address, peer_address, packet);
+              }
+            },
+            base::Unretained(&inbox_), self_address_, peer_address_, i,
+            packets_per_thread));
+    threads.push_back(std::move(thread));
+  }
+  // Stopping a thread runs its pending tasks.
+  for (auto& thread : threads) {
+    thread->Stop();
+  }
+  task_environment_.RunUntilIdle();
+  ASSERT_EQ(collector_.packets.size(), thread_count * packets_per_thread);
+  // Packets pushed by the same thread keep their order.
+  std::vector<size_t> next_index(thread_count, 0);
+  for (const std::string& packet : collector_.packets) {
+    size_t separator = packet.find(':');
+    ASSERT_NE(separator, std::string::npos);
+    size_t thread_index = 0;
+    size_t packet_index = 0;
+    ASSERT_TRUE(
+        base::StringToSizeT(packet.substr(0, separator), &thread_index));
+    ASSERT_TRUE(
+        base::StringToSizeT(packet.substr(separator + 1), &packet_index));
+    ASSERT_LT(thread_index, thread_count);
+    EXPECT_EQ(packet_index, next_index[thread_index]);
+    next_index[thread_index] = packet_index + 1;
+  }
+}
+
+}  // namespace test
+}  // namespace net
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_QUIC_TRANSPORT_SHARED_SESSION_CACHE_H_
+#define OWT_QUIC_TRANSPORT_SHARED_SESSION_CACHE_H_
+
+#include <memory>
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "net/third_party/quiche/src/quiche/quic/core/crypto/quic_client_session_cache.h"
+#include "net/third_party/quiche/src/quiche/quic/core/crypto/quic_crypto_client_config.h"
+
+namespace net {
+
+// TLS sessions and transport parameters received by all clients of a factory,
+// indexed by server ID. A new client to a server that issued a session ticket
+// resumes the session, and sends 0-RTT data if the server allows it. Thread
+// safe, so clients running on different IO threads share the cache.
+class SharedSessionCache
+    : public ::quic::SessionCache,
+      public base::RefCountedThreadSafe<SharedSessionCache> {
+ public:
+  SharedSessionCache();
+  SharedSessionCache(const SharedSessionCache&) = delete;
+  SharedSessionCache& operator=(const SharedSessionCache&) = delete;
+
+  // Returns a cache for a client's ::quic::QuicCryptoClientConfig, which owns
+  // its cache. The returned cache forwards to this one.
+  std::unique_ptr<::quic::SessionCache> CreateClientCache();
+
+  // Overrides ::quic::SessionCache.
+  void Insert(const ::quic::QuicServerId& server_id,
+              bssl::UniquePtr<SSL_SESSION> session,
+              const ::quic::TransportParameters& params,
+              const ::quic::ApplicationState* application_state) override;
+  std::unique_ptr<::quic::QuicResumptionState> Lookup(
+      const ::quic::QuicServerId& server_id,
+      ::quic::QuicWallTime now,
+      const SSL_CTX* ctx) override;
+  void ClearEarlyData(const ::quic::QuicServerId& server_id) override;
+  void OnNewTokenReceived(const ::quic::QuicServerId& server_id,
+                          absl::string_view token) override;
+  void RemoveExpiredEntries(::quic::QuicWallTime now) override;
+  void Clear() override;
+
+ private:
+  friend class base::RefCountedThreadSafe<SharedSessionCache>;
+  class ClientCache;
+
+  ~SharedSessionCache() override;
+
+  base::Lock lock_;
+  ::quic::QuicClientSessionCache cache_ GUARDED_BY(lock_);
+};
+
+}  // namespace net
+
+#endif  // OWT_QUIC_TRANSPORT_SHARED_SESSION_CACHE_H_
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_QUIC_TRANSPORT_UDP_BATCH_PACKET_WRITER_H_
+#define OWT_QUIC_TRANSPORT_UDP_BATCH_PACKET_WRITER_H_
+
+#include <sys/socket.h>
+#include <memory>
+#include <vector>
+#include "owt/quic_transport/sdk/impl/udp_packet_writer.h"
+
+namespace net {
+
+// Buffers packets written during a flush and sends them when QUIC connection
+// flushes the writer, or when the buffer is full. Consecutive packets to the
+// same peer, which have the same size except the last one, are sent as one
+// UDP GSO (UDP_SEGMENT) message. All messages of a flush are sent by a single
+// sendmmsg call. Falls back to one message per packet if the kernel or the
+// network interface doesn't support GSO. Linux only.
+class UdpBatchPacketWriter : public UdpPacketWriter {
+ public:
+  UdpBatchPacketWriter(int fd, quic::QuicDispatcher* dispatcher);
+  ~UdpBatchPacketWriter() override;
+
+  // Overrides UdpPacketWriter.
+  quic::WriteResult WritePacket(const char* buffer,
+                                size_t buf_len,
+                                const quic::QuicIpAddress& self_address,
+                                const quic::QuicSocketAddress& peer_address,
+                                quic::PerPacketOptions* options) override;
+  bool IsBatchMode() const override;
+  quic::QuicPacketBuffer GetNextWriteLocation(
+      const quic::QuicIpAddress& self_address,
+      const quic::QuicSocketAddress& peer_address) override;
+  quic::WriteResult Flush() override;
+
+  bool gso_enabled() const { return gso_enabled_; }
+  size_t buffered_packets() const { return packets_.size(); }
+
+ private:
+  struct BufferedPacket {
+    // Offset in `buffer_`.
+    size_t offset;
+    size_t length;
+    quic::QuicSocketAddress peer_address;
+  };
+
+  // Returns true if a packet of `length` bytes fits into the buffer.
+  bool CanBuffer(size_t length) const;
+  // Fills `messages_` with buffered packets. Returns the number of messages.
+  size_t BuildMessages();
+  // Removes packets sent by the first `message_count` messages.
+  void RemoveSentPackets(size_t message_count);
+
+  bool gso_enabled_;
+  std::unique_ptr<char[]> buffer_;
+  // Bytes used in `buffer_`. Packets are stored contiguously.
+  size_t buffer_length_;
+  std::vector<BufferedPacket> packets_;
+  // Reused by each sendmmsg call. One message may carry several packets.
+  std::vector<mmsghdr> messages_;
+  std::vector<iovec> iovecs_;
+  std::vector<sockaddr_storage> peer_addresses_;
+  std::vector<char> control_buffers_;
+  std::vector<size_t> packets_per_message_;
+};
+
+}  // namespace net
+
+#endif  // OWT_QUIC_TRANSPORT_UDP_BATCH_PACKET_WRITER_H_
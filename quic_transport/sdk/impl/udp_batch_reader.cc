@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "owt/quic_transport/sdk/impl/udp_batch_reader.h"
+#include <errno.h>
+#include <netinet/udp.h>
+#include <string.h>
+#include <algorithm>
+#include "base/check.h"
+#include "base/posix/eintr_wrapper.h"
+#include "net/base/net_errors.h"
+#include "net/third_party/quiche/src/quiche/quic/core/quic_constants.h"
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+namespace net {
+
+namespace {
+// Largest datagram the kernel may deliver when GRO is enabled.
+constexpr size_t kMaxGroDatagramSize = 65535;
+constexpr size_t kControlBufferSize = CMSG_SPACE(sizeof(int));
+}  // namespace
+
+UdpBatchReader::UdpBatchReader(size_t batch_size,
+                               bool gro_enabled,
+                               const quic::QuicClock* clock)
+    : batch_size_(std::max<size_t>(batch_size, 1)),
+      gro_enabled_(gro_enabled),
+      clock_(clock),
+      buffer_size_(gro_enabled ? kMaxGroDatagramSize
+                               : quic::kMaxIncomingPacketSize),
+      buffers_(new char[batch_size_ * buffer_size_]),
+      iovecs_(batch_size_),
+      peer_addresses_(batch_size_),
+      control_buffers_(gro_enabled ? batch_size_ * kControlBufferSize : 0),
+      messages_(batch_size_),
+      packets_read_(0),
+      read_calls_(0) {
+  CHECK(clock_);
+  for (size_t i = 0; i < batch_size_; i++) {
+    iovecs_[i].iov_base = buffers_.get() + i * buffer_size_;
+    iovecs_[i].iov_len = buffer_size_;
+    msghdr& header = messages_[i].msg_hdr;
+    header = {};
+    header.msg_name = &peer_addresses_[i];
+    header.msg_iov = &iovecs_[i];
+    header.msg_iovlen = 1;
+    if (gro_enabled_) {
+      header.msg_control = control_buffers_.data() + i * kControlBufferSize;
+    }
+  }
+}
+
+UdpBatchReader::~UdpBatchReader() = default;
+
+int UdpBatchReader::ReadPackets(int fd, size_t max_packets, Visitor* visitor) {
+  DCHECK(visitor);
+  size_t total_read = 0;
+  while (total_read < max_packets) {
+    const size_t count = std::min(batch_size_, max_packets - total_read);
+    for (size_t i = 0; i < count; i++) {
+      // Reset fields modified by the previous call.
+      messages_[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+      messages_[i].msg_hdr.msg_flags = 0;
+      messages_[i].msg_hdr.msg_controllen =
+          gro_enabled_ ? kControlBufferSize : 0;
+      messages_[i].msg_len = 0;
+    }
+    int result =
+        HANDLE_EINTR(recvmmsg(fd, messages_.data(), count, 0, nullptr));
+    read_calls_++;
+    if (result < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return ERR_IO_PENDING;
+      }
+      return MapSystemError(errno);
+    }
+    // All packets read by one call are considered to arrive at the same time.
+    quic::QuicTime now = clock_->Now();
+    for (int i = 0; i < result; i++) {
+      mmsghdr& message = messages_[i];
+      if (message.msg_hdr.msg_flags & MSG_TRUNC) {
+        // Larger than any valid QUIC packet.
+        continue;
+      }
+      const char* data = static_cast<const char*>(iovecs_[i].iov_base);
+      const size_t length = message.msg_len;
+      size_t segment_size =
+          gro_enabled_ ? GetGroSegmentSize(&message.msg_hdr) : 0;
+      if (segment_size == 0) {
+        segment_size = length;
+      }
+      const quic::QuicSocketAddress peer_address(peer_addresses_[i]);
+      // Segments of a coalesced datagram have the same size except the last
+      // one.
+      for (size_t offset = 0; offset < length; offset += segment_size) {
+        quic::QuicReceivedPacket packet(
+            data + offset, std::min(segment_size, length - offset), now,
+            /*owns_buffer=*/false);
+        visitor->OnPacketRead(packet, peer_address);
+        packets_read_++;
+      }
+    }
+    total_read += result;
+    if (static_cast<size_t>(result) < count) {
+      // Socket is drained.
+      return ERR_IO_PENDING;
+    }
+  }
+  return OK;
+}
+
+// static
+size_t UdpBatchReader::GetGroSegmentSize(msghdr* header) {
+  for (cmsghdr* cmsg = CMSG_FIRSTHDR(header); cmsg;
+       cmsg = CMSG_NXTHDR(header, cmsg)) {
+    if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+      int segment_size = 0;
+      memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+      return segment_size > 0 ? segment_size : 0;
+    }
+  }
+  return 0;
+}
+
+}  // namespace net
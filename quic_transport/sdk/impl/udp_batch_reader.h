@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_QUIC_TRANSPORT_UDP_BATCH_READER_H_
+#define OWT_QUIC_TRANSPORT_UDP_BATCH_READER_H_
+
+#include <sys/socket.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "net/third_party/quiche/src/quiche/quic/core/quic_clock.h"
+#include "net/third_party/quiche/src/quiche/quic/core/quic_packets.h"
+#include "net/third_party/quiche/src/quiche/quic/platform/api/quic_socket_address.h"
+
+namespace net {
+
+// Reads UDP packets with recvmmsg, up to `batch_size` packets per system call,
+// into a pool of buffers owned by this reader. When UDP GRO is enabled on the
+// socket, coalesced datagrams are split into QUIC packets by their segment
+// size. Linux only.
+class UdpBatchReader {
+ public:
+  class Visitor {
+   public:
+    virtual ~Visitor() = default;
+    // `packet` is only valid during this call.
+    virtual void OnPacketRead(
+        const quic::QuicReceivedPacket& packet,
+        const quic::QuicSocketAddress& peer_address) = 0;
+  };
+
+  // `batch_size` 0 is treated as 1. `gro_enabled` must be true if UDP GRO is
+  // enabled on sockets passed to ReadPackets, so buffers are large enough for
+  // coalesced datagrams.
+  UdpBatchReader(size_t batch_size,
+                 bool gro_enabled,
+                 const quic::QuicClock* clock);
+  ~UdpBatchReader();
+  UdpBatchReader(const UdpBatchReader&) = delete;
+  UdpBatchReader& operator=(const UdpBatchReader&) = delete;
+
+  // Reads packets from non-blocking socket `fd` and passes them to `visitor`,
+  // until `fd` has no more datagrams or `max_packets` datagrams are read.
+  // A coalesced datagram counts as one. Returns
+  // ERR_IO_PENDING in the former case, OK in the latter, or a net
+  // error code when reading fails.
+  int ReadPackets(int fd, size_t max_packets, Visitor* visitor);
+
+  size_t batch_size() const { return batch_size_; }
+  bool gro_enabled() const { return gro_enabled_; }
+  // Number of packets read so far. Each segment of a coalesced datagram is
+  // counted as a packet.
+  uint64_t packets_read() const { return packets_read_; }
+  // Number of recvmmsg calls made so far.
+  uint64_t read_calls() const { return read_calls_; }
+
+ private:
+  // Returns the segment size in the UDP_GRO control message of `header`, or 0
+  // if the datagram is not coalesced.
+  static size_t GetGroSegmentSize(msghdr* header);
+
+  const size_t batch_size_;
+  const bool gro_enabled_;
+  const quic::QuicClock* clock_;
+  // Size of each buffer in `buffers_`.
+  const size_t buffer_size_;
+  // `batch_size_` buffers of `buffer_size_` bytes each.
+  std::unique_ptr<char[]> buffers_;
+  std::vector<iovec> iovecs_;
+  std::vector<sockaddr_storage> peer_addresses_;
+  // Receives UDP_GRO control messages. Empty if GRO is disabled.
+  std::vector<char> control_buffers_;
+  std::vector<mmsghdr> messages_;
+  uint64_t packets_read_;
+  uint64_t read_calls_;
+};
+
+}  // namespace net
+
+#endif  // OWT_QUIC_TRANSPORT_UDP_BATCH_READER_H_
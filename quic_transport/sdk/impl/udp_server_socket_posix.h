@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_QUIC_TRANSPORT_UDP_SERVER_SOCKET_POSIX_H_
+#define OWT_QUIC_TRANSPORT_UDP_SERVER_SOCKET_POSIX_H_
+
+#include <cstdint>
+#include "base/files/scoped_file.h"
+#include "net/third_party/quiche/src/quiche/quic/platform/api/quic_socket_address.h"
+
+namespace net {
+
+// A non-blocking UDP socket listening on all IPv6 and IPv4 addresses. Unlike
+// UDPServerSocket, it exposes its file descriptor, so packets can be read
+// and written in batches with recvmmsg and sendmmsg. POSIX only.
+class UdpServerSocketPosix {
+ public:
+  UdpServerSocketPosix();
+  ~UdpServerSocketPosix();
+  UdpServerSocketPosix(const UdpServerSocketPosix&) = delete;
+  UdpServerSocketPosix& operator=(const UdpServerSocketPosix&) = delete;
+
+  // Allows other sockets with SO_REUSEPORT to bind to the same port. The
+  // kernel distributes incoming datagrams among them by 4-tuple hash. Must be
+  // called before Listen.
+  void AllowReusePort();
+  // Sets socket buffer sizes in bytes. 0 keeps the default size. Must be called
+  // before Listen.
+  void SetBufferSizes(int receive_buffer_size, int send_buffer_size);
+  // Binds to `port`. 0 picks an ephemeral port. Returns a net error code.
+  int Listen(uint16_t port);
+  // Enables UDP GRO, so the kernel may coalesce datagrams from the same peer
+  // into one. Must be called after Listen. Returns a net error code.
+  int EnableGro();
+
+  int fd() const { return fd_.get(); }
+  const quic::QuicSocketAddress& local_address() const {
+    return local_address_;
+  }
+
+ private:
+  bool reuse_port_;
+  int receive_buffer_size_;
+  int send_buffer_size_;
+  base::ScopedFD fd_;
+  quic::QuicSocketAddress local_address_;
+};
+
+}  // namespace net
+
+#endif  // OWT_QUIC_TRANSPORT_UDP_SERVER_SOCKET_POSIX_H_
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_WEB_TRANSPORT_CONGESTION_CONTROLLER_INTERFACE_H_
+#define OWT_WEB_TRANSPORT_CONGESTION_CONTROLLER_INTERFACE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "owt/quic/export.h"
+
+namespace owt {
+namespace quic {
+
+// A packet acknowledged by remote side.
+struct OWT_EXPORT AckedPacketInfo {
+  uint64_t packet_number;
+  uint64_t bytes_acked;
+  // Time remote side received this packet, in microseconds. It's 0 when
+  // receive timestamp is not available.
+  int64_t receive_time_us;
+};
+
+// A packet declared lost.
+struct OWT_EXPORT LostPacketInfo {
+  uint64_t packet_number;
+  uint64_t bytes_lost;
+};
+
+// Packets acknowledged or lost in an ACK frame, with RTT measured when
+// processing it. All times are in microseconds, based on QUIC connection's
+// clock. See ReceivedDatagram::ArrivalTimeUs.
+struct OWT_EXPORT CongestionEvent {
+  int64_t event_time_us;
+  // Bytes in flight before this event.
+  uint64_t prior_in_flight;
+  // True if this ACK frame produced a new RTT sample.
+  bool rtt_updated;
+  int64_t latest_rtt_us;
+  int64_t smoothed_rtt_us;
+  int64_t min_rtt_us;
+  const AckedPacketInfo* acked_packets;
+  size_t acked_packet_count;
+  const LostPacketInfo* lost_packets;
+  size_t lost_packet_count;
+};
+
+// An application provided congestion controller for a QUIC connection. All
+// methods are called on IO thread. Methods are expected to be fast, since they
+// are called for every packet sent or acknowledged.
+class OWT_EXPORT CongestionControllerInterface {
+ public:
+  virtual ~CongestionControllerInterface() = default;
+  // Called when a packet is sent. `bytes_in_flight` doesn't include this
+  // packet. Packets without retransmittable data, e.g. ACK-only packets, don't
+  // consume congestion window.
+  virtual void OnPacketSent(int64_t sent_time_us,
+                            uint64_t bytes_in_flight,
+                            uint64_t packet_number,
+                            uint64_t bytes,
+                            bool is_retransmittable) = 0;
+  // Called when an ACK frame is processed, or packets are declared lost.
+  // Pointers in `event` are only valid during this call.
+  virtual void OnCongestionEvent(const CongestionEvent& event) = 0;
+  // Called when a probe timeout fires.
+  virtual void OnRetransmissionTimeout(bool packets_retransmitted) {}
+  // Called when the connection doesn't have enough data to fill congestion
+  // window.
+  virtual void OnApplicationLimited(uint64_t bytes_in_flight) {}
+  // Congestion window in bytes. No new packets are sent when bytes in flight
+  // reaches this value.
+  virtual uint64_t GetCongestionWindow() const = 0;
+  // Pacing rate in bit per second.
+  virtual uint64_t GetPacingRate(uint64_t bytes_in_flight) const = 0;
+  // Estimated bandwidth in bit per second. It's reported by
+  // ConnectionStats::estimated_bandwidth. Returns 0 if it's unknown.
+  virtual uint64_t GetBandwidthEstimate() const { return 0; }
+};
+
+// Creates congestion controllers for new QUIC connections.
+class OWT_EXPORT CongestionControllerFactoryInterface {
+ public:
+  virtual ~CongestionControllerFactoryInterface() = default;
+  // Called on IO thread. Ownership of returned value is moved to the SDK. It
+  // will be deleted on IO thread when the connection is closed.
+  virtual CongestionControllerInterface* CreateCongestionController() = 0;
+};
+
+}  // namespace quic
+}  // namespace owt
+
+#endif
@@ -7,6 +7,7 @@
 #ifndef OWT_WEB_TRANSPORT_WEB_TRANSPORT_CLIENT_INTERFACE_H_
 #define OWT_WEB_TRANSPORT_WEB_TRANSPORT_CLIENT_INTERFACE_H_
 
+#include "owt/quic/congestion_controller_interface.h"
 #include "owt/quic/export.h"
 #include "owt/quic/web_transport_definitions.h"
 #include "owt/quic/web_transport_session_interface.h"
@@ -18,9 +19,22 @@ class OWT_EXPORT WebTransportClientInterface {
  public:
   // https://wicg.github.io/web-transport/#dom-quictransportconfiguration-server_certificate_fingerprints.
   struct Parameters {
-    Parameters() : server_certificate_fingerprints_length(0) {}
+    Parameters()
+        : server_certificate_fingerprints_length(0),
+          congestion_control(CongestionControlAlgorithm::kDefault),
+          initial_congestion_window(0),
+          congestion_controller_factory(nullptr) {}
     CertificateFingerprint** server_certificate_fingerprints;
     size_t server_certificate_fingerprints_length;
+    // Congestion control algorithm of the connection.
+    CongestionControlAlgorithm congestion_control;
+    // Initial congestion window in packets. 0 means QUIC stack's default.
+    // Other values are rounded down to 3, 10, 20 or 50 packets.
+    uint32_t initial_congestion_window;
+    // Creates an application provided congestion controller for the
+    // connection, which replaces `congestion_control`. It must outlive the
+    // client. Not owned.
+    CongestionControllerFactoryInterface* congestion_controller_factory;
   };
 
   class Visitor {
@@ -36,6 +50,13 @@ class OWT_EXPORT WebTransportClientInterface {
     virtual void OnDatagramProcessed(MessageStatus) = 0;
     // Called when the connection is closed.
     virtual void OnClosed(uint32_t code, const char* reason) = 0;
+    // Unlike other methods of this visitor, which are called on event thread,
+    // it's called on IO thread with datagrams received while IO thread
+    // processes a batch of incoming packets, so they are reported without
+    // another thread hop. It should not block. See
+    // WebTransportSessionInterface::Visitor::OnDatagramsReceived.
+    virtual void OnDatagramsReceived(ReceivedDatagram* const* datagrams,
+                                     size_t datagram_count) {}
   };
   virtual ~WebTransportClientInterface() = default;
   // Set a visitor for the client.
@@ -51,6 +72,18 @@ class OWT_EXPORT WebTransportClientInterface {
   CreateOutgoingUnidirectionalStream() = 0;
   // Send or queue datagram. Sending datagrams is unreliable.
   virtual MessageStatus SendOrQueueDatagram(uint8_t* data, size_t length) = 0;
+  // Sends or queues a datagram without copying `data` and without waiting for
+  // IO thread. See WebTransportSessionInterface::SendOrQueueDatagramAsync.
+  virtual AsyncIoStatus SendOrQueueDatagramAsync(const uint8_t* data,
+                                                 size_t length,
+                                                 BufferReleaser* releaser) = 0;
+  // Sends or queues `datagram_count` datagrams in one IO thread task. See
+  // WebTransportSessionInterface::SendDatagrams.
+  virtual void SendDatagrams(const DataSpan* datagrams,
+                             size_t datagram_count,
+                             MessageStatus* statuses) = 0;
+  // Get connection stats. See WebTransportSessionInterface::GetStats.
+  virtual ConnectionStats GetStats() = 0;
 };
 }  // namespace quic
 }  // namespace owt
@@ -15,6 +15,7 @@
 #ifndef OWT_WEB_TRANSPORT_WEB_TRANSPORT_DEFINITIONS_H_
 #define OWT_WEB_TRANSPORT_WEB_TRANSPORT_DEFINITIONS_H_
 
+#include <cstddef>
 #include <cstdint>
 #include "owt/quic/export.h"
 
@@ -23,9 +24,216 @@ namespace quic {
 
 // Stats for a QUIC connection.
 // Ref: net/third_party/quiche/src/quic/core/quic_connection_stats.h.
+// All fields are zero when the connection is not established.
 struct OWT_EXPORT ConnectionStats {
   // Estimated bandwidth in bit per second.
   uint64_t estimated_bandwidth;
+  // Round trip times in microseconds.
+  int64_t smoothed_rtt_us;
+  int64_t min_rtt_us;
+  int64_t latest_rtt_us;
+  // Congestion window in bytes.
+  uint64_t congestion_window;
+  // Bytes sent but not acknowledged or declared lost.
+  uint64_t bytes_in_flight;
+  // Pacing rate in bit per second.
+  uint64_t pacing_rate;
+  uint64_t bytes_sent;
+  uint64_t packets_sent;
+  uint64_t bytes_received;
+  uint64_t packets_received;
+  uint64_t packets_lost;
+  uint64_t bytes_retransmitted;
+  uint64_t packets_retransmitted;
+  // Number of probe timeouts.
+  uint64_t pto_count;
+  // Bytes written to streams but not sent yet.
+  uint64_t stream_buffered_bytes;
+  // Datagrams queued because the connection is congestion control blocked.
+  uint64_t queued_datagrams;
+};
+
+// Stats for a server's UDP socket and new handshakes.
+struct OWT_EXPORT ServerStats {
+  // Maximum number of packets read by one system call.
+  uint32_t packet_read_batch_size;
+  // Packets read from the socket.
+  uint64_t packets_read;
+  // System calls made to read packets. packets_read / packet_read_calls is the
+  // average number of packets read by one call.
+  uint64_t packet_read_calls;
+  // New handshakes over ServerOptions::max_handshakes_per_second. Clients are
+  // asked to retry with an address validation token.
+  uint64_t handshakes_deferred;
+  // Retry packets for deferred handshakes not sent because the socket is
+  // blocked or fails.
+  uint64_t retry_packets_dropped;
+  // Initial packets dropped because ServerOptions::max_pending_handshakes is
+  // reached.
+  uint64_t handshakes_rejected;
+  // Completed handshakes without session resumption.
+  uint64_t full_handshakes;
+  // Completed handshakes resuming a session with a ticket. They don't need a
+  // signature.
+  uint64_t resumed_handshakes;
+  // Resumed handshakes whose 0-RTT data is accepted.
+  uint64_t zero_rtt_handshakes;
+  // Handshake signatures waiting for or running on the thread pool. Always 0
+  // when ServerOptions::async_signing is false.
+  uint32_t pending_signatures;
+  // Handshake signatures computed on the thread pool.
+  uint64_t signatures_computed;
+  // Sum of signing latencies in microseconds, including time waiting for a
+  // worker. signing_time_us / signatures_computed is the average latency.
+  uint64_t signing_time_us;
+};
+
+// Options of a server. They are applied when the server is created. Numeric
+// options set to 0 keep the SDK's default values, which are sized for a few
+// connections. Servers handling many connections usually need larger socket
+// buffers and read budgets.
+struct OWT_EXPORT ServerOptions {
+  ServerOptions()
+      : io_thread_count(1),
+        initial_session_flow_control_window(0),
+        initial_stream_flow_control_window(0),
+        socket_receive_buffer_size(0),
+        socket_send_buffer_size(0),
+        max_reads_per_event(0),
+        max_new_connections_per_event(0),
+        max_incoming_bidirectional_streams(0),
+        max_incoming_unidirectional_streams(0),
+        idle_timeout_ms(0),
+        max_packet_size(0),
+        packet_read_batch_size(0),
+        udp_gro_enabled(false),
+        drain_timeout_ms(0),
+        max_handshakes_per_second(0),
+        max_pending_handshakes(0),
+        async_signing(true),
+        session_tickets_enabled(true),
+        session_ticket_key_file(nullptr),
+        zero_rtt_enabled(true) {}
+  // Number of IO threads processing packets. See
+  // WebTransportFactory::CreateShardedWebTransportServer.
+  size_t io_thread_count;
+  // Flow control windows advertised to clients in bytes. Default values are
+  // chosen by QUIC stack.
+  uint32_t initial_session_flow_control_window;
+  uint32_t initial_stream_flow_control_window;
+  // Socket buffer sizes in bytes. Default value is 1 MB.
+  uint32_t socket_receive_buffer_size;
+  uint32_t socket_send_buffer_size;
+  // Maximum number of packets read each time the socket becomes readable.
+  // Default value is 32.
+  uint32_t max_reads_per_event;
+  // Maximum number of connections created each time the socket becomes
+  // readable. Other new connections wait for next time. Default value is 32.
+  uint32_t max_new_connections_per_event;
+  // Maximum number of streams a client can open concurrently in a session.
+  // Unidirectional streams include HTTP/3 control streams, so it should not be
+  // less than 3. Default values are chosen by QUIC stack.
+  uint32_t max_incoming_bidirectional_streams;
+  uint32_t max_incoming_unidirectional_streams;
+  // A connection is closed when it's idle for this period. Default value is
+  // chosen by QUIC stack.
+  uint32_t idle_timeout_ms;
+  // Maximum size of packets sent by the server in bytes, excluding IP and UDP
+  // headers. Default value is chosen by QUIC stack.
+  uint32_t max_packet_size;
+  // See WebTransportServerInterface::SetPacketReadBatchSize.
+  uint32_t packet_read_batch_size;
+  // See WebTransportServerInterface::SetUdpGroEnabled.
+  bool udp_gro_enabled;
+  // Time in milliseconds existing sessions have to finish after
+  // WebTransportServerInterface::Stop is called. Sessions still open are closed
+  // afterwards. Default value is 10 seconds.
+  uint32_t drain_timeout_ms;
+  // Maximum number of new handshakes per second, with bursts of one second.
+  // Clients over the limit get a Retry packet, and they are accepted when they
+  // come back with the address validation token in it. It's a limit for the
+  // whole server, split evenly across IO threads. Default value 0 means
+  // unlimited.
+  uint32_t max_handshakes_per_second;
+  // Maximum number of accepted handshakes waiting for their sessions to be
+  // created, e.g., CHLOs buffered because of max_new_connections_per_event.
+  // Initial packets of other new connections are dropped. It's a limit for the
+  // whole server, split evenly across IO threads. Default value is 100.
+  uint32_t max_pending_handshakes;
+  // Computes handshake signatures on a thread pool instead of IO thread, so
+  // expensive RSA or ECDSA operations don't delay packets of established
+  // sessions.
+  bool async_signing;
+  // Issues TLS session tickets, so returning clients resume their sessions
+  // without a new signature.
+  bool session_tickets_enabled;
+  // Path of a file with session ticket keys shared by servers in different
+  // processes. Each line is a 16 bytes key in hex, and the first one encrypts
+  // new tickets. The file is read again when it's modified. If it's nullptr,
+  // random keys are generated and rotated every 12 hours.
+  const char* session_ticket_key_file;
+  // Accepts 0-RTT data from resumed clients. Such data can be replayed, so
+  // applications should only act on idempotent requests before the handshake
+  // completes.
+  bool zero_rtt_enabled;
+};
+
+// Congestion controller's view of the network.
+struct OWT_EXPORT NetworkEstimate {
+  // Estimated bandwidth in bit per second.
+  uint64_t estimated_bandwidth;
+  // Round trip times in microseconds.
+  int64_t smoothed_rtt_us;
+  int64_t min_rtt_us;
+  // Congestion window in bytes.
+  uint64_t congestion_window;
+  // Pacing rate in bit per second.
+  uint64_t pacing_rate;
+};
+
+// Thresholds for network estimate change notifications. A change is reported
+// when estimated bandwidth, smoothed RTT or congestion window changes by at
+// least the specified percentage since last report. A percentage of 0 ignores
+// changes of that value.
+struct OWT_EXPORT NetworkEstimateThresholds {
+  uint32_t bandwidth_change_percent;
+  uint32_t rtt_change_percent;
+  uint32_t congestion_window_change_percent;
+  // Minimum interval between two reports in milliseconds.
+  uint32_t min_interval_ms;
+};
+
+// A contiguous range of memory. It doesn't own the memory it points to.
+struct OWT_EXPORT DataSpan {
+  const uint8_t* data;
+  size_t length;
+};
+
+// Releases buffers lent to the SDK. Release is called on IO thread when the SDK
+// doesn't access the buffer anymore.
+class OWT_EXPORT BufferReleaser {
+ public:
+  virtual ~BufferReleaser() = default;
+  virtual void Release(const uint8_t* data, size_t length) = 0;
+};
+
+// A datagram received from remote side. It's reference counted. The SDK holds a
+// reference during OnDatagramsReceived. Call AddRef to keep it after that, and
+// Release when it is no longer needed. Both methods can be called on any
+// thread.
+class OWT_EXPORT ReceivedDatagram {
+ public:
+  virtual const uint8_t* Data() const = 0;
+  virtual size_t Length() const = 0;
+  // Arrival time in microseconds. It's based on QUIC connection's clock, which
+  // is monotonic but doesn't have a specified epoch. Only the difference
+  // between two arrival times is meaningful.
+  virtual int64_t ArrivalTimeUs() const = 0;
+  virtual void AddRef() const = 0;
+  virtual void Release() const = 0;
+
+ protected:
+  virtual ~ReceivedDatagram() = default;
 };
 
 // Hash function algorithm and certificate fingerprint as described in RFC4572.
@@ -61,6 +269,30 @@ enum class MessageStatus {
   kUnavailable
 };
 
+// Congestion control algorithms provided by QUIC stack.
+// Ref: CongestionControlType in
+// net/third_party/quiche/src/quic/core/quic_types.h.
+enum class CongestionControlAlgorithm {
+  // Keeps the algorithm chosen by QUIC stack, which is BBR unless the peer
+  // requests another one.
+  kDefault,
+  kCubic,
+  kReno,
+  kBbr,
+  kBbrV2
+};
+
+// Status of an asynchronous operation at the time it is submitted.
+enum class AsyncIoStatus {
+  // The operation is accepted. Its completion callback will be invoked later.
+  kAccepted,
+  // The operation cannot be accepted right now. Completion callback will not be
+  // invoked. Please retry after the corresponding readiness event.
+  kWouldBlock,
+  // The stream or session is closed. Completion callback will not be invoked.
+  kClosed
+};
+
 }  // namespace quic
 }  // namespace owt
 
@@ -39,6 +39,45 @@ class OWT_EXPORT WebTransportFactory {
       int port,
       const char* pfx_path,
       const char* password) = 0;
+  // Create a WebTransport over HTTP/3 server with certificate, key and secret
+  // file, and `options`. A sharded server is created if
+  // `options.io_thread_count` is greater than 1, see
+  // CreateShardedWebTransportServer. Ownership of returned value is moved to
+  // caller. Returns nullptr if creation is failed.
+  virtual WebTransportServerInterface* CreateWebTransportServer(
+      int port,
+      const char* cert_path,
+      const char* key_path,
+      const char* secret_path,
+      const ServerOptions& options) = 0;
+  // Create a WebTransport over HTTP/3 server with pkcs12 file and `options`.
+  // See the overload above.
+  virtual WebTransportServerInterface* CreateWebTransportServer(
+      int port,
+      const char* pfx_path,
+      const char* password,
+      const ServerOptions& options) = 0;
+  // Create a WebTransport over HTTP/3 server which processes packets on
+  // `io_thread_count` IO threads. Each thread has its own socket listening on
+  // `port` with SO_REUSEPORT, and its own QUIC dispatcher and crypto config.
+  // The kernel distributes connections among threads. Sessions of all threads
+  // are reported to the same visitor. A single thread server is created if
+  // `io_thread_count` is less than 2 or the platform doesn't support
+  // SO_REUSEPORT. Ownership of returned value is moved to caller. Returns
+  // nullptr if creation is failed.
+  virtual WebTransportServerInterface* CreateShardedWebTransportServer(
+      int port,
+      size_t io_thread_count,
+      const char* cert_path,
+      const char* key_path,
+      const char* secret_path) = 0;
+  // Create a WebTransport over HTTP/3 server with pkcs12 file, which processes
+  // packets on `io_thread_count` IO threads. See the overload above.
+  virtual WebTransportServerInterface* CreateShardedWebTransportServer(
+      int port,
+      size_t io_thread_count,
+      const char* pfx_path,
+      const char* password) = 0;
   // Create a WebTransport over HTTP/3 client. It will not connect to the given
   // `url` immediately after creation.
   virtual WebTransportClientInterface* CreateWebTransportClient(
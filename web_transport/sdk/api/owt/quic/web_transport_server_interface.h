@@ -25,8 +25,30 @@ class OWT_EXPORT WebTransportServerInterface {
   };
   virtual ~WebTransportServerInterface() = default;
   virtual int Start() = 0;
+  // Stops accepting new connections and sends GOAWAY to existing sessions.
+  // Sessions still open after ServerOptions::drain_timeout_ms are closed.
+  // Visitor::OnEnded is called when all sessions are closed.
   virtual void Stop() = 0;
   virtual void SetVisitor(Visitor* visitor) = 0;
+  // Sets congestion control algorithm and initial congestion window in packets
+  // for connections accepted afterwards. `initial_congestion_window` 0 means
+  // QUIC stack's default, other values are rounded down to 3, 10, 20 or 50
+  // packets. Sessions can override it by
+  // WebTransportSessionInterface::SetCongestionControl.
+  virtual void SetCongestionControl(CongestionControlAlgorithm algorithm,
+                                    uint32_t initial_congestion_window) = 0;
+  // Sets the maximum number of packets read from the socket by one system call.
+  // It must be called before Start. Default value is 16. Platforms without
+  // recvmmsg always read one packet at a time.
+  virtual void SetPacketReadBatchSize(uint32_t batch_size) = 0;
+  // Enables or disables UDP GRO on the server's socket. It must be called
+  // before Start. It's disabled by default. When enabled, the kernel may
+  // coalesce datagrams from the same client, which are split into QUIC packets
+  // before processing. Ignored if the platform doesn't support it.
+  virtual void SetUdpGroEnabled(bool enabled) = 0;
+  // Gets a snapshot of stats of the server's socket. It may block the calling
+  // thread until IO thread collects stats.
+  virtual ServerStats GetStats() = 0;
 };
 }  // namespace quic
 }  // namespace owt
@@ -7,6 +7,7 @@
 #ifndef OWT_WEB_TRANSPORT_WEB_TRANSPORT_SESSION_INTERFACE_H_
 #define OWT_WEB_TRANSPORT_WEB_TRANSPORT_SESSION_INTERFACE_H_
 
+#include "owt/quic/congestion_controller_interface.h"
 #include "owt/quic/export.h"
 #include "owt/quic/web_transport_definitions.h"
 #include "owt/quic/web_transport_stream_interface.h"
@@ -22,6 +23,28 @@ class OWT_EXPORT WebTransportSessionInterface {
     virtual void OnCanCreateNewOutgoingStream(bool unidirectional) = 0;
     virtual void OnConnectionClosed() = 0;
     virtual void OnDatagramReceived(const uint8_t* data, size_t length) = 0;
+    // Called on IO thread when batched stream events are enabled. Streams
+    // that become readable or writable while IO thread processes a batch of
+    // incoming packets are reported together by one call, instead of calling
+    // OnCanRead and OnCanWrite of each stream's visitor. Pointers in the arrays
+    // are only valid during this call, but streams are valid until their
+    // visitor's OnClosed is called.
+    virtual void OnStreamsReady(
+        WebTransportStreamInterface* const* readable_streams,
+        size_t readable_stream_count,
+        WebTransportStreamInterface* const* writable_streams,
+        size_t writable_stream_count) {}
+    // Called on IO thread when batched datagram delivery is enabled.
+    // Datagrams received while IO thread processes a batch of incoming
+    // packets are reported together by one call, instead of calling
+    // OnDatagramReceived for each of them. The array is only valid during this
+    // call. Call ReceivedDatagram::AddRef to keep a datagram after that.
+    virtual void OnDatagramsReceived(ReceivedDatagram* const* datagrams,
+                                     size_t datagram_count) {}
+    // Called on IO thread when network estimate changes beyond thresholds set
+    // by SetNetworkEstimateThresholds. The first estimate after enabling is
+    // always reported.
+    virtual void OnNetworkEstimateChanged(const NetworkEstimate& estimate) {}
   };
   virtual ~WebTransportSessionInterface() = default;
   virtual const char* ConnectionId() const = 0;
@@ -29,8 +52,50 @@ class OWT_EXPORT WebTransportSessionInterface {
   virtual bool IsSessionReady() const = 0;
   virtual WebTransportStreamInterface* CreateBidirectionalStream() = 0;
   virtual MessageStatus SendOrQueueDatagram(uint8_t* data, size_t length) = 0;
-  // Get connection stats.
-  virtual const ConnectionStats& GetStats() = 0;
+  // Sends or queues a datagram without copying `data` and without waiting for
+  // IO thread. `length` must be greater than 0. When kAccepted is returned,
+  // `releaser` is called on IO thread after the datagram is sent or dropped.
+  // Otherwise, `releaser` is not called and the caller still owns `data`.
+  virtual AsyncIoStatus SendOrQueueDatagramAsync(const uint8_t* data,
+                                                 size_t length,
+                                                 BufferReleaser* releaser) = 0;
+  // Sends or queues `datagram_count` datagrams. Data is copied. All datagrams
+  // are enqueued in one IO thread task under a single packet flusher, so they
+  // are bundled into as few packets as possible. Status of each datagram is
+  // written to `statuses`, which must have `datagram_count` elements.
+  virtual void SendDatagrams(const DataSpan* datagrams,
+                             size_t datagram_count,
+                             MessageStatus* statuses) = 0;
+  // Enables or disables batched stream events. It's disabled by default. See
+  // Visitor::OnStreamsReady for details.
+  virtual void SetBatchedStreamEvents(bool enabled) = 0;
+  // Enables or disables batched datagram delivery. It's disabled by default.
+  // See Visitor::OnDatagramsReceived.
+  virtual void SetBatchedDatagramDelivery(bool enabled) = 0;
+  // Enables network estimate change notifications with `thresholds`, or
+  // disables them when `thresholds` is nullptr. They are disabled by default.
+  // See Visitor::OnNetworkEstimateChanged.
+  virtual void SetNetworkEstimateThresholds(
+      const NetworkEstimateThresholds* thresholds) = 0;
+  // Switches congestion control algorithm of the underlying QUIC connection.
+  // Congestion state like RTT and bandwidth samples are carried over when
+  // possible. `initial_congestion_window` is in packets, 0 keeps current
+  // value. It's rounded down to 3, 10, 20 or 50 packets. It's ignored once the
+  // connection has sent any packet, which is usually the case for a session, so
+  // the congestion window is not reset mid-transfer. Set it through options of
+  // the client or server instead. Since a QUIC connection carries only one
+  // WebTransport session, this affects all traffic of the session.
+  virtual void SetCongestionControl(CongestionControlAlgorithm algorithm,
+                                    uint32_t initial_congestion_window) = 0;
+  // Replaces congestion control of the underlying QUIC connection with
+  // `controller`. Ownership of `controller` is moved to the SDK. It will be
+  // deleted on IO thread when the connection is closed or another congestion
+  // control is set.
+  virtual void SetCongestionController(
+      CongestionControllerInterface* controller) = 0;
+  // Get a snapshot of connection stats. It may block the calling thread until
+  // IO thread collects stats.
+  virtual ConnectionStats GetStats() = 0;
   // Close a WebTransport session. `code` is the error code communicated with
   // peer, `reason` is a pointer to a UTF-8 encoded null terminated string, its
   // length should not exceed 1024.
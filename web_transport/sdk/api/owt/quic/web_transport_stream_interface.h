@@ -8,6 +8,7 @@
 #define OWT_WEB_TRANSPORT_WEB_TRANSPORT_STREAM_INTERFACE_H_
 
 #include "owt/quic/export.h"
+#include "owt/quic/web_transport_definitions.h"
 #include "stddef.h"
 #include "stdint.h"
 
@@ -26,6 +27,41 @@ class OWT_EXPORT WebTransportStreamInterface {
     virtual void OnCanWrite() = 0;
     // Called when final incoming data is read.
     virtual void OnFinRead() = 0;
+    // Called in push mode instead of OnCanRead. `regions` point to data in
+    // stream's receive buffer, starting from the first byte not consumed yet.
+    // They remain valid until the bytes are consumed by Consume or the stream
+    // is closed. The same regions are reported again on next call if they are
+    // not consumed. Next regions are reported when all reported bytes are
+    // consumed. `fin` is true when all data before FIN is consumed, and there
+    // is no more data to read. OnFinRead is called after it.
+    virtual void OnDataAvailable(const DataSpan* regions,
+                                 size_t region_count,
+                                 bool fin) {}
+    // Called on IO thread when the stream is closed in both directions, or
+    // reset, and all its data is acknowledged. The stream is destroyed after
+    // this method returns, pointer to the stream must not be used anymore.
+    virtual void OnClosed() {}
+  };
+  // Receives the result of WriteAsync. Callbacks are invoked on IO thread.
+  class WriteCallback {
+   public:
+    virtual ~WriteCallback() = default;
+    // Called when `data` passed to WriteAsync is written or buffered, or when
+    // the stream is closed before that. `bytes_written` is 0 on failure. The
+    // stream doesn't access `data` after this call.
+    virtual void OnWriteCompleted(const uint8_t* data,
+                                  size_t bytes_written) = 0;
+  };
+  // Receives the result of ReadAsync. Callbacks are invoked on IO thread.
+  class ReadCallback {
+   public:
+    virtual ~ReadCallback() = default;
+    // Called when at least one byte or FIN is read into `data`, or when the
+    // stream is closed before that. The stream doesn't access `data` after this
+    // call.
+    virtual void OnReadCompleted(uint8_t* data,
+                                 size_t bytes_read,
+                                 bool fin) = 0;
   };
   virtual ~WebTransportStreamInterface() = default;
   // QUIC stream ID.
@@ -34,11 +70,61 @@ class OWT_EXPORT WebTransportStreamInterface {
   // Write or buffer data. Returns the length of data written or buffered.
   // Current implementation always returns 0 or `length`.
   virtual size_t Write(const uint8_t* data, size_t length) = 0;
+  // Writes or buffers data in `spans` as a whole. Data is copied. Returns the
+  // total length of `spans` if data is written or buffered, otherwise 0.
+  virtual size_t Writev(const DataSpan* spans, size_t span_count) = 0;
+  // Writes data in `spans` without copying it into stream's send buffer, and
+  // without waiting for IO thread. When kAccepted is returned, ownership of
+  // each span is transferred to the stream, and `releaser` is called once for
+  // each non-empty span after its data is acknowledged by the peer, or the
+  // stream is closed. Otherwise, `releaser` is not called and the caller still
+  // owns `spans`. Writes are performed in the order they are accepted together
+  // with WriteAsync.
+  virtual AsyncIoStatus WritevWithOwnership(const DataSpan* spans,
+                                            size_t span_count,
+                                            BufferReleaser* releaser) = 0;
   // Reads at most `length` bytes into `data` and returns the number of bytes
   // actually read.
   virtual size_t Read(uint8_t* data, size_t length) = 0;
+  // Writes data without waiting for IO thread. `data` is not copied, it must be
+  // valid until `callback` is invoked. Writes are performed in the order they
+  // are accepted. Returns kWouldBlock when the stream is not able to write new
+  // data, please retry after OnCanWrite. `callback` may be invoked before this
+  // method returns if it's called on IO thread. Please don't mix WriteAsync
+  // with Write, Write returns 0 when there are pending asynchronous writes.
+  virtual AsyncIoStatus WriteAsync(const uint8_t* data,
+                                   size_t length,
+                                   WriteCallback* callback) = 0;
+  // Reads at most `length` bytes into `data` without waiting for IO thread.
+  // `data` must be valid until `callback` is invoked. Only one asynchronous
+  // read can be pending at a time, kWouldBlock is returned for another one.
+  virtual AsyncIoStatus ReadAsync(uint8_t* data,
+                                  size_t length,
+                                  ReadCallback* callback) = 0;
+  // Enables or disables push mode. In push mode, incoming data is reported by
+  // Visitor::OnDataAvailable on IO thread without being copied, and it's
+  // released by Consume. Read and ReadAsync should not be used in push mode.
+  virtual void SetPushMode(bool enabled) = 0;
+  // Marks `bytes` bytes reported by Visitor::OnDataAvailable as consumed. It
+  // doesn't block the calling thread.
+  virtual void Consume(size_t bytes) = 0;
   // Indicates the number of bytes that can be read from the stream.
+  // ReadableBytes, BufferedDataBytes and CanWrite don't block the calling
+  // thread. When they are called on a thread other than IO thread, they return
+  // a snapshot published by IO thread after the most recent read, write or
+  // stream event. The snapshot may be stale until IO thread handles the next
+  // event, e.g.: BufferedDataBytes doesn't drop for acknowledged data until
+  // next OnCanWrite.
   virtual size_t ReadableBytes() const = 0;
+  // Sets the send order of this stream. Ref:
+  // https://w3c.github.io/webtransport/#dom-webtransportsendstreamoptions-sendorder.
+  // Data of streams with higher send order is sent before data of streams with
+  // lower send order in the same session. Default send order is 0. Because
+  // quiche's write scheduler supports 8 priority levels, send orders are
+  // quantized: values greater than 3 are treated as 3, values less than -4 are
+  // treated as -4. Streams with the same level share bandwidth in round robin.
+  // It doesn't block the calling thread.
+  virtual void SetSendOrder(int32_t send_order) = 0;
   // Close the stream, send FIN to remote side.
   virtual void Close() = 0;
   // Bytes of data buffered.
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/async_proof_source.h"
+#include <utility>
+#include "base/bind.h"
+#include "base/check.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/thread_pool.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+
+namespace owt {
+namespace quic {
+
+// Runs on the thread pool. Posts the result of GetProof to IO thread.
+class AsyncProofSource::PostingCallback
+    : public ::quic::ProofSource::Callback {
+ public:
+  PostingCallback(scoped_refptr<base::SequencedTaskRunner> reply_runner,
+                  base::WeakPtr<AsyncProofSource> source,
+                  base::TimeTicks start_time,
+                  std::unique_ptr<::quic::ProofSource::Callback> callback)
+      : reply_runner_(std::move(reply_runner)),
+        source_(source),
+        start_time_(start_time),
+        callback_(std::move(callback)) {}
+
+  void Run(
+      bool ok,
+      const ::quic::QuicReferenceCountedPointer<::quic::ProofSource::Chain>&
+          chain,
+      const ::quic::QuicCryptoProof& proof,
+      std::unique_ptr<::quic::ProofSource::Details> details) override {
+    reply_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(
+            [](base::WeakPtr<AsyncProofSource> source,
+               base::TimeTicks start_time,
+               std::unique_ptr<::quic::ProofSource::Callback> callback,
+               bool ok,
+               ::quic::QuicReferenceCountedPointer<::quic::ProofSource::Chain>
+                   chain,
+               ::quic::QuicCryptoProof proof,
+               std::unique_ptr<::quic::ProofSource::Details> details) {
+              if (source) {
+                source->OnSignatureComputed(start_time);
+              }
+              callback->Run(ok, chain, proof, std::move(details));
+            },
+            source_, start_time_, std::move(callback_), ok, chain, proof,
+            std::move(details)));
+  }
+
+ private:
+  scoped_refptr<base::SequencedTaskRunner> reply_runner_;
+  base::WeakPtr<AsyncProofSource> source_;
+  base::TimeTicks start_time_;
+  std::unique_ptr<::quic::ProofSource::Callback> callback_;
+};
+
+// Runs on the thread pool. Posts the result of ComputeTlsSignature to IO
+// thread.
+class AsyncProofSource::PostingSignatureCallback
+    : public ::quic::ProofSource::SignatureCallback {
+ public:
+  PostingSignatureCallback(
+      scoped_refptr<base::SequencedTaskRunner> reply_runner,
+      base::WeakPtr<AsyncProofSource> source,
+      base::TimeTicks start_time,
+      std::unique_ptr<::quic::ProofSource::SignatureCallback> callback)
+      : reply_runner_(std::move(reply_runner)),
+        source_(source),
+        start_time_(start_time),
+        callback_(std::move(callback)) {}
+
+  void Run(bool ok,
+           std::string signature,
+           std::unique_ptr<::quic::ProofSource::Details> details) override {
+    reply_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(
+            [](base::WeakPtr<AsyncProofSource> source,
+               base::TimeTicks start_time,
+               std::unique_ptr<::quic::ProofSource::SignatureCallback>
+                   callback,
+               bool ok, std::string signature,
+               std::unique_ptr<::quic::ProofSource::Details> details) {
+              if (source) {
+                source->OnSignatureComputed(start_time);
+              }
+              // The handshake may be gone. Its callback is cancelled then, and
+              // running it does nothing.
+              callback->Run(ok, std::move(signature), std::move(details));
+            },
+            source_, start_time_, std::move(callback_), ok,
+            std::move(signature), std::move(details)));
+  }
+
+ private:
+  scoped_refptr<base::SequencedTaskRunner> reply_runner_;
+  base::WeakPtr<AsyncProofSource> source_;
+  base::TimeTicks start_time_;
+  std::unique_ptr<::quic::ProofSource::SignatureCallback> callback_;
+};
+
+AsyncProofSource::Signer::Signer(
+    std::unique_ptr<::quic::ProofSource> proof_source)
+    : proof_source_(std::move(proof_source)) {}
+
+AsyncProofSource::Signer::~Signer() = default;
+
+AsyncProofSource::AsyncProofSource(
+    std::unique_ptr<::quic::ProofSource> proof_source)
+    : signer_(base::MakeRefCounted<Signer>(std::move(proof_source))),
+      pending_signatures_(0),
+      signatures_computed_(0) {
+  CHECK(signer_->proof_source());
+}
+
+AsyncProofSource::~AsyncProofSource() = default;
+
+void AsyncProofSource::GetProof(
+    const ::quic::QuicSocketAddress& server_address,
+    const ::quic::QuicSocketAddress& client_address,
+    const std::string& hostname,
+    const std::string& server_config,
+    ::quic::QuicTransportVersion quic_version,
+    absl::string_view chlo_hash,
+    std::unique_ptr<Callback> callback) {
+  pending_signatures_++;
+  auto posting_callback = std::make_unique<PostingCallback>(
+      base::SequencedTaskRunnerHandle::Get(), weak_factory_.GetWeakPtr(),
+      base::TimeTicks::Now(), std::move(callback));
+  base::ThreadPool::PostTask(
+      FROM_HERE,
+      {base::TaskPriority::USER_BLOCKING,
+       base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN},
+      base::BindOnce(
+          [](scoped_refptr<Signer> signer,
+             const ::quic::QuicSocketAddress& server_address,
+             const ::quic::QuicSocketAddress& client_address,
+             const std::string& hostname, const std::string& server_config,
+             ::quic::QuicTransportVersion quic_version,
+             const std::string& chlo_hash,
+             std::unique_ptr<PostingCallback> callback) {
+            signer->proof_source()->GetProof(
+                server_address, client_address, hostname, server_config,
+                quic_version, chlo_hash, std::move(callback));
+          },
+          signer_, server_address, client_address, hostname, server_config,
+          quic_version, std::string(chlo_hash), std::move(posting_callback)));
+}
+
+::quic::QuicReferenceCountedPointer<::quic::ProofSource::Chain>
+AsyncProofSource::GetCertChain(const ::quic::QuicSocketAddress& server_address,
+                               const ::quic::QuicSocketAddress& client_address,
+                               const std::string& hostname,
+                               bool* cert_matched_sni) {
+  return signer_->proof_source()->GetCertChain(server_address, client_address,
+                                               hostname, cert_matched_sni);
+}
+
+void AsyncProofSource::ComputeTlsSignature(
+    const ::quic::QuicSocketAddress& server_address,
+    const ::quic::QuicSocketAddress& client_address,
+    const std::string& hostname,
+    uint16_t signature_algorithm,
+    absl::string_view in,
+    std::unique_ptr<SignatureCallback> callback) {
+  pending_signatures_++;
+  auto posting_callback = std::make_unique<PostingSignatureCallback>(
+      base::SequencedTaskRunnerHandle::Get(), weak_factory_.GetWeakPtr(),
+      base::TimeTicks::Now(), std::move(callback));
+  base::ThreadPool::PostTask(
+      FROM_HERE,
+      {base::TaskPriority::USER_BLOCKING,
+       base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN},
+      base::BindOnce(
+          [](scoped_refptr<Signer> signer,
+             const ::quic::QuicSocketAddress& server_address,
+             const ::quic::QuicSocketAddress& client_address,
+             const std::string& hostname, uint16_t signature_algorithm,
+             const std::string& in,
+             std::unique_ptr<PostingSignatureCallback> callback) {
+            signer->proof_source()->ComputeTlsSignature(
+                server_address, client_address, hostname, signature_algorithm,
+                in, std::move(callback));
+          },
+          signer_, server_address, client_address, hostname,
+          signature_algorithm, std::string(in), std::move(posting_callback)));
+}
+
+absl::InlinedVector<uint16_t, 8>
+AsyncProofSource::SupportedTlsSignatureAlgorithms() const {
+  return signer_->proof_source()->SupportedTlsSignatureAlgorithms();
+}
+
+::quic::ProofSource::TicketCrypter* AsyncProofSource::GetTicketCrypter() {
+  return signer_->proof_source()->GetTicketCrypter();
+}
+
+void AsyncProofSource::OnSignatureComputed(base::TimeTicks start_time) {
+  DCHECK_GT(pending_signatures_, 0u);
+  pending_signatures_--;
+  signatures_computed_++;
+  total_signing_time_ += base::TimeTicks::Now() - start_time;
+}
+
+}  // namespace quic
+}  // namespace owt
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/async_proof_source.h"
+#include <memory>
+#include <string>
+#include <utility>
+#include "base/test/task_environment.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace owt {
+namespace quic {
+namespace test {
+
+namespace {
+// Signs synchronously and records the thread it signs on.
+class FakeProofSource : public ::quic::ProofSource {
+ public:
+  explicit FakeProofSource(base::PlatformThreadId* signing_thread)
+      : signing_thread_(signing_thread) {}
+
+  void GetProof(const ::quic::QuicSocketAddress& server_address,
+                const ::quic::QuicSocketAddress& client_address,
+                const std::string& hostname,
+                const std::string& server_config,
+                ::quic::QuicTransportVersion quic_version,
+                absl::string_view chlo_hash,
+                std::unique_ptr<Callback> callback) override {
+    *signing_thread_ = base::PlatformThread::CurrentId();
+    ::quic::QuicCryptoProof proof;
+    proof.signature = "proof:" + std::string(chlo_hash);
+    callback->Run(true, nullptr, proof, nullptr);
+  }
+
+  ::quic::QuicReferenceCountedPointer<::quic::ProofSource::Chain> GetCertChain(
+      const ::quic::QuicSocketAddress& server_address,
+      const ::quic::QuicSocketAddress& client_address,
+      const std::string& hostname,
+      bool* cert_matched_sni) override {
+    *cert_matched_sni = true;
+    return nullptr;
+  }
+
+  void ComputeTlsSignature(
+      const ::quic::QuicSocketAddress& server_address,
+      const ::quic::QuicSocketAddress& client_address,
+      const std::string& hostname,
+      uint16_t signature_algorithm,
+      absl::string_view in,
+      std::unique_ptr<SignatureCallback> callback) override {
+    *signing_thread_ = base::PlatformThread::CurrentId();
+    callback->Run(true, "signature:" + std::string(in), nullptr);
+  }
+
+  absl::InlinedVector<uint16_t, 8> SupportedTlsSignatureAlgorithms()
+      const override {
+    return {};
+  }
+
+  TicketCrypter* GetTicketCrypter() override { return nullptr; }
+
+ private:
+  base::PlatformThreadId* signing_thread_;
+};
+
+class RecordingSignatureCallback
+    : public ::quic::ProofSource::SignatureCallback {
+ public:
+  RecordingSignatureCallback(bool* called,
+                             std::string* signature,
+                             base::PlatformThreadId* thread)
+      : called_(called), signature_(signature), thread_(thread) {}
+
+  void Run(bool ok,
+           std::string signature,
+           std::unique_ptr<::quic::ProofSource::Details> details) override {
+    EXPECT_TRUE(ok);
+    *called_ = true;
+    *signature_ = std::move(signature);
+    *thread_ = base::PlatformThread::CurrentId();
+  }
+
+ private:
+  bool* called_;
+  std::string* signature_;
+  base::PlatformThreadId* thread_;
+};
+
+class RecordingCallback : public ::quic::ProofSource::Callback {
+ public:
+  RecordingCallback(bool* called, std::string* signature)
+      : called_(called), signature_(signature) {}
+
+  void Run(
+      bool ok,
+      const ::quic::QuicReferenceCountedPointer<::quic::ProofSource::Chain>&
+          chain,
+      const ::quic::QuicCryptoProof& proof,
+      std::unique_ptr<::quic::ProofSource::Details> details) override {
+    EXPECT_TRUE(ok);
+    *called_ = true;
+    *signature_ = proof.signature;
+  }
+
+ private:
+  bool* called_;
+  std::string* signature_;
+};
+}  // namespace
+
+class AsyncProofSourceTest : public testing::Test {
+ public:
+  AsyncProofSourceTest()
+      : signing_thread_(base::kInvalidThreadId),
+        proof_source_(std::make_unique<FakeProofSource>(&signing_thread_)) {}
+
+ protected:
+  base::test::TaskEnvironment task_environment_;
+  base::PlatformThreadId signing_thread_;
+  AsyncProofSource proof_source_;
+  ::quic::QuicSocketAddress server_address_;
+  ::quic::QuicSocketAddress client_address_;
+};
+
+TEST_F(AsyncProofSourceTest, ComputeTlsSignatureOnThreadPool) {
+  bool called = false;
+  std::string signature;
+  base::PlatformThreadId callback_thread = base::kInvalidThreadId;
+  proof_source_.ComputeTlsSignature(
+      server_address_, client_address_, "localhost", 0x0804, "data",
+      std::make_unique<RecordingSignatureCallback>(&called, &signature,
+                                                   &callback_thread));
+  EXPECT_FALSE(called);
+  EXPECT_EQ(proof_source_.pending_signatures(), 1u);
+  task_environment_.RunUntilIdle();
+  EXPECT_TRUE(called);
+  EXPECT_EQ(signature, "signature:data");
+  EXPECT_NE(signing_thread_, base::PlatformThread::CurrentId());
+  EXPECT_EQ(callback_thread, base::PlatformThread::CurrentId());
+  EXPECT_EQ(proof_source_.pending_signatures(), 0u);
+  EXPECT_EQ(proof_source_.signatures_computed(), 1u);
+}
+
+TEST_F(AsyncProofSourceTest, GetProofOnThreadPool) {
+  bool called = false;
+  std::string signature;
+  proof_source_.GetProof(server_address_, client_address_, "localhost",
+                         "server_config", ::quic::QUIC_VERSION_50, "hash",
+                         std::make_unique<RecordingCallback>(&called,
+                                                             &signature));
+  EXPECT_FALSE(called);
+  task_environment_.RunUntilIdle();
+  EXPECT_TRUE(called);
+  EXPECT_EQ(signature, "proof:hash");
+  EXPECT_NE(signing_thread_, base::PlatformThread::CurrentId());
+  EXPECT_EQ(proof_source_.signatures_computed(), 1u);
+}
+
+TEST_F(AsyncProofSourceTest, ForwardsCertChainSynchronously) {
+  bool cert_matched_sni = false;
+  proof_source_.GetCertChain(server_address_, client_address_, "localhost",
+                             &cert_matched_sni);
+  EXPECT_TRUE(cert_matched_sni);
+}
+
+}  // namespace test
+}  // namespace quic
+}  // namespace owt
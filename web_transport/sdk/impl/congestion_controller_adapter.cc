@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/congestion_controller_adapter.h"
+#include <utility>
+#include "base/check.h"
+#include "base/strings/string_number_conversions.h"
+
+namespace owt {
+namespace quic {
+
+namespace {
+int64_t ToMicroseconds(::quic::QuicTime time) {
+  return (time - ::quic::QuicTime::Zero()).ToMicroseconds();
+}
+}  // namespace
+
+CongestionControllerAdapter::CongestionControllerAdapter(
+    std::unique_ptr<CongestionControllerInterface> controller,
+    const ::quic::RttStats* rtt_stats)
+    : controller_(std::move(controller)), rtt_stats_(rtt_stats) {
+  CHECK(controller_);
+  CHECK(rtt_stats_);
+}
+
+CongestionControllerAdapter::~CongestionControllerAdapter() = default;
+
+void CongestionControllerAdapter::OnCongestionEvent(
+    bool rtt_updated,
+    ::quic::QuicByteCount prior_in_flight,
+    ::quic::QuicTime event_time,
+    const ::quic::AckedPacketVector& acked_packets,
+    const ::quic::LostPacketVector& lost_packets) {
+  acked_packets_.clear();
+  for (const auto& packet : acked_packets) {
+    acked_packets_.push_back(
+        {packet.packet_number.ToUint64(), packet.bytes_acked,
+         packet.receive_timestamp.IsInitialized()
+             ? ToMicroseconds(packet.receive_timestamp)
+             : 0});
+  }
+  lost_packets_.clear();
+  for (const auto& packet : lost_packets) {
+    lost_packets_.push_back(
+        {packet.packet_number.ToUint64(), packet.bytes_lost});
+  }
+  CongestionEvent event;
+  event.event_time_us = ToMicroseconds(event_time);
+  event.prior_in_flight = prior_in_flight;
+  event.rtt_updated = rtt_updated;
+  event.latest_rtt_us = rtt_stats_->latest_rtt().ToMicroseconds();
+  event.smoothed_rtt_us = rtt_stats_->smoothed_rtt().ToMicroseconds();
+  event.min_rtt_us = rtt_stats_->min_rtt().ToMicroseconds();
+  event.acked_packets = acked_packets_.data();
+  event.acked_packet_count = acked_packets_.size();
+  event.lost_packets = lost_packets_.data();
+  event.lost_packet_count = lost_packets_.size();
+  controller_->OnCongestionEvent(event);
+}
+
+void CongestionControllerAdapter::OnPacketSent(
+    ::quic::QuicTime sent_time,
+    ::quic::QuicByteCount bytes_in_flight,
+    ::quic::QuicPacketNumber packet_number,
+    ::quic::QuicByteCount bytes,
+    ::quic::HasRetransmittableData is_retransmittable) {
+  controller_->OnPacketSent(
+      ToMicroseconds(sent_time), bytes_in_flight, packet_number.ToUint64(),
+      bytes, is_retransmittable == ::quic::HAS_RETRANSMITTABLE_DATA);
+}
+
+void CongestionControllerAdapter::OnRetransmissionTimeout(
+    bool packets_retransmitted) {
+  controller_->OnRetransmissionTimeout(packets_retransmitted);
+}
+
+bool CongestionControllerAdapter::CanSend(
+    ::quic::QuicByteCount bytes_in_flight) {
+  return bytes_in_flight < controller_->GetCongestionWindow();
+}
+
+::quic::QuicBandwidth CongestionControllerAdapter::PacingRate(
+    ::quic::QuicByteCount bytes_in_flight) const {
+  return ::quic::QuicBandwidth::FromBitsPerSecond(
+      controller_->GetPacingRate(bytes_in_flight));
+}
+
+::quic::QuicBandwidth CongestionControllerAdapter::BandwidthEstimate() const {
+  return ::quic::QuicBandwidth::FromBitsPerSecond(
+      controller_->GetBandwidthEstimate());
+}
+
+::quic::QuicByteCount CongestionControllerAdapter::GetCongestionWindow() const {
+  return controller_->GetCongestionWindow();
+}
+
+bool CongestionControllerAdapter::InSlowStart() const {
+  return false;
+}
+
+bool CongestionControllerAdapter::InRecovery() const {
+  return false;
+}
+
+bool CongestionControllerAdapter::ShouldSendProbingPacket() const {
+  return false;
+}
+
+::quic::QuicByteCount CongestionControllerAdapter::GetSlowStartThreshold()
+    const {
+  return 0;
+}
+
+::quic::CongestionControlType
+CongestionControllerAdapter::GetCongestionControlType() const {
+  // quiche doesn't have a type for external controllers. kGoogCC is not
+  // implemented by quiche, so it's never mistaken for a built-in one.
+  return ::quic::kGoogCC;
+}
+
+std::string CongestionControllerAdapter::GetDebugState() const {
+  return "application congestion controller, cwnd: " +
+         base::NumberToString(controller_->GetCongestionWindow());
+}
+
+void CongestionControllerAdapter::OnApplicationLimited(
+    ::quic::QuicByteCount bytes_in_flight) {
+  controller_->OnApplicationLimited(bytes_in_flight);
+}
+
+}  // namespace quic
+}  // namespace owt
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_QUIC_WEB_TRANSPORT_CONGESTION_CONTROLLER_ADAPTER_H_
+#define OWT_QUIC_WEB_TRANSPORT_CONGESTION_CONTROLLER_ADAPTER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "net/third_party/quiche/src/quic/core/congestion_control/rtt_stats.h"
+#include "net/third_party/quiche/src/quic/core/congestion_control/send_algorithm_interface.h"
+#include "owt/quic/congestion_controller_interface.h"
+
+namespace owt {
+namespace quic {
+
+// Adapts an application provided CongestionControllerInterface to quiche's
+// SendAlgorithmInterface. Slow start, recovery and probing are left to the
+// application's controller, so they are always reported as inactive.
+class CongestionControllerAdapter : public ::quic::SendAlgorithmInterface {
+ public:
+  // `rtt_stats` is owned by the sent packet manager which owns this adapter.
+  CongestionControllerAdapter(
+      std::unique_ptr<CongestionControllerInterface> controller,
+      const ::quic::RttStats* rtt_stats);
+  ~CongestionControllerAdapter() override;
+
+  // Overrides ::quic::SendAlgorithmInterface.
+  void SetFromConfig(const ::quic::QuicConfig& config,
+                     ::quic::Perspective perspective) override {}
+  void ApplyConnectionOptions(
+      const ::quic::QuicTagVector& connection_options) override {}
+  void SetInitialCongestionWindowInPackets(
+      ::quic::QuicPacketCount packets) override {}
+  void OnCongestionEvent(
+      bool rtt_updated,
+      ::quic::QuicByteCount prior_in_flight,
+      ::quic::QuicTime event_time,
+      const ::quic::AckedPacketVector& acked_packets,
+      const ::quic::LostPacketVector& lost_packets) override;
+  void OnPacketSent(
+      ::quic::QuicTime sent_time,
+      ::quic::QuicByteCount bytes_in_flight,
+      ::quic::QuicPacketNumber packet_number,
+      ::quic::QuicByteCount bytes,
+      ::quic::HasRetransmittableData is_retransmittable) override;
+  void OnPacketNeutered(::quic::QuicPacketNumber packet_number) override {}
+  void OnRetransmissionTimeout(bool packets_retransmitted) override;
+  void OnConnectionMigration() override {}
+  bool CanSend(::quic::QuicByteCount bytes_in_flight) override;
+  ::quic::QuicBandwidth PacingRate(
+      ::quic::QuicByteCount bytes_in_flight) const override;
+  ::quic::QuicBandwidth BandwidthEstimate() const override;
+  ::quic::QuicByteCount GetCongestionWindow() const override;
+  bool InSlowStart() const override;
+  bool InRecovery() const override;
+  bool ShouldSendProbingPacket() const override;
+  ::quic::QuicByteCount GetSlowStartThreshold() const override;
+  ::quic::CongestionControlType GetCongestionControlType() const override;
+  void AdjustNetworkParameters(const NetworkParams& params) override {}
+  std::string GetDebugState() const override;
+  void OnApplicationLimited(::quic::QuicByteCount bytes_in_flight) override;
+  void PopulateConnectionStats(
+      ::quic::QuicConnectionStats* stats) const override {}
+
+ private:
+  std::unique_ptr<CongestionControllerInterface> controller_;
+  const ::quic::RttStats* rtt_stats_;
+  // Reused by OnCongestionEvent to avoid allocations.
+  std::vector<AckedPacketInfo> acked_packets_;
+  std::vector<LostPacketInfo> lost_packets_;
+};
+
+}  // namespace quic
+}  // namespace owt
+
+#endif
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/congestion_controller_adapter.h"
+#include <memory>
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace owt {
+namespace quic {
+namespace test {
+
+::quic::QuicTime TimeFromMicroseconds(int64_t microseconds) {
+  return ::quic::QuicTime::Zero() +
+         ::quic::QuicTime::Delta::FromMicroseconds(microseconds);
+}
+
+class CongestionControllerMock : public CongestionControllerInterface {
+ public:
+  MOCK_METHOD5(OnPacketSent,
+               void(int64_t sent_time_us,
+                    uint64_t bytes_in_flight,
+                    uint64_t packet_number,
+                    uint64_t bytes,
+                    bool is_retransmittable));
+  MOCK_METHOD1(OnCongestionEvent, void(const CongestionEvent& event));
+  MOCK_CONST_METHOD0(GetCongestionWindow, uint64_t());
+  MOCK_CONST_METHOD1(GetPacingRate, uint64_t(uint64_t bytes_in_flight));
+};
+
+class CongestionControllerAdapterTest : public testing::Test {
+ public:
+  CongestionControllerAdapterTest() {
+    auto controller = std::make_unique<CongestionControllerMock>();
+    controller_ = controller.get();
+    adapter_ = std::make_unique<CongestionControllerAdapter>(
+        std::move(controller), &rtt_stats_);
+  }
+
+ protected:
+  ::quic::RttStats rtt_stats_;
+  CongestionControllerMock* controller_;
+  std::unique_ptr<CongestionControllerAdapter> adapter_;
+};
+
+TEST_F(CongestionControllerAdapterTest, CongestionWindowLimitsSending) {
+  EXPECT_CALL(*controller_, GetCongestionWindow())
+      .WillRepeatedly(testing::Return(10000));
+  EXPECT_TRUE(adapter_->CanSend(9999));
+  EXPECT_FALSE(adapter_->CanSend(10000));
+  EXPECT_EQ(adapter_->GetCongestionWindow(), 10000u);
+}
+
+TEST_F(CongestionControllerAdapterTest, PacingRate) {
+  EXPECT_CALL(*controller_, GetPacingRate(1200))
+      .WillOnce(testing::Return(1000000));
+  EXPECT_EQ(adapter_->PacingRate(1200).ToBitsPerSecond(), 1000000);
+}
+
+TEST_F(CongestionControllerAdapterTest, OnPacketSent) {
+  EXPECT_CALL(*controller_, OnPacketSent(1000, 2400, 3, 1200, true));
+  adapter_->OnPacketSent(TimeFromMicroseconds(1000), 2400,
+                         ::quic::QuicPacketNumber(3), 1200,
+                         ::quic::HAS_RETRANSMITTABLE_DATA);
+}
+
+TEST_F(CongestionControllerAdapterTest, OnCongestionEvent) {
+  ::quic::AckedPacketVector acked_packets;
+  acked_packets.emplace_back(::quic::QuicPacketNumber(1), 1200,
+                             ::quic::QuicTime::Zero());
+  acked_packets.emplace_back(::quic::QuicPacketNumber(2), 1000,
+                             ::quic::QuicTime::Zero());
+  ::quic::LostPacketVector lost_packets;
+  lost_packets.emplace_back(::quic::QuicPacketNumber(3), 800);
+  EXPECT_CALL(*controller_, OnCongestionEvent(testing::_))
+      .WillOnce([](const CongestionEvent& event) {
+        EXPECT_EQ(event.event_time_us, 2000);
+        EXPECT_EQ(event.prior_in_flight, 3000u);
+        EXPECT_TRUE(event.rtt_updated);
+        ASSERT_EQ(event.acked_packet_count, 2u);
+        EXPECT_EQ(event.acked_packets[0].packet_number, 1u);
+        EXPECT_EQ(event.acked_packets[0].bytes_acked, 1200u);
+        EXPECT_EQ(event.acked_packets[1].packet_number, 2u);
+        EXPECT_EQ(event.acked_packets[1].bytes_acked, 1000u);
+        ASSERT_EQ(event.lost_packet_count, 1u);
+        EXPECT_EQ(event.lost_packets[0].packet_number, 3u);
+        EXPECT_EQ(event.lost_packets[0].bytes_lost, 800u);
+      });
+  adapter_->OnCongestionEvent(true, 3000, TimeFromMicroseconds(2000),
+                              acked_packets, lost_packets);
+}
+
+}  // namespace test
+}  // namespace quic
+}  // namespace owt
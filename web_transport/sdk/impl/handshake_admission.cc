@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/handshake_admission.h"
+#include <algorithm>
+#include "base/check.h"
+#include "base/logging.h"
+#include "net/third_party/quiche/src/quic/core/quic_constants.h"
+#include "net/third_party/quiche/src/quic/core/quic_data_reader.h"
+#include "net/third_party/quiche/src/quic/core/quic_data_writer.h"
+#include "net/third_party/quiche/src/quic/core/quic_utils.h"
+
+namespace owt {
+namespace quic {
+
+namespace {
+// Same as the lifetime of connections in QuicBufferedPacketStore.
+constexpr ::quic::QuicTime::Delta kPendingHandshakeTimeout =
+    ::quic::QuicTime::Delta::FromSeconds(5);
+constexpr ::quic::QuicTime::Delta kRetryTokenLifetime =
+    ::quic::QuicTime::Delta::FromSeconds(10);
+constexpr size_t kTokenKeySize = 16;
+constexpr size_t kTokenNonceSize = 12;
+// Long header, fixed bit and packet type 3.
+constexpr uint8_t kRetryPacketTypeByte = 0xf0;
+constexpr size_t kRetryIntegrityTagSize = 16;
+// Retry integrity keys and nonces defined in RFC 9001 and
+// draft-ietf-quic-tls-29.
+constexpr uint8_t kRfcV1RetryIntegrityKey[] = {
+    0xbe, 0x0c, 0x69, 0x0b, 0x9f, 0x66, 0x57, 0x5a,
+    0x1d, 0x76, 0x6b, 0x54, 0xe3, 0x68, 0xc8, 0x4e};
+constexpr uint8_t kRfcV1RetryIntegrityNonce[] = {
+    0x46, 0x15, 0x99, 0xd3, 0x5d, 0x63, 0x2b, 0xf2, 0x23, 0x98, 0x25, 0xbb};
+constexpr uint8_t kDraft29RetryIntegrityKey[] = {
+    0xcc, 0xce, 0x18, 0x7e, 0xd0, 0x9a, 0x09, 0xd0,
+    0x57, 0x28, 0x15, 0x5a, 0x6c, 0xb9, 0x6b, 0xe1};
+constexpr uint8_t kDraft29RetryIntegrityNonce[] = {
+    0xe5, 0x49, 0x30, 0xf9, 0x7f, 0x21, 0x36, 0xf0, 0x53, 0x0a, 0x8c, 0x1c};
+}  // namespace
+
+HandshakeAdmission::HandshakeAdmission(const ::quic::QuicClock* clock,
+                                       ::quic::QuicRandom* random)
+    : clock_(clock),
+      random_(random),
+      handshakes_per_second_(0),
+      max_pending_handshakes_(kDefaultMaxPendingHandshakes),
+      tokens_(0),
+      last_refill_time_(clock->ApproximateNow()),
+      handshakes_deferred_(0),
+      handshakes_rejected_(0) {
+  CHECK(clock_);
+  CHECK(random_);
+  uint8_t key[kTokenKeySize];
+  random_->RandBytes(key, sizeof(key));
+  CHECK(EVP_AEAD_CTX_init(token_aead_.get(), EVP_aead_aes_128_gcm(), key,
+                          sizeof(key), EVP_AEAD_DEFAULT_TAG_LENGTH, nullptr));
+}
+
+HandshakeAdmission::~HandshakeAdmission() = default;
+
+void HandshakeAdmission::SetLimits(uint32_t handshakes_per_second,
+                                   size_t max_pending_handshakes) {
+  handshakes_per_second_ = handshakes_per_second;
+  max_pending_handshakes_ = max_pending_handshakes > 0
+                                ? max_pending_handshakes
+                                : kDefaultMaxPendingHandshakes;
+  tokens_ = handshakes_per_second_;
+  last_refill_time_ = clock_->ApproximateNow();
+}
+
+// static
+bool HandshakeAdmission::SupportsRetry(
+    const ::quic::ParsedQuicVersion& version) {
+  return version == ::quic::ParsedQuicVersion::RFCv1() ||
+         version == ::quic::ParsedQuicVersion::Draft29();
+}
+
+HandshakeAdmission::Decision HandshakeAdmission::OnInitialPacket(
+    const ::quic::QuicConnectionId& connection_id,
+    const ::quic::QuicSocketAddress& peer_address,
+    absl::string_view token) {
+  RemoveExpiredPendingHandshakes();
+  if (pending_handshakes_.count(connection_id) > 0) {
+    return Decision::kAccept;
+  }
+  // Tokens from NEW_TOKEN frames are not validated here, so clients with
+  // invalid tokens are treated as clients without tokens.
+  absl::optional<::quic::QuicConnectionId> original_connection_id;
+  if (!token.empty()) {
+    original_connection_id = ValidateRetryToken(token, peer_address);
+  }
+  if (!original_connection_id && !TakeToken()) {
+    handshakes_deferred_++;
+    return Decision::kRetry;
+  }
+  if (pending_handshakes_.size() >= max_pending_handshakes_) {
+    handshakes_rejected_++;
+    return Decision::kReject;
+  }
+  pending_handshakes_[connection_id] = {clock_->ApproximateNow(),
+                                        original_connection_id};
+  admission_order_.push_back(connection_id);
+  return Decision::kAccept;
+}
+
+absl::optional<::quic::QuicConnectionId> HandshakeAdmission::OnSessionCreated(
+    const ::quic::QuicConnectionId& connection_id) {
+  auto it = pending_handshakes_.find(connection_id);
+  if (it == pending_handshakes_.end()) {
+    return absl::nullopt;
+  }
+  absl::optional<::quic::QuicConnectionId> original_connection_id =
+      it->second.original_connection_id;
+  pending_handshakes_.erase(it);
+  return original_connection_id;
+}
+
+std::string HandshakeAdmission::BuildRetryPacket(
+    const ::quic::ParsedQuicVersion& version,
+    const ::quic::QuicConnectionId& original_connection_id,
+    const ::quic::QuicConnectionId& client_connection_id,
+    const ::quic::QuicSocketAddress& peer_address) {
+  DCHECK(SupportsRetry(version));
+  // Client's next Initial packets are sent to the new connection ID. It has
+  // the default length, so the dispatcher creates a session with it rather
+  // than replacing it.
+  const ::quic::QuicConnectionId server_connection_id =
+      ::quic::QuicUtils::CreateRandomConnectionId(
+          ::quic::kQuicDefaultConnectionIdLength, random_);
+  const std::string token =
+      NewRetryToken(peer_address, original_connection_id);
+  // Pseudo packet for the integrity tag is the original destination
+  // connection ID followed by the Retry packet without tag.
+  const size_t packet_size = 1 + 4 + 1 + client_connection_id.length() + 1 +
+                             server_connection_id.length() + token.size();
+  const size_t pseudo_packet_size =
+      1 + original_connection_id.length() + packet_size;
+  std::string pseudo_packet(pseudo_packet_size, 0);
+  ::quic::QuicDataWriter writer(pseudo_packet.size(), &pseudo_packet[0]);
+  uint8_t unused_bits;
+  random_->RandBytes(&unused_bits, sizeof(unused_bits));
+  bool success =
+      writer.WriteLengthPrefixedConnectionId(original_connection_id) &&
+      writer.WriteUInt8(kRetryPacketTypeByte | (unused_bits & 0x0f)) &&
+      writer.WriteUInt32(::quic::CreateQuicVersionLabel(version)) &&
+      writer.WriteLengthPrefixedConnectionId(client_connection_id) &&
+      writer.WriteLengthPrefixedConnectionId(server_connection_id) &&
+      writer.WriteStringPiece(token);
+  DCHECK(success);
+  DCHECK_EQ(writer.remaining(), 0u);
+
+  const bool rfc_v1 = version == ::quic::ParsedQuicVersion::RFCv1();
+  bssl::ScopedEVP_AEAD_CTX integrity_aead;
+  CHECK(EVP_AEAD_CTX_init(
+      integrity_aead.get(), EVP_aead_aes_128_gcm(),
+      rfc_v1 ? kRfcV1RetryIntegrityKey : kDraft29RetryIntegrityKey,
+      sizeof(kRfcV1RetryIntegrityKey), kRetryIntegrityTagSize, nullptr));
+  uint8_t tag[kRetryIntegrityTagSize];
+  size_t tag_size = 0;
+  CHECK(EVP_AEAD_CTX_seal(
+      integrity_aead.get(), tag, &tag_size, sizeof(tag),
+      rfc_v1 ? kRfcV1RetryIntegrityNonce : kDraft29RetryIntegrityNonce,
+      sizeof(kRfcV1RetryIntegrityNonce), nullptr, 0,
+      reinterpret_cast<const uint8_t*>(pseudo_packet.data()),
+      pseudo_packet.size()));
+  DCHECK_EQ(tag_size, kRetryIntegrityTagSize);
+
+  std::string packet = pseudo_packet.substr(pseudo_packet_size - packet_size);
+  packet.append(reinterpret_cast<const char*>(tag), tag_size);
+  return packet;
+}
+
+bool HandshakeAdmission::TakeToken() {
+  if (handshakes_per_second_ == 0) {
+    return true;
+  }
+  const ::quic::QuicTime now = clock_->ApproximateNow();
+  if (now > last_refill_time_) {
+    const double elapsed_seconds =
+        (now - last_refill_time_).ToMicroseconds() / 1e6;
+    tokens_ = std::min<double>(
+        handshakes_per_second_,
+        tokens_ + elapsed_seconds * handshakes_per_second_);
+    last_refill_time_ = now;
+  }
+  if (tokens_ < 1) {
+    return false;
+  }
+  tokens_ -= 1;
+  return true;
+}
+
+void HandshakeAdmission::RemoveExpiredPendingHandshakes() {
+  const ::quic::QuicTime now = clock_->ApproximateNow();
+  while (!admission_order_.empty()) {
+    auto it = pending_handshakes_.find(admission_order_.front());
+    if (it != pending_handshakes_.end()) {
+      if (now - it->second.admitted_time <= kPendingHandshakeTimeout) {
+        break;
+      }
+      pending_handshakes_.erase(it);
+    }
+    admission_order_.pop_front();
+  }
+}
+
+std::string HandshakeAdmission::NewRetryToken(
+    const ::quic::QuicSocketAddress& peer_address,
+    const ::quic::QuicConnectionId& original_connection_id) {
+  // Plaintext is expiry time, client's IP address and the original destination
+  // connection ID. Token is nonce followed by sealed plaintext.
+  const std::string address = peer_address.host().ToPackedString();
+  std::string plaintext(8 + 1 + address.size() + 1 +
+                            original_connection_id.length(),
+                        0);
+  ::quic::QuicDataWriter writer(plaintext.size(), &plaintext[0]);
+  const ::quic::QuicTime expiry =
+      clock_->ApproximateNow() + kRetryTokenLifetime;
+  bool success =
+      writer.WriteUInt64(expiry.ToDebuggingValue()) &&
+      writer.WriteUInt8(static_cast<uint8_t>(address.size())) &&
+      writer.WriteStringPiece(address) &&
+      writer.WriteLengthPrefixedConnectionId(original_connection_id);
+  DCHECK(success);
+
+  std::string token(kTokenNonceSize + plaintext.size() +
+                        EVP_AEAD_max_overhead(EVP_aead_aes_128_gcm()),
+                    0);
+  uint8_t* nonce = reinterpret_cast<uint8_t*>(&token[0]);
+  random_->RandBytes(nonce, kTokenNonceSize);
+  size_t sealed_size = 0;
+  CHECK(EVP_AEAD_CTX_seal(
+      token_aead_.get(), nonce + kTokenNonceSize, &sealed_size,
+      token.size() - kTokenNonceSize, nonce, kTokenNonceSize,
+      reinterpret_cast<const uint8_t*>(plaintext.data()), plaintext.size(),
+      nullptr, 0));
+  token.resize(kTokenNonceSize + sealed_size);
+  return token;
+}
+
+absl::optional<::quic::QuicConnectionId> HandshakeAdmission::ValidateRetryToken(
+    absl::string_view token,
+    const ::quic::QuicSocketAddress& peer_address) {
+  if (token.size() <= kTokenNonceSize) {
+    return absl::nullopt;
+  }
+  const uint8_t* nonce = reinterpret_cast<const uint8_t*>(token.data());
+  std::string plaintext(token.size() - kTokenNonceSize, 0);
+  size_t plaintext_size = 0;
+  if (!EVP_AEAD_CTX_open(token_aead_.get(),
+                         reinterpret_cast<uint8_t*>(&plaintext[0]),
+                         &plaintext_size, plaintext.size(), nonce,
+                         kTokenNonceSize, nonce + kTokenNonceSize,
+                         token.size() - kTokenNonceSize, nullptr, 0)) {
+    return absl::nullopt;
+  }
+  ::quic::QuicDataReader reader(plaintext.data(), plaintext_size);
+  uint64_t expiry;
+  absl::string_view address;
+  ::quic::QuicConnectionId original_connection_id;
+  if (!reader.ReadUInt64(&expiry) || !reader.ReadStringPiece8(&address) ||
+      !reader.ReadLengthPrefixedConnectionId(&original_connection_id)) {
+    return absl::nullopt;
+  }
+  if (static_cast<int64_t>(expiry) <
+      clock_->ApproximateNow().ToDebuggingValue()) {
+    DLOG(INFO) << "Retry token from " << peer_address.ToString()
+               << " is expired.";
+    return absl::nullopt;
+  }
+  if (address != peer_address.host().ToPackedString()) {
+    DLOG(INFO) << "Retry token is not issued for " << peer_address.ToString();
+    return absl::nullopt;
+  }
+  return original_connection_id;
+}
+
+}  // namespace quic
+}  // namespace owt
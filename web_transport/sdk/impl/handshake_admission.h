@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_QUIC_WEB_TRANSPORT_HANDSHAKE_ADMISSION_H_
+#define OWT_QUIC_WEB_TRANSPORT_HANDSHAKE_ADMISSION_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include "net/third_party/quiche/src/quic/core/crypto/quic_random.h"
+#include "net/third_party/quiche/src/quic/core/quic_clock.h"
+#include "net/third_party/quiche/src/quic/core/quic_connection_id.h"
+#include "net/third_party/quiche/src/quic/core/quic_time.h"
+#include "net/third_party/quiche/src/quic/core/quic_versions.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_socket_address.h"
+#include "third_party/abseil-cpp/absl/strings/string_view.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+#include "third_party/boringssl/src/include/openssl/aead.h"
+
+namespace owt {
+namespace quic {
+
+// Decides whether a new connection may start a handshake. New handshakes are
+// limited by a token bucket. Clients over the limit get a Retry packet, and
+// they are admitted when they come back with the address validation token in
+// it, so spoofed addresses can't use up the budget. Handshakes admitted but
+// still waiting for a session, e.g., CHLOs buffered by the dispatcher, are
+// capped as well. Only used on IO thread.
+class HandshakeAdmission {
+ public:
+  enum class Decision {
+    // Go on with the handshake.
+    kAccept,
+    // Send a Retry packet to the client.
+    kRetry,
+    // Drop the packet. The client may try again later.
+    kReject,
+  };
+
+  static constexpr size_t kDefaultMaxPendingHandshakes = 100;
+
+  HandshakeAdmission(const ::quic::QuicClock* clock,
+                     ::quic::QuicRandom* random);
+  ~HandshakeAdmission();
+  HandshakeAdmission(const HandshakeAdmission&) = delete;
+  HandshakeAdmission& operator=(const HandshakeAdmission&) = delete;
+
+  // `handshakes_per_second` 0 means unlimited. Bursts of one second are
+  // allowed. `max_pending_handshakes` 0 means 100.
+  void SetLimits(uint32_t handshakes_per_second,
+                 size_t max_pending_handshakes);
+
+  // Returns true if Retry packets can be built for `version`.
+  static bool SupportsRetry(const ::quic::ParsedQuicVersion& version);
+
+  // Called for each Initial packet of a connection without session.
+  // `connection_id` is the destination connection ID of the packet. Packets of
+  // an admitted handshake are always accepted.
+  Decision OnInitialPacket(const ::quic::QuicConnectionId& connection_id,
+                           const ::quic::QuicSocketAddress& peer_address,
+                           absl::string_view token);
+  // Called when a session is created for `connection_id`. Returns the
+  // original destination connection ID if the client was validated by a Retry
+  // packet.
+  absl::optional<::quic::QuicConnectionId> OnSessionCreated(
+      const ::quic::QuicConnectionId& connection_id);
+
+  // Builds a Retry packet in response to an Initial packet from
+  // `peer_address`, whose destination and source connection IDs are
+  // `original_connection_id` and `client_connection_id`. `version` must be
+  // supported.
+  std::string BuildRetryPacket(
+      const ::quic::ParsedQuicVersion& version,
+      const ::quic::QuicConnectionId& original_connection_id,
+      const ::quic::QuicConnectionId& client_connection_id,
+      const ::quic::QuicSocketAddress& peer_address);
+
+  // Number of clients asked to retry with an address validation token.
+  uint64_t handshakes_deferred() const { return handshakes_deferred_; }
+  // Number of Initial packets dropped because too many handshakes are pending.
+  uint64_t handshakes_rejected() const { return handshakes_rejected_; }
+
+ private:
+  struct PendingHandshake {
+    ::quic::QuicTime admitted_time;
+    absl::optional<::quic::QuicConnectionId> original_connection_id;
+  };
+
+  // Takes a token from the bucket. Returns false if it's empty.
+  bool TakeToken();
+  // Removes pending handshakes which never got a session, including those
+  // whose session is created with another connection ID.
+  void RemoveExpiredPendingHandshakes();
+  std::string NewRetryToken(
+      const ::quic::QuicSocketAddress& peer_address,
+      const ::quic::QuicConnectionId& original_connection_id);
+  // Returns the original destination connection ID in `token` if it's issued
+  // by this server for `peer_address` and not expired.
+  absl::optional<::quic::QuicConnectionId> ValidateRetryToken(
+      absl::string_view token,
+      const ::quic::QuicSocketAddress& peer_address);
+
+  const ::quic::QuicClock* clock_;
+  ::quic::QuicRandom* random_;
+  uint32_t handshakes_per_second_;
+  size_t max_pending_handshakes_;
+  // Token bucket.
+  double tokens_;
+  ::quic::QuicTime last_refill_time_;
+  // Key is the destination connection ID of the client's Initial packets. The
+  // dispatcher may create the session with a connection ID of its own, so
+  // entries are not always removed by OnSessionCreated.
+  std::unordered_map<::quic::QuicConnectionId,
+                     PendingHandshake,
+                     ::quic::QuicConnectionIdHash>
+      pending_handshakes_;
+  // Keys of `pending_handshakes_` in the order they are admitted. It may have
+  // keys already removed from `pending_handshakes_`.
+  std::deque<::quic::QuicConnectionId> admission_order_;
+  // Encrypts address validation tokens with a key only known to this object.
+  bssl::ScopedEVP_AEAD_CTX token_aead_;
+  uint64_t handshakes_deferred_;
+  uint64_t handshakes_rejected_;
+};
+
+}  // namespace quic
+}  // namespace owt
+
+#endif
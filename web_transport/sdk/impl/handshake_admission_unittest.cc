@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/handshake_admission.h"
+#include <string>
+#include "net/third_party/quiche/src/quic/core/quic_data_reader.h"
+#include "net/third_party/quiche/src/quic/test_tools/mock_clock.h"
+#include "net/third_party/quiche/src/quic/test_tools/quic_test_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace owt {
+namespace quic {
+namespace test {
+
+class HandshakeAdmissionTest : public testing::Test {
+ public:
+  HandshakeAdmissionTest()
+      : admission_(&clock_, ::quic::QuicRandom::GetInstance()),
+        peer_address_(::quic::QuicIpAddress::Loopback4(), 4433) {
+    clock_.AdvanceTime(::quic::QuicTime::Delta::FromSeconds(1));
+  }
+
+ protected:
+  // Returns the token in `retry` and sets `server_connection_id` to the source
+  // connection ID of `retry`.
+  std::string ParseRetryPacket(
+      const std::string& retry,
+      ::quic::QuicConnectionId* server_connection_id) {
+    ::quic::QuicDataReader reader(retry.data(), retry.size());
+    uint8_t type_byte;
+    uint32_t version_label;
+    ::quic::QuicConnectionId client_connection_id;
+    EXPECT_TRUE(reader.ReadUInt8(&type_byte));
+    EXPECT_EQ(type_byte & 0xf0, 0xf0);
+    EXPECT_TRUE(reader.ReadUInt32(&version_label));
+    EXPECT_EQ(version_label, ::quic::CreateQuicVersionLabel(
+                                 ::quic::ParsedQuicVersion::RFCv1()));
+    EXPECT_TRUE(reader.ReadLengthPrefixedConnectionId(&client_connection_id));
+    EXPECT_EQ(client_connection_id, ::quic::test::TestConnectionId(2));
+    EXPECT_TRUE(reader.ReadLengthPrefixedConnectionId(server_connection_id));
+    absl::string_view rest = reader.ReadRemainingPayload();
+    // The last 16 bytes are the integrity tag.
+    EXPECT_GT(rest.size(), 16u);
+    return std::string(rest.substr(0, rest.size() - 16));
+  }
+
+  ::quic::MockClock clock_;
+  HandshakeAdmission admission_;
+  ::quic::QuicSocketAddress peer_address_;
+};
+
+TEST_F(HandshakeAdmissionTest, UnlimitedByDefault) {
+  for (uint64_t i = 0; i < 50; i++) {
+    EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(i),
+                                         peer_address_, ""),
+              HandshakeAdmission::Decision::kAccept);
+  }
+  EXPECT_EQ(admission_.handshakes_deferred(), 0u);
+  EXPECT_EQ(admission_.handshakes_rejected(), 0u);
+}
+
+TEST_F(HandshakeAdmissionTest, RetriesOverRateLimit) {
+  admission_.SetLimits(2, 0);
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(1),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kAccept);
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(2),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kAccept);
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(3),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kRetry);
+  EXPECT_EQ(admission_.handshakes_deferred(), 1u);
+  // More packets of an accepted handshake don't take tokens.
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(1),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kAccept);
+  // Half a second refills one token.
+  clock_.AdvanceTime(::quic::QuicTime::Delta::FromMilliseconds(500));
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(3),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kAccept);
+}
+
+TEST_F(HandshakeAdmissionTest, AcceptsValidRetryToken) {
+  admission_.SetLimits(1, 0);
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(1),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kAccept);
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(3),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kRetry);
+  const std::string retry = admission_.BuildRetryPacket(
+      ::quic::ParsedQuicVersion::RFCv1(), ::quic::test::TestConnectionId(3),
+      ::quic::test::TestConnectionId(2), peer_address_);
+  ::quic::QuicConnectionId server_connection_id;
+  const std::string token = ParseRetryPacket(retry, &server_connection_id);
+  EXPECT_NE(server_connection_id, ::quic::test::TestConnectionId(3));
+  // Bucket is still empty, but the client's address is validated.
+  EXPECT_EQ(
+      admission_.OnInitialPacket(server_connection_id, peer_address_, token),
+      HandshakeAdmission::Decision::kAccept);
+  absl::optional<::quic::QuicConnectionId> original_connection_id =
+      admission_.OnSessionCreated(server_connection_id);
+  ASSERT_TRUE(original_connection_id.has_value());
+  EXPECT_EQ(*original_connection_id, ::quic::test::TestConnectionId(3));
+  EXPECT_FALSE(
+      admission_.OnSessionCreated(::quic::test::TestConnectionId(1))
+          .has_value());
+}
+
+TEST_F(HandshakeAdmissionTest, RejectsRetryTokenForOtherAddress) {
+  admission_.SetLimits(1, 0);
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(1),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kAccept);
+  const std::string retry = admission_.BuildRetryPacket(
+      ::quic::ParsedQuicVersion::RFCv1(), ::quic::test::TestConnectionId(3),
+      ::quic::test::TestConnectionId(2), peer_address_);
+  ::quic::QuicConnectionId server_connection_id;
+  const std::string token = ParseRetryPacket(retry, &server_connection_id);
+  ::quic::QuicIpAddress other_host;
+  ASSERT_TRUE(other_host.FromString("192.0.2.1"));
+  EXPECT_EQ(admission_.OnInitialPacket(
+                server_connection_id,
+                ::quic::QuicSocketAddress(other_host, 4433), token),
+            HandshakeAdmission::Decision::kRetry);
+  // Tokens expire.
+  clock_.AdvanceTime(::quic::QuicTime::Delta::FromSeconds(20));
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(4),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kAccept);
+  EXPECT_EQ(
+      admission_.OnInitialPacket(server_connection_id, peer_address_, token),
+      HandshakeAdmission::Decision::kRetry);
+}
+
+TEST_F(HandshakeAdmissionTest, CapsPendingHandshakes) {
+  admission_.SetLimits(0, 2);
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(1),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kAccept);
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(2),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kAccept);
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(3),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kReject);
+  EXPECT_EQ(admission_.handshakes_rejected(), 1u);
+  admission_.OnSessionCreated(::quic::test::TestConnectionId(1));
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(3),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kAccept);
+  // Handshakes never getting a session expire.
+  clock_.AdvanceTime(::quic::QuicTime::Delta::FromSeconds(10));
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(4),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kAccept);
+}
+
+TEST_F(HandshakeAdmissionTest, ExpiresPendingHandshakesBelowCap) {
+  admission_.SetLimits(1, 0);
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(1),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kAccept);
+  // The session is created with another connection ID, so the handshake is
+  // still pending until it expires.
+  clock_.AdvanceTime(::quic::QuicTime::Delta::FromSeconds(10));
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(1),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kAccept);
+  // The expired handshake was admitted again with the only token.
+  EXPECT_EQ(admission_.OnInitialPacket(::quic::test::TestConnectionId(2),
+                                       peer_address_, ""),
+            HandshakeAdmission::Decision::kRetry);
+}
+
+}  // namespace test
+}  // namespace quic
+}  // namespace owt
@@ -39,15 +39,56 @@ Http3ServerSession::Http3ServerSession(
                             compressed_certs_cache),
       backend_(backend),
       io_runner_(io_runner),
-      event_runner_(event_runner) {
+      event_runner_(event_runner),
+      congestion_observer_(nullptr),
+      handshake_observer_(nullptr),
+      zero_rtt_enabled_(true) {
   CHECK(io_runner_);
   CHECK(event_runner_);
 }
 
 Http3ServerSession::~Http3ServerSession() {
+  if (congestion_observer_) {
+    congestion_observer_->OnHttp3SessionDestroyed();
+    congestion_observer_ = nullptr;
+  }
   DeleteConnection();
 }
 
+void Http3ServerSession::SetCongestionObserver(CongestionObserver* observer) {
+  congestion_observer_ = observer;
+}
+
+void Http3ServerSession::SetHandshakeObserver(HandshakeObserver* observer) {
+  handshake_observer_ = observer;
+}
+
+void Http3ServerSession::SetZeroRttEnabled(bool enabled) {
+  zero_rtt_enabled_ = enabled;
+}
+
+void Http3ServerSession::OnCongestionWindowChange(::quic::QuicTime now) {
+  ::quic::QuicServerSessionBase::OnCongestionWindowChange(now);
+  if (congestion_observer_) {
+    congestion_observer_->OnCongestionWindowChange(now);
+  }
+}
+
+void Http3ServerSession::OnTlsHandshakeComplete() {
+  ::quic::QuicServerSessionBase::OnTlsHandshakeComplete();
+  if (handshake_observer_) {
+    handshake_observer_->OnHandshakeComplete(GetCryptoStream()->IsResumption(),
+                                             GetCryptoStream()->IsZeroRtt());
+  }
+}
+
+::quic::QuicSSLConfig Http3ServerSession::GetSSLConfig() const {
+  ::quic::QuicSSLConfig ssl_config =
+      ::quic::QuicServerSessionBase::GetSSLConfig();
+  ssl_config.early_data_enabled = zero_rtt_enabled_;
+  return ssl_config;
+}
+
 ::quic::QuicSpdyStream* Http3ServerSession::CreateIncomingStream(
     ::quic::QuicStreamId id) {
   if (!ShouldCreateIncomingStream(id)) {
@@ -17,6 +17,28 @@ class WebTransportServerBackend;
 
 class Http3ServerSession : public ::quic::QuicServerSessionBase {
  public:
+  // Observes congestion controller of this session's connection. Methods are
+  // called on IO thread.
+  class CongestionObserver {
+   public:
+    virtual ~CongestionObserver() = default;
+    // Called when the congestion window may have changed, usually after an ACK
+    // frame is processed.
+    virtual void OnCongestionWindowChange(::quic::QuicTime now) = 0;
+    // Called when the observed session is being destroyed. The session must not
+    // be accessed afterwards.
+    virtual void OnHttp3SessionDestroyed() = 0;
+  };
+
+  // Observes TLS handshake of this session. Methods are called on IO thread.
+  class HandshakeObserver {
+   public:
+    virtual ~HandshakeObserver() = default;
+    // Called when the handshake is complete. `resumed` is true if a session
+    // ticket is accepted, and `zero_rtt` is true if early data is accepted.
+    virtual void OnHandshakeComplete(bool resumed, bool zero_rtt) = 0;
+  };
+
   explicit Http3ServerSession(
       const ::quic::QuicConfig& config,
       const ::quic::ParsedQuicVersionVector& supported_versions,
@@ -31,6 +53,22 @@ class Http3ServerSession : public ::quic::QuicServerSessionBase {
   ~Http3ServerSession() override;
   Http3ServerSession& operator=(Http3ServerSession&) = delete;
 
+  // `observer` must outlive this session or be reset to nullptr.
+  void SetCongestionObserver(CongestionObserver* observer);
+  CongestionObserver* congestion_observer() const {
+    return congestion_observer_;
+  }
+  // `observer` must outlive this session.
+  void SetHandshakeObserver(HandshakeObserver* observer);
+  // Whether 0-RTT data from resumed clients is accepted. Must be called before
+  // Initialize. Default is true.
+  void SetZeroRttEnabled(bool enabled);
+
+  // Overrides ::quic::QuicServerSessionBase.
+  void OnCongestionWindowChange(::quic::QuicTime now) override;
+  void OnTlsHandshakeComplete() override;
+  ::quic::QuicSSLConfig GetSSLConfig() const override;
+
  protected:
   // Override ::quic::QuicServerSessionBase.
   ::quic::QuicSpdyStream* CreateIncomingStream(
@@ -52,6 +90,9 @@ class Http3ServerSession : public ::quic::QuicServerSessionBase {
   WebTransportServerBackend* backend_;
   base::SingleThreadTaskRunner* io_runner_;
   base::SingleThreadTaskRunner* event_runner_;
+  CongestionObserver* congestion_observer_;
+  HandshakeObserver* handshake_observer_;
+  bool zero_rtt_enabled_;
 };
 
 }  // namespace quic
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/received_datagram_impl.h"
+#include <cstring>
+#include <new>
+#include "base/check_op.h"
+
+namespace owt {
+namespace quic {
+
+ReceivedDatagramImpl* ReceivedDatagramImpl::Create(
+    absl::string_view data,
+    ::quic::QuicTime arrival_time) {
+  // Payload follows the object.
+  void* memory = ::operator new(sizeof(ReceivedDatagramImpl) + data.size());
+  auto* datagram = new (memory) ReceivedDatagramImpl(
+      data.size(), (arrival_time - ::quic::QuicTime::Zero()).ToMicroseconds());
+  if (!data.empty()) {
+    memcpy(datagram + 1, data.data(), data.size());
+  }
+  return datagram;
+}
+
+ReceivedDatagramImpl::ReceivedDatagramImpl(size_t length,
+                                           int64_t arrival_time_us)
+    : length_(length), arrival_time_us_(arrival_time_us), ref_count_(1) {}
+
+ReceivedDatagramImpl::~ReceivedDatagramImpl() = default;
+
+const uint8_t* ReceivedDatagramImpl::Data() const {
+  return reinterpret_cast<const uint8_t*>(this + 1);
+}
+
+size_t ReceivedDatagramImpl::Length() const {
+  return length_;
+}
+
+int64_t ReceivedDatagramImpl::ArrivalTimeUs() const {
+  return arrival_time_us_;
+}
+
+void ReceivedDatagramImpl::AddRef() const {
+  ref_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ReceivedDatagramImpl::Release() const {
+  int previous = ref_count_.fetch_sub(1, std::memory_order_acq_rel);
+  DCHECK_GT(previous, 0);
+  if (previous == 1) {
+    this->~ReceivedDatagramImpl();
+    ::operator delete(const_cast<ReceivedDatagramImpl*>(this));
+  }
+}
+
+}  // namespace quic
+}  // namespace owt
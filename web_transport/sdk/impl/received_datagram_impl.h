@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_QUIC_WEB_TRANSPORT_RECEIVED_DATAGRAM_IMPL_H_
+#define OWT_QUIC_WEB_TRANSPORT_RECEIVED_DATAGRAM_IMPL_H_
+
+#include <atomic>
+#include "net/third_party/quiche/src/quic/core/quic_time.h"
+#include "owt/quic/web_transport_definitions.h"
+#include "third_party/abseil-cpp/absl/strings/string_view.h"
+
+namespace owt {
+namespace quic {
+
+// A datagram copied out of QUIC stack when it arrives. Data and metadata are
+// stored in a single allocation.
+class ReceivedDatagramImpl : public ReceivedDatagram {
+ public:
+  // Creates a datagram with a reference count of 1. The caller owns this
+  // reference.
+  static ReceivedDatagramImpl* Create(absl::string_view data,
+                                      ::quic::QuicTime arrival_time);
+
+  ReceivedDatagramImpl(const ReceivedDatagramImpl&) = delete;
+  ReceivedDatagramImpl& operator=(const ReceivedDatagramImpl&) = delete;
+
+  // Overrides ReceivedDatagram.
+  const uint8_t* Data() const override;
+  size_t Length() const override;
+  int64_t ArrivalTimeUs() const override;
+  void AddRef() const override;
+  void Release() const override;
+
+ private:
+  ReceivedDatagramImpl(size_t length, int64_t arrival_time_us);
+  ~ReceivedDatagramImpl() override;
+
+  const size_t length_;
+  const int64_t arrival_time_us_;
+  mutable std::atomic<int> ref_count_;
+};
+
+}  // namespace quic
+}  // namespace owt
+
+#endif
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/received_datagram_impl.h"
+#include <string>
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace owt {
+namespace quic {
+namespace test {
+
+TEST(ReceivedDatagramImplTest, CopiesDataAndArrivalTime) {
+  std::string payload("datagram");
+  ReceivedDatagram* datagram = ReceivedDatagramImpl::Create(
+      payload, ::quic::QuicTime::Zero() +
+                   ::quic::QuicTime::Delta::FromMicroseconds(1234));
+  payload[0] = 'D';
+  EXPECT_EQ(8u, datagram->Length());
+  EXPECT_EQ("datagram",
+            std::string(reinterpret_cast<const char*>(datagram->Data()),
+                        datagram->Length()));
+  EXPECT_EQ(1234, datagram->ArrivalTimeUs());
+  datagram->Release();
+}
+
+TEST(ReceivedDatagramImplTest, OutlivesCreatorReference) {
+  ReceivedDatagram* datagram =
+      ReceivedDatagramImpl::Create("abc", ::quic::QuicTime::Zero());
+  datagram->AddRef();
+  datagram->Release();
+  EXPECT_EQ(3u, datagram->Length());
+  EXPECT_EQ('a', datagram->Data()[0]);
+  datagram->Release();
+}
+
+TEST(ReceivedDatagramImplTest, EmptyDatagram) {
+  ReceivedDatagram* datagram =
+      ReceivedDatagramImpl::Create("", ::quic::QuicTime::Zero());
+  EXPECT_EQ(0u, datagram->Length());
+  datagram->Release();
+}
+
+}  // namespace test
+}  // namespace quic
+}  // namespace owt
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/session_ticket_crypter.h"
+#include <cstring>
+#include <utility>
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/task/thread_pool.h"
+#include "crypto/random.h"
+#include "crypto/sha2.h"
+
+namespace owt {
+namespace quic {
+
+namespace {
+constexpr size_t kKeySize = 16;
+constexpr size_t kKeyNameSize = 4;
+constexpr size_t kNonceSize = 12;
+constexpr size_t kTagSize = 16;
+// Random keys generated by this process, including the encryption key.
+constexpr size_t kMaxRandomKeys = 3;
+constexpr base::TimeDelta kKeyFileCheckInterval = base::Minutes(1);
+
+std::string NewRandomKey() {
+  std::string key(kKeySize, '\0');
+  crypto::RandBytes(&key[0], key.size());
+  return key;
+}
+}  // namespace
+
+const size_t SessionTicketKeys::kOverhead =
+    kKeyNameSize + kNonceSize + kTagSize;
+
+// static
+scoped_refptr<SessionTicketKeys> SessionTicketKeys::CreateRandom(
+    base::TimeDelta rotation_interval) {
+  DCHECK(rotation_interval.is_positive());
+  scoped_refptr<SessionTicketKeys> keys =
+      base::WrapRefCounted(new SessionTicketKeys(rotation_interval,
+                                                 base::FilePath()));
+  base::AutoLock lock(keys->lock_);
+  keys->keys_ = NewKeys({NewRandomKey()});
+  keys->last_rotation_time_ = base::TimeTicks::Now();
+  return keys;
+}
+
+// static
+scoped_refptr<SessionTicketKeys> SessionTicketKeys::CreateFromFile(
+    const base::FilePath& path) {
+  std::vector<std::string> raw_keys;
+  base::Time modified_time;
+  if (!ReadKeyFile(path, &raw_keys, &modified_time)) {
+    return nullptr;
+  }
+  scoped_refptr<SessionTicketKeys> keys =
+      base::WrapRefCounted(new SessionTicketKeys(base::TimeDelta(), path));
+  {
+    base::AutoLock lock(keys->lock_);
+    keys->keys_ = NewKeys(raw_keys);
+  }
+  keys->file_modified_time_ = modified_time;
+  keys->reload_runner_ = base::ThreadPool::CreateSequencedTaskRunner(
+      {base::MayBlock(), base::TaskPriority::BEST_EFFORT,
+       base::TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN});
+  keys->ScheduleKeyFileReload();
+  return keys;
+}
+
+// static
+bool SessionTicketKeys::ParseKeys(absl::string_view content,
+                                  std::vector<std::string>* keys) {
+  DCHECK(keys);
+  keys->clear();
+  for (base::StringPiece line : base::SplitStringPiece(
+           base::StringPiece(content.data(), content.size()), "\n",
+           base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    if (base::StartsWith(line, "#")) {
+      continue;
+    }
+    std::string key;
+    if (!base::HexStringToString(line, &key) || key.size() != kKeySize) {
+      return false;
+    }
+    keys->push_back(std::move(key));
+  }
+  return !keys->empty();
+}
+
+SessionTicketKeys::SessionTicketKeys(base::TimeDelta rotation_interval,
+                                     const base::FilePath& path)
+    : rotation_interval_(rotation_interval), path_(path) {}
+
+SessionTicketKeys::~SessionTicketKeys() = default;
+
+std::vector<uint8_t> SessionTicketKeys::Encrypt(absl::string_view plaintext) {
+  base::AutoLock lock(lock_);
+  MaybeRotateKeysLocked();
+  const Key& key = *keys_.front();
+  std::vector<uint8_t> ticket(kOverhead + plaintext.size());
+  memcpy(ticket.data(), key.name.data(), kKeyNameSize);
+  uint8_t* nonce = ticket.data() + kKeyNameSize;
+  crypto::RandBytes(nonce, kNonceSize);
+  size_t sealed_size = 0;
+  if (!EVP_AEAD_CTX_seal(
+          key.aead.get(), nonce + kNonceSize, &sealed_size,
+          plaintext.size() + kTagSize, nonce, kNonceSize,
+          reinterpret_cast<const uint8_t*>(plaintext.data()), plaintext.size(),
+          nullptr, 0)) {
+    return std::vector<uint8_t>();
+  }
+  ticket.resize(kKeyNameSize + kNonceSize + sealed_size);
+  return ticket;
+}
+
+std::vector<uint8_t> SessionTicketKeys::Decrypt(absl::string_view ticket) {
+  if (ticket.size() < kOverhead) {
+    return std::vector<uint8_t>();
+  }
+  base::AutoLock lock(lock_);
+  MaybeRotateKeysLocked();
+  absl::string_view name = ticket.substr(0, kKeyNameSize);
+  for (const auto& key : keys_) {
+    if (key->name != name) {
+      continue;
+    }
+    const uint8_t* nonce =
+        reinterpret_cast<const uint8_t*>(ticket.data()) + kKeyNameSize;
+    const size_t sealed_size = ticket.size() - kKeyNameSize - kNonceSize;
+    std::vector<uint8_t> plaintext(sealed_size);
+    size_t plaintext_size = 0;
+    if (!EVP_AEAD_CTX_open(key->aead.get(), plaintext.data(), &plaintext_size,
+                           plaintext.size(), nonce, kNonceSize,
+                           nonce + kNonceSize, sealed_size, nullptr, 0)) {
+      return std::vector<uint8_t>();
+    }
+    plaintext.resize(plaintext_size);
+    return plaintext;
+  }
+  return std::vector<uint8_t>();
+}
+
+// static
+std::unique_ptr<SessionTicketKeys::Key> SessionTicketKeys::NewKey(
+    const std::string& raw_key) {
+  DCHECK_EQ(raw_key.size(), kKeySize);
+  auto key = std::make_unique<Key>();
+  key->name = crypto::SHA256HashString(raw_key).substr(0, kKeyNameSize);
+  CHECK(EVP_AEAD_CTX_init(key->aead.get(), EVP_aead_aes_128_gcm(),
+                          reinterpret_cast<const uint8_t*>(raw_key.data()),
+                          raw_key.size(), kTagSize, nullptr));
+  return key;
+}
+
+// static
+std::vector<std::unique_ptr<SessionTicketKeys::Key>>
+SessionTicketKeys::NewKeys(const std::vector<std::string>& raw_keys) {
+  std::vector<std::unique_ptr<Key>> keys;
+  for (const std::string& raw_key : raw_keys) {
+    keys.push_back(NewKey(raw_key));
+  }
+  return keys;
+}
+
+// static
+bool SessionTicketKeys::ReadKeyFile(const base::FilePath& path,
+                                    std::vector<std::string>* raw_keys,
+                                    base::Time* modified_time) {
+  base::File::Info info;
+  if (!base::GetFileInfo(path, &info)) {
+    LOG(ERROR) << "Failed to get info of session ticket key file "
+               << path.value();
+    return false;
+  }
+  std::string content;
+  if (!base::ReadFileToString(path, &content) ||
+      !ParseKeys(content, raw_keys)) {
+    LOG(ERROR) << "Invalid session ticket key file " << path.value();
+    return false;
+  }
+  *modified_time = info.last_modified;
+  return true;
+}
+
+void SessionTicketKeys::MaybeRotateKeysLocked() {
+  if (!path_.empty()) {
+    return;
+  }
+  const base::TimeTicks now = base::TimeTicks::Now();
+  if (now - last_rotation_time_ < rotation_interval_) {
+    return;
+  }
+  keys_.insert(keys_.begin(), NewKey(NewRandomKey()));
+  if (keys_.size() > kMaxRandomKeys) {
+    keys_.resize(kMaxRandomKeys);
+  }
+  last_rotation_time_ = now;
+}
+
+void SessionTicketKeys::ScheduleKeyFileReload() {
+  reload_runner_->PostDelayedTask(
+      FROM_HERE,
+      base::BindOnce(&SessionTicketKeys::ReloadKeyFile,
+                     base::WrapRefCounted(this)),
+      kKeyFileCheckInterval);
+}
+
+void SessionTicketKeys::ReloadKeyFile() {
+  DCHECK(reload_runner_->RunsTasksInCurrentSequence());
+  if (HasOneRef()) {
+    // Only this task keeps the keys, so they are no longer used.
+    return;
+  }
+  base::File::Info info;
+  if (!base::GetFileInfo(path_, &info)) {
+    LOG(ERROR) << "Failed to get info of session ticket key file "
+               << path_.value();
+  } else if (info.last_modified != file_modified_time_) {
+    std::vector<std::string> raw_keys;
+    base::Time modified_time;
+    // Existing keys are kept if the file becomes invalid.
+    if (ReadKeyFile(path_, &raw_keys, &modified_time)) {
+      std::vector<std::unique_ptr<Key>> keys = NewKeys(raw_keys);
+      {
+        base::AutoLock lock(lock_);
+        keys_.swap(keys);
+      }
+      file_modified_time_ = modified_time;
+    }
+  }
+  ScheduleKeyFileReload();
+}
+
+SessionTicketCrypter::SessionTicketCrypter(
+    scoped_refptr<SessionTicketKeys> keys)
+    : keys_(std::move(keys)) {
+  CHECK(keys_);
+}
+
+SessionTicketCrypter::~SessionTicketCrypter() = default;
+
+size_t SessionTicketCrypter::MaxOverhead() {
+  return SessionTicketKeys::kOverhead;
+}
+
+std::vector<uint8_t> SessionTicketCrypter::Encrypt(
+    absl::string_view in,
+    absl::string_view /*encryption_key*/) {
+  return keys_->Encrypt(in);
+}
+
+void SessionTicketCrypter::Decrypt(
+    absl::string_view in,
+    std::shared_ptr<::quic::ProofSource::DecryptCallback> callback) {
+  callback->Run(keys_->Decrypt(in));
+}
+
+}  // namespace quic
+}  // namespace owt
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_QUIC_WEB_TRANSPORT_SESSION_TICKET_CRYPTER_H_
+#define OWT_QUIC_WEB_TRANSPORT_SESSION_TICKET_CRYPTER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/time/time.h"
+#include "net/third_party/quiche/src/quic/core/crypto/proof_source.h"
+#include "third_party/abseil-cpp/absl/strings/string_view.h"
+#include "third_party/boringssl/src/include/openssl/aead.h"
+
+namespace owt {
+namespace quic {
+
+// AES-128-GCM keys protecting TLS session tickets. The first key encrypts new
+// tickets, and all keys decrypt. A ticket starts with the name of its key, so
+// tickets encrypted by an old key are accepted until the key is removed.
+// Thread safe, so shards of a server share the same keys.
+class SessionTicketKeys : public base::RefCountedThreadSafe<SessionTicketKeys> {
+ public:
+  // Bytes added to a ticket's plaintext.
+  static const size_t kOverhead;
+
+  // Creates random keys known only to this process. A new key is generated
+  // every `rotation_interval`. The previous two keys still decrypt.
+  static scoped_refptr<SessionTicketKeys> CreateRandom(
+      base::TimeDelta rotation_interval);
+  // Creates keys read from `path`, so servers in different processes or on
+  // different machines can resume each other's sessions. Each line of the
+  // file is a key of 32 hex digits, and the first one encrypts. Empty lines
+  // and lines starting with '#' are ignored. The file is checked every minute
+  // on a thread pool and read again when it's modified, so keys are rotated by
+  // prepending a new key and removing old ones. Returns nullptr if the file
+  // has no valid key.
+  static scoped_refptr<SessionTicketKeys> CreateFromFile(
+      const base::FilePath& path);
+
+  SessionTicketKeys(const SessionTicketKeys&) = delete;
+  SessionTicketKeys& operator=(const SessionTicketKeys&) = delete;
+
+  // Returns an empty vector on failure.
+  std::vector<uint8_t> Encrypt(absl::string_view plaintext);
+  // Returns an empty vector if `ticket` is not encrypted by any key.
+  std::vector<uint8_t> Decrypt(absl::string_view ticket);
+
+  // Parses keys in the format of a key file. Returns false if there is no key
+  // or a line is malformed.
+  static bool ParseKeys(absl::string_view content,
+                        std::vector<std::string>* keys);
+
+ private:
+  friend class base::RefCountedThreadSafe<SessionTicketKeys>;
+
+  struct Key {
+    // First bytes of the key's SHA-256 hash.
+    std::string name;
+    bssl::ScopedEVP_AEAD_CTX aead;
+  };
+
+  SessionTicketKeys(base::TimeDelta rotation_interval,
+                    const base::FilePath& path);
+  ~SessionTicketKeys();
+
+  // `raw_key` is 16 bytes.
+  static std::unique_ptr<Key> NewKey(const std::string& raw_key);
+  // `raw_keys` are 16 bytes each.
+  static std::vector<std::unique_ptr<Key>> NewKeys(
+      const std::vector<std::string>& raw_keys);
+  // Returns false if the key file can't be read or has no valid key.
+  static bool ReadKeyFile(const base::FilePath& path,
+                          std::vector<std::string>* raw_keys,
+                          base::Time* modified_time);
+  // Rotates random keys.
+  void MaybeRotateKeysLocked() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Posts ReloadKeyFile to `reload_runner_` after the check interval.
+  void ScheduleKeyFileReload();
+  // Reads the key file again if it's modified. Runs on `reload_runner_`.
+  void ReloadKeyFile();
+
+  const base::TimeDelta rotation_interval_;
+  const base::FilePath path_;
+  base::Lock lock_;
+  std::vector<std::unique_ptr<Key>> keys_ GUARDED_BY(lock_);
+  // For random keys.
+  base::TimeTicks last_rotation_time_ GUARDED_BY(lock_);
+  // For key files. File IO may block, so it's done on a thread pool sequence
+  // instead of threads encrypting and decrypting tickets.
+  scoped_refptr<base::SequencedTaskRunner> reload_runner_;
+  // Only accessed on `reload_runner_` after creation.
+  base::Time file_modified_time_;
+};
+
+// Encrypts and decrypts session tickets with shared SessionTicketKeys. Set to
+// a proof source to enable session resumption and 0-RTT.
+class SessionTicketCrypter : public ::quic::ProofSource::TicketCrypter {
+ public:
+  explicit SessionTicketCrypter(scoped_refptr<SessionTicketKeys> keys);
+  ~SessionTicketCrypter() override;
+  SessionTicketCrypter(const SessionTicketCrypter&) = delete;
+  SessionTicketCrypter& operator=(const SessionTicketCrypter&) = delete;
+
+  // Overrides ::quic::ProofSource::TicketCrypter.
+  size_t MaxOverhead() override;
+  std::vector<uint8_t> Encrypt(absl::string_view in,
+                               absl::string_view encryption_key) override;
+  void Decrypt(
+      absl::string_view in,
+      std::shared_ptr<::quic::ProofSource::DecryptCallback> callback) override;
+
+ private:
+  scoped_refptr<SessionTicketKeys> keys_;
+};
+
+}  // namespace quic
+}  // namespace owt
+
+#endif
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/session_ticket_crypter.h"
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/test/task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace owt {
+namespace quic {
+namespace test {
+
+namespace {
+const char kKey1[] = "000102030405060708090a0b0c0d0e0f";
+const char kKey2[] = "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+std::string ToString(const std::vector<uint8_t>& data) {
+  return std::string(data.begin(), data.end());
+}
+
+class RecordingDecryptCallback : public ::quic::ProofSource::DecryptCallback {
+ public:
+  explicit RecordingDecryptCallback(std::vector<uint8_t>* plaintext)
+      : plaintext_(plaintext) {}
+  void Run(std::vector<uint8_t> plaintext) override {
+    *plaintext_ = std::move(plaintext);
+  }
+
+ private:
+  std::vector<uint8_t>* plaintext_;
+};
+}  // namespace
+
+class SessionTicketCrypterTest : public testing::Test {
+ public:
+  SessionTicketCrypterTest()
+      : task_environment_(base::test::TaskEnvironment::TimeSource::MOCK_TIME) {}
+
+ protected:
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+  scoped_refptr<SessionTicketKeys> KeysFromFile(const std::string& content) {
+    base::FilePath path = temp_dir_.GetPath().AppendASCII("ticket_keys");
+    EXPECT_TRUE(base::WriteFile(path, content));
+    return SessionTicketKeys::CreateFromFile(path);
+  }
+
+  // Key files are reloaded on a thread pool.
+  base::test::TaskEnvironment task_environment_;
+  base::ScopedTempDir temp_dir_;
+};
+
+TEST_F(SessionTicketCrypterTest, EncryptAndDecrypt) {
+  SessionTicketCrypter crypter(SessionTicketKeys::CreateRandom(base::Hours(1)));
+  std::vector<uint8_t> ticket = crypter.Encrypt("session state", "");
+  ASSERT_EQ(ticket.size(), strlen("session state") + crypter.MaxOverhead());
+  EXPECT_EQ(ToString(ticket).find("session state"), std::string::npos);
+  std::vector<uint8_t> plaintext;
+  crypter.Decrypt(ToString(ticket),
+                  std::make_shared<RecordingDecryptCallback>(&plaintext));
+  EXPECT_EQ(ToString(plaintext), "session state");
+  // Modified tickets are rejected.
+  ticket.back() ^= 1;
+  crypter.Decrypt(ToString(ticket),
+                  std::make_shared<RecordingDecryptCallback>(&plaintext));
+  EXPECT_TRUE(plaintext.empty());
+}
+
+TEST_F(SessionTicketCrypterTest, RandomKeysAreNotShared) {
+  scoped_refptr<SessionTicketKeys> keys1 =
+      SessionTicketKeys::CreateRandom(base::Hours(1));
+  scoped_refptr<SessionTicketKeys> keys2 =
+      SessionTicketKeys::CreateRandom(base::Hours(1));
+  std::vector<uint8_t> ticket = keys1->Encrypt("session state");
+  EXPECT_FALSE(keys1->Decrypt(ToString(ticket)).empty());
+  EXPECT_TRUE(keys2->Decrypt(ToString(ticket)).empty());
+}
+
+TEST_F(SessionTicketCrypterTest, KeyFileSharedByServers) {
+  scoped_refptr<SessionTicketKeys> old_keys =
+      KeysFromFile(std::string("# Ticket keys\n") + kKey1 + "\n");
+  ASSERT_TRUE(old_keys);
+  std::vector<uint8_t> old_ticket = old_keys->Encrypt("old state");
+  // A server with rotated keys still accepts tickets of the old key.
+  scoped_refptr<SessionTicketKeys> new_keys =
+      KeysFromFile(std::string(kKey2) + "\n\n" + kKey1 + "\n");
+  ASSERT_TRUE(new_keys);
+  EXPECT_EQ(ToString(new_keys->Decrypt(ToString(old_ticket))), "old state");
+  std::vector<uint8_t> new_ticket = new_keys->Encrypt("new state");
+  EXPECT_TRUE(old_keys->Decrypt(ToString(new_ticket)).empty());
+}
+
+TEST_F(SessionTicketCrypterTest, ReloadsModifiedKeyFile) {
+  base::FilePath path = temp_dir_.GetPath().AppendASCII("rotated_keys");
+  ASSERT_TRUE(base::WriteFile(path, std::string(kKey1) + "\n"));
+  scoped_refptr<SessionTicketKeys> keys =
+      SessionTicketKeys::CreateFromFile(path);
+  ASSERT_TRUE(keys);
+  std::vector<uint8_t> old_ticket = keys->Encrypt("old state");
+  // Rotates keys by prepending a new one.
+  ASSERT_TRUE(
+      base::WriteFile(path, std::string(kKey2) + "\n" + kKey1 + "\n"));
+  const base::Time modified_time = base::Time::Now() + base::Minutes(5);
+  ASSERT_TRUE(base::TouchFile(path, modified_time, modified_time));
+  scoped_refptr<SessionTicketKeys> new_keys =
+      KeysFromFile(std::string(kKey2) + "\n");
+  ASSERT_TRUE(new_keys);
+  EXPECT_TRUE(new_keys->Decrypt(ToString(keys->Encrypt("state"))).empty());
+  task_environment_.FastForwardBy(base::Minutes(1));
+  EXPECT_EQ(ToString(new_keys->Decrypt(ToString(keys->Encrypt("new state")))),
+            "new state");
+  EXPECT_EQ(ToString(keys->Decrypt(ToString(old_ticket))), "old state");
+  // Existing keys are kept if the file becomes invalid.
+  ASSERT_TRUE(base::WriteFile(path, "not a key\n"));
+  const base::Time invalid_time = modified_time + base::Minutes(5);
+  ASSERT_TRUE(base::TouchFile(path, invalid_time, invalid_time));
+  task_environment_.FastForwardBy(base::Minutes(1));
+  EXPECT_EQ(ToString(keys->Decrypt(ToString(old_ticket))), "old state");
+}
+
+TEST_F(SessionTicketCrypterTest, RejectsInvalidKeyFile) {
+  EXPECT_FALSE(KeysFromFile(""));
+  EXPECT_FALSE(KeysFromFile("# No keys\n"));
+  EXPECT_FALSE(KeysFromFile("0001020304\n"));
+  EXPECT_FALSE(KeysFromFile(std::string(kKey1) + "\nnot a key\n"));
+  EXPECT_FALSE(SessionTicketKeys::CreateFromFile(
+      temp_dir_.GetPath().AppendASCII("missing")));
+}
+
+}  // namespace test
+}  // namespace quic
+}  // namespace owt
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/shared_session_cache.h"
+#include <utility>
+
+namespace owt {
+namespace quic {
+
+// Owned by a client's crypto config. Keeps the shared cache alive after the
+// factory is destroyed.
+class SharedSessionCache::ClientCache : public ::quic::SessionCache {
+ public:
+  explicit ClientCache(scoped_refptr<SharedSessionCache> cache)
+      : cache_(std::move(cache)) {}
+  ~ClientCache() override = default;
+
+  void Insert(const ::quic::QuicServerId& server_id,
+              bssl::UniquePtr<SSL_SESSION> session,
+              const ::quic::TransportParameters& params,
+              const ::quic::ApplicationState* application_state) override {
+    cache_->Insert(server_id, std::move(session), params, application_state);
+  }
+
+  std::unique_ptr<::quic::QuicResumptionState> Lookup(
+      const ::quic::QuicServerId& server_id,
+      ::quic::QuicWallTime now,
+      const SSL_CTX* ctx) override {
+    return cache_->Lookup(server_id, now, ctx);
+  }
+
+  void ClearEarlyData(const ::quic::QuicServerId& server_id) override {
+    cache_->ClearEarlyData(server_id);
+  }
+
+  void OnNewTokenReceived(const ::quic::QuicServerId& server_id,
+                          absl::string_view token) override {
+    cache_->OnNewTokenReceived(server_id, token);
+  }
+
+  void RemoveExpiredEntries(::quic::QuicWallTime now) override {
+    cache_->RemoveExpiredEntries(now);
+  }
+
+  void Clear() override { cache_->Clear(); }
+
+ private:
+  scoped_refptr<SharedSessionCache> cache_;
+};
+
+SharedSessionCache::SharedSessionCache() = default;
+
+SharedSessionCache::~SharedSessionCache() = default;
+
+std::unique_ptr<::quic::SessionCache> SharedSessionCache::CreateClientCache() {
+  return std::make_unique<ClientCache>(base::WrapRefCounted(this));
+}
+
+void SharedSessionCache::Insert(
+    const ::quic::QuicServerId& server_id,
+    bssl::UniquePtr<SSL_SESSION> session,
+    const ::quic::TransportParameters& params,
+    const ::quic::ApplicationState* application_state) {
+  base::AutoLock lock(lock_);
+  cache_.Insert(server_id, std::move(session), params, application_state);
+}
+
+std::unique_ptr<::quic::QuicResumptionState> SharedSessionCache::Lookup(
+    const ::quic::QuicServerId& server_id,
+    ::quic::QuicWallTime now,
+    const SSL_CTX* ctx) {
+  base::AutoLock lock(lock_);
+  return cache_.Lookup(server_id, now, ctx);
+}
+
+void SharedSessionCache::ClearEarlyData(
+    const ::quic::QuicServerId& server_id) {
+  base::AutoLock lock(lock_);
+  cache_.ClearEarlyData(server_id);
+}
+
+void SharedSessionCache::OnNewTokenReceived(
+    const ::quic::QuicServerId& server_id,
+    absl::string_view token) {
+  base::AutoLock lock(lock_);
+  cache_.OnNewTokenReceived(server_id, token);
+}
+
+void SharedSessionCache::RemoveExpiredEntries(::quic::QuicWallTime now) {
+  base::AutoLock lock(lock_);
+  cache_.RemoveExpiredEntries(now);
+}
+
+void SharedSessionCache::Clear() {
+  base::AutoLock lock(lock_);
+  cache_.Clear();
+}
+
+}  // namespace quic
+}  // namespace owt
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/shared_session_cache.h"
+#include <memory>
+#include "net/third_party/quiche/src/quic/core/crypto/transport_parameters.h"
+#include "net/third_party/quiche/src/quic/core/quic_server_id.h"
+#include "net/third_party/quiche/src/quic/test_tools/mock_clock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/boringssl/src/include/openssl/ssl.h"
+
+namespace owt {
+namespace quic {
+namespace test {
+
+class SharedSessionCacheTest : public testing::Test {
+ public:
+  SharedSessionCacheTest()
+      : ssl_ctx_(SSL_CTX_new(TLS_method())),
+        cache_(base::MakeRefCounted<SharedSessionCache>()),
+        server_id_("www.example.org", 443) {
+    clock_.AdvanceTime(::quic::QuicTime::Delta::FromSeconds(1000000));
+  }
+
+ protected:
+  bssl::UniquePtr<SSL_SESSION> NewSession() {
+    bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_new(ssl_ctx_.get()));
+    SSL_SESSION_set_time(session.get(), clock_.WallNow().ToUNIXSeconds());
+    SSL_SESSION_set_timeout(session.get(), 3600);
+    return session;
+  }
+
+  ::quic::MockClock clock_;
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+  scoped_refptr<SharedSessionCache> cache_;
+  ::quic::QuicServerId server_id_;
+  ::quic::TransportParameters params_;
+};
+
+TEST_F(SharedSessionCacheTest, ClientsShareSessions) {
+  std::unique_ptr<::quic::SessionCache> client1 = cache_->CreateClientCache();
+  std::unique_ptr<::quic::SessionCache> client2 = cache_->CreateClientCache();
+  client1->Insert(server_id_, NewSession(), params_, nullptr);
+  EXPECT_FALSE(client2->Lookup(::quic::QuicServerId("www.example.com", 443),
+                               clock_.WallNow(), ssl_ctx_.get()));
+  std::unique_ptr<::quic::QuicResumptionState> state =
+      client2->Lookup(server_id_, clock_.WallNow(), ssl_ctx_.get());
+  ASSERT_TRUE(state);
+  EXPECT_TRUE(state->tls_session);
+}
+
+TEST_F(SharedSessionCacheTest, OutlivesFactory) {
+  std::unique_ptr<::quic::SessionCache> client = cache_->CreateClientCache();
+  cache_ = nullptr;
+  client->Insert(server_id_, NewSession(), params_, nullptr);
+  EXPECT_TRUE(client->Lookup(server_id_, clock_.WallNow(), ssl_ctx_.get()));
+}
+
+TEST_F(SharedSessionCacheTest, ClearRemovesSessionsOfAllClients) {
+  std::unique_ptr<::quic::SessionCache> client1 = cache_->CreateClientCache();
+  std::unique_ptr<::quic::SessionCache> client2 = cache_->CreateClientCache();
+  client1->Insert(server_id_, NewSession(), params_, nullptr);
+  client2->Clear();
+  EXPECT_FALSE(client1->Lookup(server_id_, clock_.WallNow(), ssl_ctx_.get()));
+}
+
+}  // namespace test
+}  // namespace quic
+}  // namespace owt
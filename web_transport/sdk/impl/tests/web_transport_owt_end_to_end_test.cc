@@ -9,8 +9,12 @@
  */
 
 #include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/strings/strcat.h"
+#include "base/synchronization/waitable_event.h"
 #include "base/threading/thread.h"
+#include "impl/shared_session_cache.h"
 #include "impl/web_transport_owt_client_impl.h"
 #include "net/proxy_resolution/configured_proxy_resolution_service.h"
 #include "net/quic/crypto/proof_source_chromium.h"
@@ -42,11 +46,47 @@ class ClientMockVisitor : public WebTransportClientInterface::Visitor {
   MOCK_METHOD2(OnClosed, void(uint32_t, const char*));
 };
 
+class ServerMockVisitor : public WebTransportServerInterface::Visitor {
+ public:
+  MOCK_METHOD0(OnEnded, void());
+  MOCK_METHOD1(OnSession, void(WebTransportSessionInterface*));
+};
+
+class SessionMockVisitor : public WebTransportSessionInterface::Visitor {
+ public:
+  MOCK_METHOD1(OnIncomingStream, void(WebTransportStreamInterface*));
+  MOCK_METHOD1(OnCanCreateNewOutgoingStream, void(bool));
+  MOCK_METHOD0(OnConnectionClosed, void());
+  MOCK_METHOD2(OnDatagramReceived, void(const uint8_t*, size_t));
+  MOCK_METHOD4(OnStreamsReady,
+               void(WebTransportStreamInterface* const*,
+                    size_t,
+                    WebTransportStreamInterface* const*,
+                    size_t));
+  MOCK_METHOD1(OnNetworkEstimateChanged, void(const NetworkEstimate&));
+};
+
 class StreamMockVisitor : public WebTransportStreamInterface::Visitor {
  public:
   MOCK_METHOD0(OnCanRead, void());
   MOCK_METHOD0(OnCanWrite, void());
   MOCK_METHOD0(OnFinRead, void());
+  MOCK_METHOD3(OnDataAvailable, void(const DataSpan*, size_t, bool));
+};
+
+class WriteCallbackMock : public WebTransportStreamInterface::WriteCallback {
+ public:
+  MOCK_METHOD2(OnWriteCompleted, void(const uint8_t*, size_t));
+};
+
+class BufferReleaserMock : public BufferReleaser {
+ public:
+  MOCK_METHOD2(Release, void(const uint8_t*, size_t));
+};
+
+class ReadCallbackMock : public WebTransportStreamInterface::ReadCallback {
+ public:
+  MOCK_METHOD3(OnReadCompleted, void(uint8_t*, size_t, bool));
 };
 
 // A clock that only mocks out WallNow(), but uses real Now() and
@@ -84,6 +124,44 @@ class TestConnectionHelper : public ::quic::QuicConnectionHelperInterface {
   ::quic::SimpleBufferAllocator allocator_;
 };
 
+// A session cache which signals when a session ticket is received. Clients'
+// wall clock is mocked for certificate verification, but BoringSSL stamps
+// sessions with the system time, so sessions are looked up with the system
+// time as well.
+class TestSessionCache : public SharedSessionCache {
+ public:
+  TestSessionCache()
+      : session_inserted_(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                          base::WaitableEvent::InitialState::NOT_SIGNALED) {}
+
+  // Blocks until a session is inserted.
+  void WaitForSession() { session_inserted_.Wait(); }
+
+  // Overrides SharedSessionCache.
+  void Insert(const ::quic::QuicServerId& server_id,
+              bssl::UniquePtr<SSL_SESSION> session,
+              const ::quic::TransportParameters& params,
+              const ::quic::ApplicationState* application_state) override {
+    SharedSessionCache::Insert(server_id, std::move(session), params,
+                               application_state);
+    session_inserted_.Signal();
+  }
+  std::unique_ptr<::quic::QuicResumptionState> Lookup(
+      const ::quic::QuicServerId& server_id,
+      ::quic::QuicWallTime /*now*/,
+      const SSL_CTX* ctx) override {
+    return SharedSessionCache::Lookup(
+        server_id,
+        ::quic::QuicWallTime::FromUNIXSeconds(base::Time::Now().ToTimeT()),
+        ctx);
+  }
+
+ private:
+  ~TestSessionCache() override = default;
+
+  base::WaitableEvent session_inserted_;
+};
+
 class WebTransportOwtEndToEndTest : public net::TestWithTaskEnvironment {
  public:
   WebTransportOwtEndToEndTest()
@@ -119,7 +197,9 @@ class WebTransportOwtEndToEndTest : public net::TestWithTaskEnvironment {
     factory_.reset();
   }
 
-  void StartEchoServer() {
+  void StartEchoServer() { StartEchoServer(ServerOptions()); }
+
+  void StartEchoServer(const ServerOptions& options) {
     base::FilePath certs_dir = net::GetTestCertsDirectory();
     base::FilePath cert_path = certs_dir.AppendASCII("quic-short-lived.pem");
     base::FilePath key_path = certs_dir.AppendASCII("quic-leaf-cert.key");
@@ -141,11 +221,12 @@ class WebTransportOwtEndToEndTest : public net::TestWithTaskEnvironment {
         factory_->CreateWebTransportServer(port_,
 #if defined(OS_WIN)
                                            cert_path_char, key_path_char,
-                                           secret_path_char));
+                                           secret_path_char, options));
 #else
                                            cert_path.value().c_str(),
                                            key_path.value().c_str(),
-                                           secret_path.value().c_str()));
+                                           secret_path.value().c_str(),
+                                           options));
 #endif
     server_visitor_ = std::make_unique<ServerEchoVisitor>();
     server_->SetVisitor(server_visitor_.get());
@@ -180,7 +261,9 @@ class WebTransportOwtEndToEndTest : public net::TestWithTaskEnvironment {
     event->Signal();
   }
 
-  std::unique_ptr<WebTransportClientInterface> CreateClient(const GURL& url) {
+  std::unique_ptr<WebTransportClientInterface> CreateClient(
+      const GURL& url,
+      scoped_refptr<SharedSessionCache> session_cache = nullptr) {
     base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
                              base::WaitableEvent::InitialState::NOT_SIGNALED);
     io_thread_->task_runner()->PostTask(
@@ -198,9 +281,11 @@ class WebTransportOwtEndToEndTest : public net::TestWithTaskEnvironment {
     // (2020-06-05T20:35:00.000Z).
     helper_->clock().set_wall_now(
         ::quic::QuicWallTime::FromUNIXSeconds(1591389300));
-    return std::unique_ptr<WebTransportClientInterface>(
-        new WebTransportOwtClientImpl(url, origin_, parameters, context_.get(),
-                                      io_thread_.get(), event_thread_.get()));
+    auto client = std::make_unique<WebTransportOwtClientImpl>(
+        url, origin_, parameters, context_.get(), io_thread_.get(),
+        event_thread_.get());
+    client->SetSessionCache(std::move(session_cache));
+    return client;
   }
 
  protected:
@@ -266,6 +351,228 @@ TEST_F(WebTransportOwtEndToEndTest, EchoBidirectionalStream) {
   }
 }
 
+TEST_F(WebTransportOwtEndToEndTest, EchoBidirectionalStreamAsync) {
+  StartEchoServer();
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  auto* stream = client_->CreateBidirectionalStream();
+  EXPECT_TRUE(stream != nullptr);
+  const size_t data_size = 10;
+  std::vector<uint8_t> data(data_size);
+  for (size_t i = 0; i < data_size; i++) {
+    data[i] = i;
+  }
+  std::vector<uint8_t> data_read(data_size);
+  WriteCallbackMock write_callback;
+  ReadCallbackMock read_callback;
+  EXPECT_CALL(write_callback, OnWriteCompleted(data.data(), data_size));
+  EXPECT_CALL(read_callback,
+              OnReadCompleted(data_read.data(), data_size, false))
+      .WillOnce(StopRunning());
+  EXPECT_EQ(stream->WriteAsync(data.data(), data_size, &write_callback),
+            AsyncIoStatus::kAccepted);
+  EXPECT_EQ(stream->ReadAsync(data_read.data(), data_size, &read_callback),
+            AsyncIoStatus::kAccepted);
+  Run();
+  EXPECT_EQ(data, data_read);
+}
+
+TEST_F(WebTransportOwtEndToEndTest, AsyncIoFailsAfterSessionClosed) {
+  StartEchoServer();
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  auto* stream = client_->CreateBidirectionalStream();
+  ASSERT_TRUE(stream != nullptr);
+  std::vector<uint8_t> data(10);
+  ReadCallbackMock read_callback;
+  EXPECT_EQ(stream->ReadAsync(data.data(), data.size(), &read_callback),
+            AsyncIoStatus::kAccepted);
+  // The pending read fails when the session is closed.
+  EXPECT_CALL(read_callback, OnReadCompleted(data.data(), 0u, false));
+  EXPECT_CALL(visitor_, OnClosed(testing::_, testing::_))
+      .WillOnce(StopRunning());
+  ASSERT_EQ(server_visitor_->Sessions().size(), 1u);
+  server_visitor_->Sessions()[0]->Close(0, "");
+  Run();
+  testing::Mock::VerifyAndClearExpectations(&read_callback);
+  WriteCallbackMock write_callback;
+  EXPECT_EQ(stream->ReadAsync(data.data(), data.size(), &read_callback),
+            AsyncIoStatus::kClosed);
+  EXPECT_EQ(stream->WriteAsync(data.data(), data.size(), &write_callback),
+            AsyncIoStatus::kClosed);
+}
+
+TEST_F(WebTransportOwtEndToEndTest, EchoBidirectionalStreamPushMode) {
+  StartEchoServer();
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  StreamMockVisitor stream_visitor;
+  auto* stream = client_->CreateBidirectionalStream();
+  EXPECT_TRUE(stream != nullptr);
+  stream->SetVisitor(&stream_visitor);
+  stream->SetPushMode(true);
+  const size_t data_size = 10;
+  std::vector<uint8_t> data(data_size);
+  for (size_t i = 0; i < data_size; i++) {
+    data[i] = i;
+  }
+  std::vector<uint8_t> data_read;
+  EXPECT_CALL(stream_visitor, OnCanRead()).Times(0);
+  EXPECT_CALL(stream_visitor, OnDataAvailable(testing::_, testing::_, false))
+      .WillOnce(testing::Invoke(
+          [&](const DataSpan* regions, size_t region_count, bool fin) {
+            size_t consumed = 0;
+            for (size_t i = 0; i < region_count; i++) {
+              data_read.insert(data_read.end(), regions[i].data,
+                               regions[i].data + regions[i].length);
+              consumed += regions[i].length;
+            }
+            stream->Consume(consumed);
+            run_loop_->Quit();
+          }));
+  EXPECT_EQ(stream->Write(data.data(), data_size), data_size);
+  Run();
+  EXPECT_EQ(data, data_read);
+  EXPECT_EQ(stream->ReadableBytes(), 0u);
+}
+
+TEST_F(WebTransportOwtEndToEndTest, PushModeReportsFin) {
+  StartEchoServer();
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  ASSERT_EQ(server_visitor_->Sessions().size(), 1u);
+  StreamMockVisitor stream_visitor;
+  WebTransportStreamInterface* client_stream = nullptr;
+  std::vector<uint8_t> data_read;
+  EXPECT_CALL(visitor_, OnIncomingStream(testing::_))
+      .WillOnce(testing::Invoke([&](WebTransportStreamInterface* stream) {
+        client_stream = stream;
+        stream->SetVisitor(&stream_visitor);
+        stream->SetPushMode(true);
+      }));
+  EXPECT_CALL(stream_visitor, OnDataAvailable(testing::_, testing::_, false))
+      .WillRepeatedly(testing::Invoke(
+          [&](const DataSpan* regions, size_t region_count, bool fin) {
+            size_t consumed = 0;
+            for (size_t i = 0; i < region_count; i++) {
+              data_read.insert(data_read.end(), regions[i].data,
+                               regions[i].data + regions[i].length);
+              consumed += regions[i].length;
+            }
+            client_stream->Consume(consumed);
+          }));
+  EXPECT_CALL(stream_visitor, OnDataAvailable(testing::_, 0u, true));
+  EXPECT_CALL(stream_visitor, OnFinRead()).WillOnce(StopRunning());
+  auto* server_stream =
+      server_visitor_->Sessions()[0]->CreateBidirectionalStream();
+  ASSERT_TRUE(server_stream != nullptr);
+  std::vector<uint8_t> data = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  EXPECT_EQ(server_stream->Write(data.data(), data.size()), data.size());
+  server_stream->Close();
+  Run();
+  EXPECT_EQ(data, data_read);
+}
+
+TEST_F(WebTransportOwtEndToEndTest, EchoBidirectionalStreamWritev) {
+  StartEchoServer();
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  StreamMockVisitor stream_visitor;
+  auto* stream = client_->CreateBidirectionalStream();
+  EXPECT_TRUE(stream != nullptr);
+  stream->SetVisitor(&stream_visitor);
+  std::vector<uint8_t> header = {0, 1};
+  std::vector<uint8_t> payload = {2, 3, 4, 5, 6, 7, 8, 9};
+  DataSpan spans[] = {{header.data(), header.size()},
+                      {payload.data(), payload.size()}};
+  const size_t data_size = header.size() + payload.size();
+  EXPECT_EQ(stream->Writev(spans, 2), data_size);
+  EXPECT_CALL(stream_visitor, OnCanRead()).WillOnce(StopRunning());
+  Run();
+  std::vector<uint8_t> data_read(data_size);
+  EXPECT_EQ(stream->Read(data_read.data(), data_size), data_size);
+  for (size_t i = 0; i < data_size; i++) {
+    EXPECT_EQ(data_read[i], i);
+  }
+  // Both spans are released after they are acknowledged.
+  BufferReleaserMock releaser;
+  EXPECT_CALL(releaser, Release(header.data(), header.size()));
+  EXPECT_CALL(releaser, Release(payload.data(), payload.size()))
+      .WillOnce(StopRunning());
+  EXPECT_EQ(stream->WritevWithOwnership(spans, 2, &releaser),
+            AsyncIoStatus::kAccepted);
+  Run();
+}
+
+TEST_F(WebTransportOwtEndToEndTest, BatchedStreamEvents) {
+  StartEchoServer();
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  ASSERT_EQ(server_visitor_->Sessions().size(), 1u);
+  auto* session = server_visitor_->Sessions()[0];
+  SessionMockVisitor session_visitor;
+  session->SetVisitor(&session_visitor);
+  session->SetBatchedStreamEvents(true);
+  const size_t stream_count = 3;
+  // Per-stream callbacks are not called while batched events are enabled.
+  StreamMockVisitor server_stream_visitor;
+  EXPECT_CALL(server_stream_visitor, OnCanRead()).Times(0);
+  EXPECT_CALL(server_stream_visitor, OnCanWrite()).Times(0);
+  // Server's IO thread is blocked by the first incoming stream until data of
+  // all streams is sent, so they are processed in the same batch.
+  base::WaitableEvent all_sent(base::WaitableEvent::ResetPolicy::MANUAL,
+                               base::WaitableEvent::InitialState::NOT_SIGNALED);
+  std::vector<WebTransportStreamInterface*> incoming_streams;
+  EXPECT_CALL(session_visitor, OnIncomingStream(testing::_))
+      .Times(stream_count)
+      .WillRepeatedly(testing::Invoke([&](WebTransportStreamInterface* stream) {
+        stream->SetVisitor(&server_stream_visitor);
+        incoming_streams.push_back(stream);
+        all_sent.Wait();
+      }));
+  std::vector<WebTransportStreamInterface*> readable_streams;
+  EXPECT_CALL(session_visitor,
+              OnStreamsReady(testing::_, testing::_, testing::_, testing::_))
+      .Times(testing::AnyNumber());
+  EXPECT_CALL(session_visitor,
+              OnStreamsReady(testing::_, stream_count, testing::_, testing::_))
+      .WillOnce(testing::Invoke(
+          [&](WebTransportStreamInterface* const* readable,
+              size_t readable_count, WebTransportStreamInterface* const*,
+              size_t) {
+            readable_streams.assign(readable, readable + readable_count);
+            run_loop_->Quit();
+          }));
+  uint8_t data[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  for (size_t i = 0; i < stream_count; i++) {
+    auto* stream = client_->CreateBidirectionalStream();
+    ASSERT_TRUE(stream != nullptr);
+    EXPECT_EQ(stream->Write(data, sizeof(data)), sizeof(data));
+  }
+  all_sent.Signal();
+  Run();
+  EXPECT_THAT(readable_streams,
+              testing::UnorderedElementsAreArray(incoming_streams));
+}
+
 TEST_F(WebTransportOwtEndToEndTest, ClientSendsDatagram) {
   StartEchoServer();
   client_ = CreateClient(GetServerUrl("/echo"));
@@ -282,6 +589,221 @@ TEST_F(WebTransportOwtEndToEndTest, ClientSendsDatagram) {
   client_->SendOrQueueDatagram(data, data_size);
 }
 
+TEST_F(WebTransportOwtEndToEndTest, ClientSendsDatagramAsync) {
+  StartEchoServer();
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  std::vector<uint8_t> data(10);
+  BufferReleaserMock releaser;
+  EXPECT_CALL(visitor_, OnDatagramProcessed(testing::_)).Times(1);
+  EXPECT_CALL(releaser, Release(data.data(), data.size()))
+      .WillOnce(StopRunning());
+  EXPECT_EQ(
+      client_->SendOrQueueDatagramAsync(data.data(), data.size(), &releaser),
+      AsyncIoStatus::kAccepted);
+  Run();
+}
+
+TEST_F(WebTransportOwtEndToEndTest, ClientSendsDatagrams) {
+  StartEchoServer();
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  const size_t datagram_count = 3;
+  std::vector<uint8_t> data(10);
+  DataSpan datagrams[datagram_count];
+  MessageStatus statuses[datagram_count];
+  for (size_t i = 0; i < datagram_count; i++) {
+    datagrams[i] = {data.data(), data.size()};
+    statuses[i] = MessageStatus::kUnavailable;
+  }
+  EXPECT_CALL(visitor_, OnDatagramProcessed(testing::_)).Times(datagram_count);
+  client_->SendDatagrams(datagrams, datagram_count, statuses);
+  for (size_t i = 0; i < datagram_count; i++) {
+    EXPECT_EQ(statuses[i], MessageStatus::kSuccess);
+  }
+}
+
+TEST_F(WebTransportOwtEndToEndTest, ClientGetsStats) {
+  StartEchoServer();
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  ConnectionStats stats = client_->GetStats();
+  EXPECT_GT(stats.bytes_sent, 0u);
+  EXPECT_GT(stats.packets_received, 0u);
+  EXPECT_GT(stats.smoothed_rtt_us, 0);
+  EXPECT_GT(stats.congestion_window, 0u);
+  EXPECT_EQ(stats.stream_buffered_bytes, 0u);
+}
+
+TEST_F(WebTransportOwtEndToEndTest, SetCongestionControl) {
+  StartEchoServer();
+  server_->SetCongestionControl(CongestionControlAlgorithm::kReno, 20);
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  ASSERT_EQ(server_visitor_->Sessions().size(), 1u);
+  auto* session = server_visitor_->Sessions()[0];
+  // Handshake doesn't fill the initial window, so it's not grown yet.
+  EXPECT_EQ(session->GetStats().congestion_window, 20 * ::quic::kDefaultTCPMSS);
+  session->SetCongestionControl(CongestionControlAlgorithm::kCubic, 10);
+  EXPECT_EQ(session->GetStats().congestion_window, 10 * ::quic::kDefaultTCPMSS);
+  // Initial window is kept when only algorithm is changed.
+  session->SetCongestionControl(CongestionControlAlgorithm::kReno, 0);
+  EXPECT_EQ(session->GetStats().congestion_window, 10 * ::quic::kDefaultTCPMSS);
+}
+
+TEST_F(WebTransportOwtEndToEndTest, NetworkEstimateChanged) {
+  StartEchoServer();
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  ASSERT_EQ(server_visitor_->Sessions().size(), 1u);
+  auto* session = server_visitor_->Sessions()[0];
+  SessionMockVisitor session_visitor;
+  session->SetVisitor(&session_visitor);
+  // Only congestion window changes are reported.
+  NetworkEstimateThresholds thresholds = {0, 0, 10, 0};
+  session->SetNetworkEstimateThresholds(&thresholds);
+  std::vector<NetworkEstimate> estimates;
+  // The first estimate is always reported. The next one is reported when
+  // congestion window grows while sending data.
+  EXPECT_CALL(session_visitor, OnNetworkEstimateChanged(testing::_))
+      .Times(testing::AtLeast(2))
+      .WillRepeatedly(testing::Invoke([&](const NetworkEstimate& estimate) {
+        if (estimates.size() >= 2) {
+          return;
+        }
+        estimates.push_back(estimate);
+        if (estimates.size() == 2) {
+          run_loop_->Quit();
+        }
+      }));
+  EXPECT_CALL(visitor_, OnIncomingStream(testing::_));
+  auto* stream = session->CreateBidirectionalStream();
+  ASSERT_TRUE(stream != nullptr);
+  std::vector<uint8_t> data(1024 * 1024);
+  EXPECT_EQ(stream->Write(data.data(), data.size()), data.size());
+  Run();
+  session->SetNetworkEstimateThresholds(nullptr);
+  ASSERT_GE(estimates.size(), 2u);
+  uint64_t previous = estimates[0].congestion_window;
+  uint64_t current = estimates[1].congestion_window;
+  uint64_t difference =
+      previous > current ? previous - current : current - previous;
+  EXPECT_GE(difference * 100,
+            previous * thresholds.congestion_window_change_percent);
+}
+
+TEST_F(WebTransportOwtEndToEndTest, ServerGetsStats) {
+  StartEchoServer();
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  ServerStats stats = server_->GetStats();
+  EXPECT_GT(stats.packet_read_batch_size, 0u);
+  EXPECT_GT(stats.packets_read, 0u);
+  EXPECT_GT(stats.packet_read_calls, 0u);
+}
+
+TEST_F(WebTransportOwtEndToEndTest, ShardedServer) {
+  ServerOptions options;
+  options.io_thread_count = 4;
+  StartEchoServer(options);
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  EXPECT_EQ(server_visitor_->Sessions().size(), 1u);
+  EXPECT_GT(server_->GetStats().packets_read, 0u);
+}
+
+TEST_F(WebTransportOwtEndToEndTest, ServerWithOptions) {
+  ServerOptions options;
+  options.initial_session_flow_control_window = 256 * 1024;
+  options.initial_stream_flow_control_window = 32 * 1024;
+  options.socket_receive_buffer_size = 256 * 1024;
+  options.socket_send_buffer_size = 256 * 1024;
+  options.max_reads_per_event = 8;
+  options.max_new_connections_per_event = 4;
+  options.max_incoming_bidirectional_streams = 10;
+  options.idle_timeout_ms = 10000;
+  options.max_packet_size = 1200;
+  options.packet_read_batch_size = 4;
+  StartEchoServer(options);
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  StreamMockVisitor stream_visitor;
+  auto* stream = client_->CreateBidirectionalStream();
+  ASSERT_TRUE(stream != nullptr);
+  stream->SetVisitor(&stream_visitor);
+  uint8_t data[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  EXPECT_EQ(stream->Write(data, sizeof(data)), sizeof(data));
+  EXPECT_CALL(stream_visitor, OnCanRead()).WillOnce(StopRunning());
+  Run();
+  EXPECT_EQ(stream->ReadableBytes(), sizeof(data));
+  EXPECT_GT(server_->GetStats().packets_read, 0u);
+  // Server's stream limit is sent to the client. The CONNECT stream of the
+  // session is a bidirectional stream as well.
+  size_t stream_count = 1;
+  while (client_->CreateBidirectionalStream() != nullptr) {
+    stream_count++;
+    ASSERT_LT(stream_count, options.max_incoming_bidirectional_streams);
+  }
+  EXPECT_EQ(stream_count + 1, options.max_incoming_bidirectional_streams);
+}
+
+TEST_F(WebTransportOwtEndToEndTest, ClientCompletesRetry) {
+  ServerOptions options;
+  options.max_handshakes_per_second = 1;
+  StartEchoServer(options);
+  // The first handshake takes the only token in the bucket.
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  client_.reset();
+  // The next client gets a Retry packet, and it's admitted with the address
+  // validation token.
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  StreamMockVisitor stream_visitor;
+  auto* stream = client_->CreateBidirectionalStream();
+  ASSERT_TRUE(stream != nullptr);
+  stream->SetVisitor(&stream_visitor);
+  uint8_t data[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  EXPECT_EQ(stream->Write(data, sizeof(data)), sizeof(data));
+  EXPECT_CALL(stream_visitor, OnCanRead()).WillOnce(StopRunning());
+  Run();
+  EXPECT_EQ(stream->ReadableBytes(), sizeof(data));
+  ServerStats stats = server_->GetStats();
+  EXPECT_EQ(stats.handshakes_deferred, 1u);
+  EXPECT_EQ(stats.handshakes_rejected, 0u);
+  EXPECT_EQ(stats.full_handshakes, 2u);
+}
+
 TEST_F(WebTransportOwtEndToEndTest, ClientOnClosed) {
   StartEchoServer();
   client_ = CreateClient(GetServerUrl("/echo"));
@@ -296,6 +818,110 @@ TEST_F(WebTransportOwtEndToEndTest, ClientOnClosed) {
   Run();
 }
 
+TEST_F(WebTransportOwtEndToEndTest, IncomingStreamIsReportedBeforeClosed) {
+  StartEchoServer();
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  ASSERT_EQ(server_visitor_->Sessions().size(), 1u);
+  testing::InSequence sequence;
+  StreamMockVisitor stream_visitor;
+  EXPECT_CALL(visitor_, OnIncomingStream(testing::_))
+      .WillOnce(testing::Invoke([&](WebTransportStreamInterface* stream) {
+        // The stream is still valid even if the session is closed on IO
+        // thread.
+        stream->SetVisitor(&stream_visitor);
+        EXPECT_GT(stream->Id(), 0u);
+      }));
+  EXPECT_CALL(visitor_, OnClosed(testing::_, testing::_))
+      .WillOnce(StopRunning());
+  auto* server_stream =
+      server_visitor_->Sessions()[0]->CreateBidirectionalStream();
+  ASSERT_TRUE(server_stream != nullptr);
+  uint8_t data[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  EXPECT_EQ(server_stream->Write(data, sizeof(data)), sizeof(data));
+  server_visitor_->Sessions()[0]->Close(0, "");
+  Run();
+}
+
+TEST_F(WebTransportOwtEndToEndTest, ClientResumesSession) {
+  StartEchoServer();
+  auto session_cache = base::MakeRefCounted<TestSessionCache>();
+  client_ = CreateClient(GetServerUrl("/echo"), session_cache);
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  EXPECT_EQ(server_->GetStats().full_handshakes, 1u);
+  // NewSessionTicket may arrive after the client is connected.
+  session_cache->WaitForSession();
+  client_.reset();
+  // A new client to the same server resumes the session of the previous one.
+  client_ = CreateClient(GetServerUrl("/echo"), session_cache);
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  ServerStats stats = server_->GetStats();
+  EXPECT_EQ(stats.full_handshakes, 1u);
+  EXPECT_EQ(stats.resumed_handshakes, 1u);
+}
+
+TEST_F(WebTransportOwtEndToEndTest, ResumesSessionWithKeyFile) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath key_file = temp_dir.GetPath().AppendASCII("ticket_keys");
+  ASSERT_TRUE(
+      base::WriteFile(key_file, "000102030405060708090a0b0c0d0e0f\n"));
+  const std::string key_file_path = key_file.AsUTF8Unsafe();
+  ServerOptions options;
+  options.session_ticket_key_file = key_file_path.c_str();
+  StartEchoServer(options);
+  auto session_cache = base::MakeRefCounted<TestSessionCache>();
+  client_ = CreateClient(GetServerUrl("/echo"), session_cache);
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  session_cache->WaitForSession();
+  client_.reset();
+  ServerStats stats = server_->GetStats();
+  EXPECT_EQ(stats.full_handshakes, 1u);
+  EXPECT_EQ(stats.resumed_handshakes, 0u);
+  EXPECT_EQ(stats.zero_rtt_handshakes, 0u);
+  // The next client resumes the session with a ticket encrypted by the key in
+  // the file, and sends 0-RTT data.
+  client_ = CreateClient(GetServerUrl("/echo"), session_cache);
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  stats = server_->GetStats();
+  EXPECT_EQ(stats.full_handshakes, 1u);
+  EXPECT_EQ(stats.resumed_handshakes, 1u);
+  EXPECT_EQ(stats.zero_rtt_handshakes, 1u);
+}
+
+TEST_F(WebTransportOwtEndToEndTest, StopDrainsSessions) {
+  ServerOptions options;
+  options.drain_timeout_ms = 200;
+  StartEchoServer(options);
+  client_ = CreateClient(GetServerUrl("/echo"));
+  client_->SetVisitor(&visitor_);
+  EXPECT_CALL(visitor_, OnConnected()).WillOnce(StopRunning());
+  client_->Connect();
+  Run();
+  // The client ignores GOAWAY, so its session is closed by the server when
+  // drain timeout expires.
+  ServerMockVisitor server_visitor;
+  server_->SetVisitor(&server_visitor);
+  EXPECT_CALL(server_visitor, OnEnded()).WillOnce(StopRunning());
+  server_->Stop();
+  Run();
+}
+
 }  // namespace test
 }  // namespace quic
 }  // namespace owt
\ No newline at end of file
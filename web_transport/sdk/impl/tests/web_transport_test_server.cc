@@ -41,7 +41,7 @@ int main(int argc, char* argv[]) {
       FROM_HERE, base::BindLambdaForTesting([&]() {
         server = std::make_unique<owt::quic::WebTransportOwtServerImpl>(
             20001, std::vector<url::Origin>(), std::move(proof_source),
-            &io_thread, &event_thread);
+            owt::quic::ServerOptions(), &io_thread, &event_thread);
         event.Signal();
       }));
   event.Wait();
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/udp_batch_packet_writer.h"
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <string.h>
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+
+namespace owt {
+namespace quic {
+
+namespace {
+// Kernel doesn't accept more segments in a GSO message.
+constexpr size_t kMaxGsoSegments = 64;
+// Maximum UDP payload of an IPv4 packet. GSO messages are limited by it.
+constexpr size_t kMaxGsoMessageLength = 65507;
+constexpr size_t kMaxBufferedPackets = kMaxGsoSegments;
+constexpr size_t kBufferSize =
+    kMaxBufferedPackets * ::quic::kMaxOutgoingPacketSize;
+constexpr size_t kControlBufferSize = CMSG_SPACE(sizeof(uint16_t));
+
+bool IsGsoSupported(int fd) {
+  int segment_size = 0;
+  socklen_t length = sizeof(segment_size);
+  return getsockopt(fd, SOL_UDP, UDP_SEGMENT, &segment_size, &length) == 0;
+}
+}  // namespace
+
+UdpBatchPacketWriter::UdpBatchPacketWriter(int fd,
+                                           ::quic::QuicDispatcher* dispatcher)
+    : UdpPacketWriter(fd, dispatcher),
+      gso_enabled_(IsGsoSupported(fd)),
+      buffer_(new char[kBufferSize]),
+      buffer_length_(0),
+      messages_(kMaxBufferedPackets),
+      iovecs_(kMaxBufferedPackets),
+      peer_addresses_(kMaxBufferedPackets),
+      control_buffers_(kMaxBufferedPackets * kControlBufferSize),
+      packets_per_message_(kMaxBufferedPackets) {
+  packets_.reserve(kMaxBufferedPackets);
+}
+
+UdpBatchPacketWriter::~UdpBatchPacketWriter() = default;
+
+::quic::WriteResult UdpBatchPacketWriter::WritePacket(
+    const char* buffer,
+    size_t buf_len,
+    const ::quic::QuicIpAddress& self_address,
+    const ::quic::QuicSocketAddress& peer_address,
+    ::quic::PerPacketOptions* options) {
+  DCHECK(!IsWriteBlocked());
+  DCHECK_LE(buf_len, ::quic::kMaxOutgoingPacketSize);
+  if (!CanBuffer(buf_len)) {
+    ::quic::WriteResult result = Flush();
+    if (result.status == ::quic::WRITE_STATUS_BLOCKED_DATA_BUFFERED) {
+      // Previous packets are still buffered, but this one is not.
+      return ::quic::WriteResult(::quic::WRITE_STATUS_BLOCKED,
+                                 result.error_code);
+    }
+    if (result.status != ::quic::WRITE_STATUS_OK) {
+      return result;
+    }
+  }
+  // `buffer` is already in place if it was returned by GetNextWriteLocation
+  // and no flush happened since then.
+  char* location = buffer_.get() + buffer_length_;
+  if (buffer != location) {
+    memmove(location, buffer, buf_len);
+  }
+  packets_.push_back({buffer_length_, buf_len, peer_address});
+  buffer_length_ += buf_len;
+  if (CanBuffer(::quic::kMaxOutgoingPacketSize)) {
+    return ::quic::WriteResult(::quic::WRITE_STATUS_OK, 0);
+  }
+  return Flush();
+}
+
+bool UdpBatchPacketWriter::IsBatchMode() const {
+  return true;
+}
+
+::quic::QuicPacketBuffer UdpBatchPacketWriter::GetNextWriteLocation(
+    const ::quic::QuicIpAddress& self_address,
+    const ::quic::QuicSocketAddress& peer_address) {
+  if (!CanBuffer(::quic::kMaxOutgoingPacketSize)) {
+    return {nullptr, nullptr};
+  }
+  return {buffer_.get() + buffer_length_, nullptr};
+}
+
+::quic::WriteResult UdpBatchPacketWriter::Flush() {
+  size_t bytes_sent = 0;
+  while (!packets_.empty()) {
+    if (IsWriteBlocked()) {
+      return ::quic::WriteResult(::quic::WRITE_STATUS_BLOCKED_DATA_BUFFERED,
+                                 EWOULDBLOCK);
+    }
+    const size_t message_count = BuildMessages();
+    int result =
+        HANDLE_EINTR(sendmmsg(fd(), messages_.data(), message_count, 0));
+    if (result > 0) {
+      for (int i = 0; i < result; i++) {
+        bytes_sent += messages_[i].msg_len;
+      }
+      RemoveSentPackets(result);
+      continue;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      OnWriteBlocked();
+      return ::quic::WriteResult(::quic::WRITE_STATUS_BLOCKED_DATA_BUFFERED,
+                                 errno);
+    }
+    if (gso_enabled_ && (errno == EIO || errno == EINVAL)) {
+      // Network interface doesn't support GSO. Send packets one by one.
+      PLOG(WARNING) << "UDP GSO is not supported, disabled";
+      gso_enabled_ = false;
+      continue;
+    }
+    const int error = errno;
+    // Drop all buffered packets. They are retransmitted by QUIC if necessary.
+    packets_.clear();
+    buffer_length_ = 0;
+    return ::quic::WriteResult(error == EMSGSIZE
+                                   ? ::quic::WRITE_STATUS_MSG_TOO_BIG
+                                   : ::quic::WRITE_STATUS_ERROR,
+                               error);
+  }
+  return ::quic::WriteResult(::quic::WRITE_STATUS_OK, bytes_sent);
+}
+
+bool UdpBatchPacketWriter::CanBuffer(size_t length) const {
+  return packets_.size() < kMaxBufferedPackets &&
+         buffer_length_ + length <= kBufferSize;
+}
+
+size_t UdpBatchPacketWriter::BuildMessages() {
+  size_t message_count = 0;
+  size_t i = 0;
+  while (i < packets_.size()) {
+    const BufferedPacket& first = packets_[i];
+    const size_t segment_size = first.length;
+    size_t message_length = first.length;
+    size_t segments = 1;
+    if (gso_enabled_) {
+      // Only the last segment may be smaller than `segment_size`.
+      while (i + segments < packets_.size() && segments < kMaxGsoSegments) {
+        const BufferedPacket& previous = packets_[i + segments - 1];
+        const BufferedPacket& next = packets_[i + segments];
+        if (previous.length != segment_size || next.length > segment_size ||
+            next.peer_address != first.peer_address ||
+            message_length + next.length > kMaxGsoMessageLength) {
+          break;
+        }
+        message_length += next.length;
+        segments++;
+      }
+    }
+
+    iovec& iov = iovecs_[message_count];
+    iov.iov_base = buffer_.get() + first.offset;
+    iov.iov_len = message_length;
+    msghdr& header = messages_[message_count].msg_hdr;
+    header = {};
+    header.msg_name = &peer_addresses_[message_count];
+    header.msg_namelen = ToDualStackSockaddr(first.peer_address,
+                                             &peer_addresses_[message_count]);
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+    if (segments > 1) {
+      header.msg_control =
+          control_buffers_.data() + message_count * kControlBufferSize;
+      header.msg_controllen = kControlBufferSize;
+      cmsghdr* cmsg = CMSG_FIRSTHDR(&header);
+      cmsg->cmsg_level = SOL_UDP;
+      cmsg->cmsg_type = UDP_SEGMENT;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+      const uint16_t gso_size = static_cast<uint16_t>(segment_size);
+      memcpy(CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+    }
+    messages_[message_count].msg_len = 0;
+    packets_per_message_[message_count] = segments;
+    message_count++;
+    i += segments;
+  }
+  return message_count;
+}
+
+void UdpBatchPacketWriter::RemoveSentPackets(size_t message_count) {
+  size_t sent_packets = 0;
+  for (size_t i = 0; i < message_count; i++) {
+    sent_packets += packets_per_message_[i];
+  }
+  if (sent_packets == packets_.size()) {
+    packets_.clear();
+    buffer_length_ = 0;
+    return;
+  }
+  // Move remaining packets to the beginning of `buffer_`.
+  const size_t sent_bytes = packets_[sent_packets].offset;
+  memmove(buffer_.get(), buffer_.get() + sent_bytes,
+          buffer_length_ - sent_bytes);
+  buffer_length_ -= sent_bytes;
+  packets_.erase(packets_.begin(), packets_.begin() + sent_packets);
+  for (auto& packet : packets_) {
+    packet.offset -= sent_bytes;
+  }
+}
+
+}  // namespace quic
+}  // namespace owt
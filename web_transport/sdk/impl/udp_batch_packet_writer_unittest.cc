@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/udp_batch_packet_writer.h"
+#include <string.h>
+#include <string>
+#include <vector>
+#include "impl/udp_batch_reader.h"
+#include "impl/udp_server_socket_posix.h"
+#include "net/base/net_errors.h"
+#include "net/quic/platform/impl/quic_chromium_clock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace owt {
+namespace quic {
+namespace test {
+
+class ReceivedPacketCollector : public UdpBatchReader::Visitor {
+ public:
+  void OnPacketRead(const ::quic::QuicReceivedPacket& packet,
+                    const ::quic::QuicSocketAddress& peer_address) override {
+    packets.emplace_back(packet.data(), packet.length());
+  }
+  std::vector<std::string> packets;
+};
+
+class UdpBatchPacketWriterTest : public testing::Test {
+ public:
+  UdpBatchPacketWriterTest()
+      : reader_(16, false, ::quic::QuicChromiumClock::GetInstance()) {}
+
+  void SetUp() override {
+    ASSERT_EQ(sender_.Listen(0), net::OK);
+    ASSERT_EQ(receiver_.Listen(0), net::OK);
+    writer_ = std::make_unique<UdpBatchPacketWriter>(sender_.fd(), nullptr);
+  }
+
+ protected:
+  ::quic::QuicSocketAddress ReceiverAddress() const {
+    return ::quic::QuicSocketAddress(::quic::QuicIpAddress::Loopback4(),
+                                     receiver_.local_address().port());
+  }
+
+  // Writes a packet of `length` bytes filled with `fill`, serialized in place
+  // like QuicConnection does.
+  ::quic::WriteResult WritePacket(size_t length,
+                                  char fill,
+                                  const ::quic::QuicSocketAddress& peer) {
+    ::quic::QuicPacketBuffer location = writer_->GetNextWriteLocation(
+        ::quic::QuicIpAddress::Any6(), peer);
+    std::string local_buffer;
+    char* buffer = location.buffer;
+    if (!buffer) {
+      local_buffer.resize(length);
+      buffer = &local_buffer[0];
+    }
+    memset(buffer, fill, length);
+    return writer_->WritePacket(buffer, length, ::quic::QuicIpAddress::Any6(),
+                                peer, nullptr);
+  }
+
+  std::vector<std::string> ReceivePackets() {
+    ReceivedPacketCollector collector;
+    reader_.ReadPackets(receiver_.fd(), 256, &collector);
+    return collector.packets;
+  }
+
+  UdpServerSocketPosix sender_;
+  UdpServerSocketPosix receiver_;
+  UdpBatchReader reader_;
+  std::unique_ptr<UdpBatchPacketWriter> writer_;
+};
+
+TEST_F(UdpBatchPacketWriterTest, BuffersUntilFlush) {
+  EXPECT_TRUE(writer_->IsBatchMode());
+  for (char fill = 'a'; fill < 'd'; fill++) {
+    ::quic::WriteResult result = WritePacket(1000, fill, ReceiverAddress());
+    EXPECT_EQ(result.status, ::quic::WRITE_STATUS_OK);
+  }
+  EXPECT_EQ(writer_->buffered_packets(), 3u);
+  EXPECT_TRUE(ReceivePackets().empty());
+
+  ::quic::WriteResult result = writer_->Flush();
+  EXPECT_EQ(result.status, ::quic::WRITE_STATUS_OK);
+  EXPECT_EQ(result.bytes_written, 3000);
+  EXPECT_EQ(writer_->buffered_packets(), 0u);
+  std::vector<std::string> packets = ReceivePackets();
+  ASSERT_EQ(packets.size(), 3u);
+  EXPECT_EQ(packets[0], std::string(1000, 'a'));
+  EXPECT_EQ(packets[1], std::string(1000, 'b'));
+  EXPECT_EQ(packets[2], std::string(1000, 'c'));
+}
+
+TEST_F(UdpBatchPacketWriterTest, MixedSizesAndPeers) {
+  UdpServerSocketPosix another_receiver;
+  ASSERT_EQ(another_receiver.Listen(0), net::OK);
+  ::quic::QuicSocketAddress another_address(
+      ::quic::QuicIpAddress::Loopback4(),
+      another_receiver.local_address().port());
+  WritePacket(1200, 'a', ReceiverAddress());
+  WritePacket(1200, 'b', ReceiverAddress());
+  WritePacket(500, 'c', ReceiverAddress());
+  WritePacket(300, 'd', another_address);
+  WritePacket(1200, 'e', ReceiverAddress());
+  EXPECT_EQ(writer_->Flush().status, ::quic::WRITE_STATUS_OK);
+
+  std::vector<std::string> packets = ReceivePackets();
+  ASSERT_EQ(packets.size(), 4u);
+  EXPECT_EQ(packets[0], std::string(1200, 'a'));
+  EXPECT_EQ(packets[1], std::string(1200, 'b'));
+  EXPECT_EQ(packets[2], std::string(500, 'c'));
+  EXPECT_EQ(packets[3], std::string(1200, 'e'));
+  ReceivedPacketCollector collector;
+  reader_.ReadPackets(another_receiver.fd(), 16, &collector);
+  ASSERT_EQ(collector.packets.size(), 1u);
+  EXPECT_EQ(collector.packets[0], std::string(300, 'd'));
+}
+
+TEST_F(UdpBatchPacketWriterTest, FlushesWhenBufferIsFull) {
+  size_t flushed_bytes = 0;
+  for (int i = 0; i < 64; i++) {
+    ::quic::WriteResult result = WritePacket(1200, 'x', ReceiverAddress());
+    EXPECT_EQ(result.status, ::quic::WRITE_STATUS_OK);
+    flushed_bytes += result.bytes_written;
+  }
+  EXPECT_EQ(flushed_bytes, 64u * 1200);
+  EXPECT_EQ(writer_->buffered_packets(), 0u);
+}
+
+}  // namespace test
+}  // namespace quic
+}  // namespace owt
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/udp_batch_reader.h"
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <string>
+#include <vector>
+#include "base/files/scoped_file.h"
+#include "impl/udp_batch_packet_writer.h"
+#include "impl/udp_server_socket_posix.h"
+#include "net/base/net_errors.h"
+#include "net/quic/platform/impl/quic_chromium_clock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace owt {
+namespace quic {
+namespace test {
+
+class PacketCollector : public UdpBatchReader::Visitor {
+ public:
+  void OnPacketRead(const ::quic::QuicReceivedPacket& packet,
+                    const ::quic::QuicSocketAddress& peer_address) override {
+    packets.emplace_back(packet.data(), packet.length());
+  }
+  std::vector<std::string> packets;
+};
+
+class UdpBatchReaderTest : public testing::Test {
+ public:
+  void SetUp() override {
+    ASSERT_EQ(socket_.Listen(0), net::OK);
+    sender_.reset(socket(AF_INET, SOCK_DGRAM, 0));
+    ASSERT_TRUE(sender_.is_valid());
+  }
+
+ protected:
+  void SendPackets(size_t count) {
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(socket_.local_address().port());
+    for (size_t i = 0; i < count; i++) {
+      std::string packet = "packet" + std::to_string(i);
+      ASSERT_EQ(sendto(sender_.get(), packet.data(), packet.size(), 0,
+                       reinterpret_cast<sockaddr*>(&address), sizeof(address)),
+                static_cast<ssize_t>(packet.size()));
+    }
+  }
+
+  UdpServerSocketPosix socket_;
+  base::ScopedFD sender_;
+  PacketCollector collector_;
+};
+
+TEST_F(UdpBatchReaderTest, ReadsUntilDrained) {
+  UdpBatchReader reader(2, false, ::quic::QuicChromiumClock::GetInstance());
+  SendPackets(5);
+  EXPECT_EQ(reader.ReadPackets(socket_.fd(), 32, &collector_),
+            net::ERR_IO_PENDING);
+  ASSERT_EQ(collector_.packets.size(), 5u);
+  EXPECT_EQ(collector_.packets[0], "packet0");
+  EXPECT_EQ(collector_.packets[4], "packet4");
+  EXPECT_EQ(reader.packets_read(), 5u);
+  EXPECT_EQ(reader.read_calls(), 3u);
+}
+
+TEST_F(UdpBatchReaderTest, StopsAtMaxPackets) {
+  UdpBatchReader reader(4, false, ::quic::QuicChromiumClock::GetInstance());
+  SendPackets(6);
+  EXPECT_EQ(reader.ReadPackets(socket_.fd(), 3, &collector_), net::OK);
+  EXPECT_EQ(collector_.packets.size(), 3u);
+  EXPECT_EQ(reader.ReadPackets(socket_.fd(), 3, &collector_), net::OK);
+  EXPECT_EQ(collector_.packets.size(), 6u);
+  EXPECT_EQ(reader.ReadPackets(socket_.fd(), 3, &collector_),
+            net::ERR_IO_PENDING);
+  EXPECT_EQ(collector_.packets[5], "packet5");
+}
+
+TEST_F(UdpBatchReaderTest, EmptySocket) {
+  UdpBatchReader reader(0, false, ::quic::QuicChromiumClock::GetInstance());
+  EXPECT_EQ(reader.batch_size(), 1u);
+  EXPECT_EQ(reader.ReadPackets(socket_.fd(), 32, &collector_),
+            net::ERR_IO_PENDING);
+  EXPECT_TRUE(collector_.packets.empty());
+}
+
+TEST_F(UdpBatchReaderTest, SplitsCoalescedDatagrams) {
+  if (socket_.EnableGro() != net::OK) {
+    GTEST_SKIP() << "UDP GRO is not supported.";
+  }
+  UdpServerSocketPosix sender;
+  ASSERT_EQ(sender.Listen(0), net::OK);
+  UdpBatchPacketWriter writer(sender.fd(), nullptr);
+  ::quic::QuicSocketAddress address(::quic::QuicIpAddress::Loopback4(),
+                                    socket_.local_address().port());
+  // Sent as one GSO message if supported, which is likely received as one
+  // coalesced datagram.
+  for (char fill = 'a'; fill < 'e'; fill++) {
+    std::string packet(fill == 'd' ? 500 : 1000, fill);
+    writer.WritePacket(packet.data(), packet.size(),
+                       ::quic::QuicIpAddress::Any6(), address, nullptr);
+  }
+  ASSERT_EQ(writer.Flush().status, ::quic::WRITE_STATUS_OK);
+
+  UdpBatchReader reader(4, true, ::quic::QuicChromiumClock::GetInstance());
+  EXPECT_EQ(reader.ReadPackets(socket_.fd(), 32, &collector_),
+            net::ERR_IO_PENDING);
+  ASSERT_EQ(collector_.packets.size(), 4u);
+  EXPECT_EQ(collector_.packets[0], std::string(1000, 'a'));
+  EXPECT_EQ(collector_.packets[2], std::string(1000, 'c'));
+  EXPECT_EQ(collector_.packets[3], std::string(500, 'd'));
+  EXPECT_EQ(reader.packets_read(), 4u);
+}
+
+}  // namespace test
+}  // namespace quic
+}  // namespace owt
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/udp_packet_writer.h"
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "base/bind.h"
+#include "base/check.h"
+#include "base/posix/eintr_wrapper.h"
+
+namespace owt {
+namespace quic {
+
+socklen_t ToDualStackSockaddr(const ::quic::QuicSocketAddress& address,
+                              sockaddr_storage* storage) {
+  ::quic::QuicSocketAddress dual_stack_address =
+      address.host().IsIPv4()
+          ? ::quic::QuicSocketAddress(address.host().DualStacked(),
+                                      address.port())
+          : address;
+  *storage = dual_stack_address.generic_address();
+  return sizeof(sockaddr_in6);
+}
+
+UdpPacketWriter::UdpPacketWriter(int fd, ::quic::QuicDispatcher* dispatcher)
+    : fd_(fd), dispatcher_(dispatcher), write_blocked_(false) {
+  CHECK_GE(fd_, 0);
+}
+
+UdpPacketWriter::~UdpPacketWriter() = default;
+
+::quic::WriteResult UdpPacketWriter::WritePacket(
+    const char* buffer,
+    size_t buf_len,
+    const ::quic::QuicIpAddress& self_address,
+    const ::quic::QuicSocketAddress& peer_address,
+    ::quic::PerPacketOptions* options) {
+  DCHECK(!write_blocked_);
+  sockaddr_storage address;
+  socklen_t address_length = ToDualStackSockaddr(peer_address, &address);
+  ssize_t result = HANDLE_EINTR(
+      sendto(fd_, buffer, buf_len, 0, reinterpret_cast<sockaddr*>(&address),
+             address_length));
+  if (result >= 0) {
+    return ::quic::WriteResult(::quic::WRITE_STATUS_OK, result);
+  }
+  if (errno == EAGAIN || errno == EWOULDBLOCK) {
+    OnWriteBlocked();
+    return ::quic::WriteResult(::quic::WRITE_STATUS_BLOCKED, errno);
+  }
+  return ::quic::WriteResult(errno == EMSGSIZE
+                                 ? ::quic::WRITE_STATUS_MSG_TOO_BIG
+                                 : ::quic::WRITE_STATUS_ERROR,
+                             errno);
+}
+
+bool UdpPacketWriter::IsWriteBlocked() const {
+  return write_blocked_;
+}
+
+void UdpPacketWriter::SetWritable() {
+  write_blocked_ = false;
+}
+
+absl::optional<int> UdpPacketWriter::MessageTooBigErrorCode() const {
+  return EMSGSIZE;
+}
+
+::quic::QuicByteCount UdpPacketWriter::GetMaxPacketSize(
+    const ::quic::QuicSocketAddress& peer_address) const {
+  return ::quic::kMaxOutgoingPacketSize;
+}
+
+bool UdpPacketWriter::SupportsReleaseTime() const {
+  return false;
+}
+
+bool UdpPacketWriter::IsBatchMode() const {
+  return false;
+}
+
+::quic::QuicPacketBuffer UdpPacketWriter::GetNextWriteLocation(
+    const ::quic::QuicIpAddress& self_address,
+    const ::quic::QuicSocketAddress& peer_address) {
+  return {nullptr, nullptr};
+}
+
+::quic::WriteResult UdpPacketWriter::Flush() {
+  return ::quic::WriteResult(::quic::WRITE_STATUS_OK, 0);
+}
+
+void UdpPacketWriter::OnWriteBlocked() {
+  write_blocked_ = true;
+  if (!write_watcher_) {
+    write_watcher_ = base::FileDescriptorWatcher::WatchWritable(
+        fd_, base::BindRepeating(&UdpPacketWriter::OnFdWritable,
+                                 base::Unretained(this)));
+  }
+}
+
+void UdpPacketWriter::OnFdWritable() {
+  write_watcher_.reset();
+  write_blocked_ = false;
+  if (dispatcher_) {
+    dispatcher_->OnCanWrite();
+  }
+}
+
+}  // namespace quic
+}  // namespace owt
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_QUIC_WEB_TRANSPORT_UDP_PACKET_WRITER_H_
+#define OWT_QUIC_WEB_TRANSPORT_UDP_PACKET_WRITER_H_
+
+#include <memory>
+#include "base/files/file_descriptor_watcher_posix.h"
+#include "net/third_party/quiche/src/quic/core/quic_dispatcher.h"
+#include "net/third_party/quiche/src/quic/core/quic_packet_writer.h"
+
+namespace owt {
+namespace quic {
+
+// Writes packets to a non-blocking UDP socket with one sendto per packet. When
+// the socket is write blocked, it waits for the socket to become writable and
+// notifies `dispatcher`, like net::QuicSimpleServerPacketWriter does. POSIX
+// only.
+class UdpPacketWriter : public ::quic::QuicPacketWriter {
+ public:
+  // `fd` and `dispatcher` must outlive this writer. `dispatcher` is notified
+  // when a blocked socket becomes writable, it can be null in tests.
+  UdpPacketWriter(int fd, ::quic::QuicDispatcher* dispatcher);
+  ~UdpPacketWriter() override;
+  UdpPacketWriter(const UdpPacketWriter&) = delete;
+  UdpPacketWriter& operator=(const UdpPacketWriter&) = delete;
+
+  // Overrides ::quic::QuicPacketWriter.
+  ::quic::WriteResult WritePacket(const char* buffer,
+                                  size_t buf_len,
+                                  const ::quic::QuicIpAddress& self_address,
+                                  const ::quic::QuicSocketAddress& peer_address,
+                                  ::quic::PerPacketOptions* options) override;
+  bool IsWriteBlocked() const override;
+  void SetWritable() override;
+  absl::optional<int> MessageTooBigErrorCode() const override;
+  ::quic::QuicByteCount GetMaxPacketSize(
+      const ::quic::QuicSocketAddress& peer_address) const override;
+  bool SupportsReleaseTime() const override;
+  bool IsBatchMode() const override;
+  ::quic::QuicPacketBuffer GetNextWriteLocation(
+      const ::quic::QuicIpAddress& self_address,
+      const ::quic::QuicSocketAddress& peer_address) override;
+  ::quic::WriteResult Flush() override;
+
+ protected:
+  int fd() const { return fd_; }
+  // Marks the writer as blocked and waits for `fd_` to become writable.
+  void OnWriteBlocked();
+
+ private:
+  void OnFdWritable();
+
+  int fd_;
+  ::quic::QuicDispatcher* dispatcher_;
+  bool write_blocked_;
+  std::unique_ptr<base::FileDescriptorWatcher::Controller> write_watcher_;
+};
+
+// Converts `address` to a sockaddr for a dual stack IPv6 socket. IPv4
+// addresses are mapped to IPv6. Returns length of `storage` used.
+socklen_t ToDualStackSockaddr(const ::quic::QuicSocketAddress& address,
+                              sockaddr_storage* storage);
+
+}  // namespace quic
+}  // namespace owt
+
+#endif
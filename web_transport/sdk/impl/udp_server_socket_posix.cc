@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/udp_server_socket_posix.h"
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <utility>
+#include "base/logging.h"
+#include "net/base/net_errors.h"
+#include "net/third_party/quiche/src/quic/core/quic_constants.h"
+
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+namespace owt {
+namespace quic {
+
+UdpServerSocketPosix::UdpServerSocketPosix()
+    : reuse_port_(false),
+      receive_buffer_size_(::quic::kDefaultSocketReceiveBuffer),
+      send_buffer_size_(::quic::kDefaultSocketReceiveBuffer) {}
+
+UdpServerSocketPosix::~UdpServerSocketPosix() = default;
+
+void UdpServerSocketPosix::AllowReusePort() {
+  DCHECK(!fd_.is_valid());
+  reuse_port_ = true;
+}
+
+void UdpServerSocketPosix::SetBufferSizes(int receive_buffer_size,
+                                          int send_buffer_size) {
+  DCHECK(!fd_.is_valid());
+  if (receive_buffer_size > 0) {
+    receive_buffer_size_ = receive_buffer_size;
+  }
+  if (send_buffer_size > 0) {
+    send_buffer_size_ = send_buffer_size;
+  }
+}
+
+int UdpServerSocketPosix::Listen(uint16_t port) {
+  DCHECK(!fd_.is_valid());
+  base::ScopedFD fd(socket(AF_INET6, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                           IPPROTO_UDP));
+  if (!fd.is_valid()) {
+    PLOG(ERROR) << "socket() failed";
+    return net::MapSystemError(errno);
+  }
+  int off = 0;
+  if (setsockopt(fd.get(), IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off)) !=
+      0) {
+    PLOG(ERROR) << "Failed to enable dual stack";
+    return net::MapSystemError(errno);
+  }
+  int on = 1;
+  if (setsockopt(fd.get(), SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0) {
+    PLOG(ERROR) << "Failed to set SO_REUSEADDR";
+    return net::MapSystemError(errno);
+  }
+  if (reuse_port_ &&
+      setsockopt(fd.get(), SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) != 0) {
+    PLOG(ERROR) << "Failed to set SO_REUSEPORT";
+    return net::MapSystemError(errno);
+  }
+  // Default receive buffer size is the same as
+  // net::CreateQuicSimpleServerSocket. Default send buffer is larger, so a
+  // batch written by UdpBatchPacketWriter fits.
+  int receive_buffer_size = receive_buffer_size_;
+  if (setsockopt(fd.get(), SOL_SOCKET, SO_RCVBUF, &receive_buffer_size,
+                 sizeof(receive_buffer_size)) != 0) {
+    PLOG(WARNING) << "Failed to set receive buffer size";
+  }
+  int send_buffer_size = send_buffer_size_;
+  if (setsockopt(fd.get(), SOL_SOCKET, SO_SNDBUF, &send_buffer_size,
+                 sizeof(send_buffer_size)) != 0) {
+    PLOG(WARNING) << "Failed to set send buffer size";
+  }
+
+  sockaddr_in6 address = {};
+  address.sin6_family = AF_INET6;
+  address.sin6_addr = in6addr_any;
+  address.sin6_port = htons(port);
+  if (bind(fd.get(), reinterpret_cast<sockaddr*>(&address), sizeof(address)) !=
+      0) {
+    PLOG(ERROR) << "bind() failed";
+    return net::MapSystemError(errno);
+  }
+  sockaddr_storage local_address = {};
+  socklen_t local_address_length = sizeof(local_address);
+  if (getsockname(fd.get(), reinterpret_cast<sockaddr*>(&local_address),
+                  &local_address_length) != 0) {
+    PLOG(ERROR) << "getsockname() failed";
+    return net::MapSystemError(errno);
+  }
+  local_address_ = ::quic::QuicSocketAddress(local_address);
+  fd_ = std::move(fd);
+  return net::OK;
+}
+
+int UdpServerSocketPosix::EnableGro() {
+  DCHECK(fd_.is_valid());
+  int on = 1;
+  if (setsockopt(fd_.get(), SOL_UDP, UDP_GRO, &on, sizeof(on)) != 0) {
+    PLOG(WARNING) << "Failed to enable UDP GRO";
+    return net::MapSystemError(errno);
+  }
+  return net::OK;
+}
+
+}  // namespace quic
+}  // namespace owt
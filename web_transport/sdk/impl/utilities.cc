@@ -5,9 +5,74 @@
  */
 
 #include "owt/web_transport/sdk/impl/utilities.h"
+#include <cstring>
+#include "base/check.h"
+#include "base/logging.h"
+#include "base/notreached.h"
+#include "impl/congestion_controller_adapter.h"
+#include "net/third_party/quiche/src/quic/core/crypto/crypto_protocol.h"
+#include "net/third_party/quiche/src/quic/core/quic_config.h"
+#include "net/third_party/quiche/src/quic/core/quic_buffer_allocator.h"
+#include "net/third_party/quiche/src/quic/core/quic_connection.h"
+#include "net/third_party/quiche/src/quic/core/quic_sent_packet_manager.h"
+#include "net/third_party/quiche/src/quic/core/quic_simple_buffer_allocator.h"
 
 namespace owt {
 namespace quic {
+
+namespace {
+// A QuicBufferAllocator for a single buffer lent by the application. Nothing is
+// allocated by it. When quiche deletes the buffer, it notifies the releaser
+// and deletes itself.
+class LentBufferAllocator : public ::quic::QuicBufferAllocator {
+ public:
+  LentBufferAllocator(size_t length, BufferReleaser* releaser)
+      : length_(length), releaser_(releaser) {
+    CHECK(releaser_);
+  }
+  ~LentBufferAllocator() override = default;
+
+  char* New(size_t size) override {
+    NOTREACHED();
+    return nullptr;
+  }
+  char* New(size_t size, bool flag_enable) override {
+    NOTREACHED();
+    return nullptr;
+  }
+  void Delete(char* buffer) override {
+    releaser_->Release(reinterpret_cast<const uint8_t*>(buffer), length_);
+    delete this;
+  }
+
+ private:
+  size_t length_;
+  BufferReleaser* releaser_;
+};
+
+::quic::SimpleBufferAllocator* GetSimpleBufferAllocator() {
+  static ::quic::SimpleBufferAllocator* allocator =
+      new ::quic::SimpleBufferAllocator();
+  return allocator;
+}
+
+// Returns the connection option for the largest initial congestion window
+// supported by QUIC that doesn't exceed `packets`, or 3 packets if `packets` is
+// smaller than that.
+::quic::QuicTag InitialCongestionWindowOption(uint32_t packets) {
+  if (packets >= 50) {
+    return ::quic::kIW50;
+  }
+  if (packets >= 20) {
+    return ::quic::kIW20;
+  }
+  if (packets >= 10) {
+    return ::quic::kIW10;
+  }
+  return ::quic::kIW03;
+}
+}  // namespace
+
 MessageStatus Utilities::ConvertMessageStatus(
     absl::optional<::quic::MessageStatus> status) {
   if (!status) {
@@ -30,5 +95,153 @@ MessageStatus Utilities::ConvertMessageStatus(
       return MessageStatus::kUnavailable;
   }
 }
+
+::quic::QuicMemSlice Utilities::CopyToMemSlice(const DataSpan* spans,
+                                               size_t span_count) {
+  size_t length = 0;
+  for (size_t i = 0; i < span_count; i++) {
+    length += spans[i].length;
+  }
+  ::quic::QuicBuffer buffer(GetSimpleBufferAllocator(), length);
+  size_t offset = 0;
+  for (size_t i = 0; i < span_count; i++) {
+    if (spans[i].length == 0) {
+      continue;
+    }
+    memcpy(buffer.data() + offset, spans[i].data, spans[i].length);
+    offset += spans[i].length;
+  }
+  return ::quic::QuicMemSlice(std::move(buffer));
+}
+
+::quic::QuicMemSlice Utilities::WrapAsMemSlice(const uint8_t* data,
+                                               size_t length,
+                                               BufferReleaser* releaser) {
+  DCHECK_GT(length, 0u);
+  ::quic::QuicUniqueBufferPtr buffer(
+      const_cast<char*>(reinterpret_cast<const char*>(data)),
+      ::quic::QuicBufferDeleter(new LentBufferAllocator(length, releaser)));
+  return ::quic::QuicMemSlice(::quic::QuicBuffer(std::move(buffer), length));
+}
+
+::quic::CongestionControlType Utilities::ConvertCongestionControlAlgorithm(
+    CongestionControlAlgorithm algorithm) {
+  switch (algorithm) {
+    case CongestionControlAlgorithm::kCubic:
+      return ::quic::kCubicBytes;
+    case CongestionControlAlgorithm::kReno:
+      return ::quic::kRenoBytes;
+    case CongestionControlAlgorithm::kBbrV2:
+      return ::quic::kBBRv2;
+    case CongestionControlAlgorithm::kDefault:
+    case CongestionControlAlgorithm::kBbr:
+      return ::quic::kBBR;
+  }
+  NOTREACHED();
+  return ::quic::kBBR;
+}
+
+void Utilities::ApplyCongestionControl(::quic::QuicConnection* connection,
+                                       CongestionControlAlgorithm algorithm,
+                                       uint32_t initial_congestion_window) {
+  DCHECK(connection);
+  ::quic::QuicSentPacketManager& sent_packet_manager =
+      connection->sent_packet_manager();
+  if (algorithm != CongestionControlAlgorithm::kDefault) {
+    sent_packet_manager.SetSendAlgorithm(
+        ConvertCongestionControlAlgorithm(algorithm));
+  }
+  if (initial_congestion_window > 0 &&
+      sent_packet_manager.GetLargestSentPacket().IsInitialized()) {
+    // Applying it to a live connection would reset its congestion window.
+    LOG(WARNING) << "Initial congestion window is ignored after packets are "
+                    "sent.";
+  } else if (initial_congestion_window > 0) {
+    // Initial window is set by connection options, as if they were negotiated.
+    // Other settings of the connection are not affected by an empty config.
+    ::quic::QuicConfig config;
+    ::quic::QuicTagVector options{
+        InitialCongestionWindowOption(initial_congestion_window)};
+    if (connection->perspective() == ::quic::Perspective::IS_SERVER) {
+      config.SetInitialReceivedConnectionOptions(options);
+    } else {
+      config.SetClientConnectionOptions(options);
+    }
+    sent_packet_manager.SetFromConfig(config);
+  }
+}
+
+void Utilities::ApplyServerOptions(const ServerOptions& options,
+                                   ::quic::QuicConfig* config) {
+  DCHECK(config);
+  if (options.initial_session_flow_control_window > 0) {
+    config->SetInitialSessionFlowControlWindowToSend(
+        options.initial_session_flow_control_window);
+  }
+  if (options.initial_stream_flow_control_window > 0) {
+    config->SetInitialStreamFlowControlWindowToSend(
+        options.initial_stream_flow_control_window);
+  }
+  if (options.max_incoming_bidirectional_streams > 0) {
+    config->SetMaxBidirectionalStreamsToSend(
+        options.max_incoming_bidirectional_streams);
+  }
+  if (options.max_incoming_unidirectional_streams > 0) {
+    config->SetMaxUnidirectionalStreamsToSend(
+        options.max_incoming_unidirectional_streams);
+  }
+  if (options.idle_timeout_ms > 0) {
+    config->SetIdleNetworkTimeout(
+        ::quic::QuicTime::Delta::FromMilliseconds(options.idle_timeout_ms));
+  }
+}
+
+void Utilities::InstallCongestionController(
+    ::quic::QuicConnection* connection,
+    std::unique_ptr<CongestionControllerInterface> controller) {
+  DCHECK(connection);
+  DCHECK(controller);
+  ::quic::QuicSentPacketManager& sent_packet_manager =
+      connection->sent_packet_manager();
+  sent_packet_manager.SetSendAlgorithm(new CongestionControllerAdapter(
+      std::move(controller), sent_packet_manager.GetRttStats()));
+}
+
+void Utilities::FillConnectionStats(::quic::QuicSession* session,
+                                    ConnectionStats* stats) {
+  DCHECK(stats);
+  *stats = ConnectionStats();
+  if (!session || !session->connection()) {
+    return;
+  }
+  // GetStats is non-const, since it refreshes RTT and bandwidth estimates.
+  ::quic::QuicConnection* connection = session->connection();
+  const ::quic::QuicConnectionStats& connection_stats =
+      connection->GetStats();
+  const ::quic::QuicSentPacketManager& sent_packet_manager =
+      connection->sent_packet_manager();
+  const ::quic::RttStats* rtt_stats = sent_packet_manager.GetRttStats();
+  stats->estimated_bandwidth =
+      connection_stats.estimated_bandwidth.ToBitsPerSecond();
+  stats->smoothed_rtt_us = rtt_stats->smoothed_rtt().ToMicroseconds();
+  stats->min_rtt_us = rtt_stats->min_rtt().ToMicroseconds();
+  stats->latest_rtt_us = rtt_stats->latest_rtt().ToMicroseconds();
+  stats->congestion_window = sent_packet_manager.GetCongestionWindowInBytes();
+  stats->bytes_in_flight = sent_packet_manager.GetBytesInFlight();
+  stats->pacing_rate =
+      sent_packet_manager.GetSendAlgorithm()
+          ->PacingRate(sent_packet_manager.GetBytesInFlight())
+          .ToBitsPerSecond();
+  stats->bytes_sent = connection_stats.bytes_sent;
+  stats->packets_sent = connection_stats.packets_sent;
+  stats->bytes_received = connection_stats.bytes_received;
+  stats->packets_received = connection_stats.packets_received;
+  stats->packets_lost = connection_stats.packets_lost;
+  stats->bytes_retransmitted = connection_stats.bytes_retransmitted;
+  stats->packets_retransmitted = connection_stats.packets_retransmitted;
+  stats->pto_count = connection_stats.pto_count;
+  stats->queued_datagrams = session->datagram_queue()->queue_size();
+}
+
 }  // namespace quic
-}  // namespace owt
\ No newline at end of file
+}  // namespace owt
@@ -7,7 +7,12 @@
 #ifndef OWT_WEB_TRANSPORT_UTILITIES_H_
 #define OWT_WEB_TRANSPORT_UTILITIES_H_
 
+#include <memory>
+#include "net/third_party/quiche/src/quic/core/quic_config.h"
+#include "net/third_party/quiche/src/quic/core/quic_mem_slice.h"
+#include "net/third_party/quiche/src/quic/core/quic_session.h"
 #include "net/third_party/quiche/src/quic/core/quic_types.h"
+#include "owt/quic/congestion_controller_interface.h"
 #include "owt/quic/web_transport_definitions.h"
 
 namespace owt {
@@ -16,6 +21,38 @@ class Utilities {
  public:
   static MessageStatus ConvertMessageStatus(
       absl::optional<::quic::MessageStatus> status);
+  // Copies data in `spans` to a single QuicMemSlice.
+  static ::quic::QuicMemSlice CopyToMemSlice(const DataSpan* spans,
+                                             size_t span_count);
+  // Wraps `data` as a QuicMemSlice without copying. `releaser` is notified when
+  // the slice is released by quiche. `length` must not be 0.
+  static ::quic::QuicMemSlice WrapAsMemSlice(const uint8_t* data,
+                                             size_t length,
+                                             BufferReleaser* releaser);
+  static ::quic::CongestionControlType ConvertCongestionControlAlgorithm(
+      CongestionControlAlgorithm algorithm);
+  // Applies congestion control settings to `connection`. kDefault doesn't
+  // change algorithm, `initial_congestion_window` 0 doesn't change initial
+  // window. Initial window is rounded down to 3, 10, 20 or 50 packets, which
+  // are supported by QUIC connection options. It's ignored once `connection`
+  // has sent any packet. Must be called on IO thread.
+  static void ApplyCongestionControl(::quic::QuicConnection* connection,
+                                     CongestionControlAlgorithm algorithm,
+                                     uint32_t initial_congestion_window);
+  // Replaces send algorithm of `connection` with `controller`. Ownership of
+  // `controller` is moved to `connection`. Must be called on IO thread.
+  static void InstallCongestionController(
+      ::quic::QuicConnection* connection,
+      std::unique_ptr<CongestionControllerInterface> controller);
+  // Applies flow control, stream limit and idle timeout options to `config`.
+  // Options set to 0 don't change `config`.
+  static void ApplyServerOptions(const ServerOptions& options,
+                                 ::quic::QuicConfig* config);
+  // Fills `stats` with stats of `session`'s connection. stream_buffered_bytes
+  // is set to 0 since streams are tracked by callers. Must be called on IO
+  // thread.
+  static void FillConnectionStats(::quic::QuicSession* session,
+                                  ConnectionStats* stats);
 };
 }  // namespace quic
 }  // namespace owt
@@ -6,15 +6,20 @@
 
 #include "owt/quic/logging.h"
 #include "impl/web_transport_factory_impl.h"
+#include <algorithm>
 #include "base/at_exit.h"
 #include "base/bind.h"
 #include "base/command_line.h"
 #include "base/logging.h"
+#include "base/strings/string_util.h"
 #include "base/task/thread_pool/thread_pool_instance.h"
 #include "base/threading/thread.h"
 #include "impl/proof_source_owt.h"
+#include "impl/session_ticket_crypter.h"
+#include "impl/shared_session_cache.h"
 #include "impl/web_transport_owt_client_impl.h"
 #include "impl/web_transport_owt_server_impl.h"
+#include "impl/web_transport_sharded_server.h"
 #include "net/quic/crypto/proof_source_chromium.h"
 #include "net/quic/platform/impl/quic_chromium_clock.h"
 #include "net/quic/quic_chromium_alarm_factory.h"
@@ -22,10 +27,73 @@
 #include "net/third_party/quiche/src/quic/core/crypto/proof_source.h"
 #include "net/third_party/quiche/src/quic/core/crypto/quic_crypto_server_config.h"
 #include "net/third_party/quiche/src/quic/core/quic_types.h"
+#include "net/third_party/quiche/src/quic/quic_transport/web_transport_fingerprint_proof_verifier.h"
 
 namespace owt {
 namespace quic {
 
+namespace {
+constexpr base::TimeDelta kSessionTicketKeyRotationInterval = base::Hours(12);
+
+// `ticket_keys` is nullptr if session tickets are disabled.
+std::unique_ptr<::quic::ProofSource> CreateProofSource(
+    const char* cert_path,
+    const char* key_path,
+    scoped_refptr<SessionTicketKeys> ticket_keys) {
+  auto proof_source = std::make_unique<net::ProofSourceChromium>();
+  if (!proof_source->Initialize(base::FilePath::FromUTF8Unsafe(cert_path),
+                                base::FilePath::FromUTF8Unsafe(key_path),
+                                base::FilePath())) {
+    LOG(ERROR) << "Failed to initialize proof source.";
+    return nullptr;
+  }
+  if (ticket_keys) {
+    proof_source->SetTicketCrypter(
+        std::make_unique<SessionTicketCrypter>(std::move(ticket_keys)));
+  }
+  return proof_source;
+}
+
+std::unique_ptr<::quic::ProofSource> CreateProofSource(
+    const char* pfx_path,
+    const char* password,
+    scoped_refptr<SessionTicketKeys> ticket_keys) {
+  auto proof_source = std::make_unique<ProofSourceOwt>();
+  if (!proof_source->Initialize(base::FilePath::FromUTF8Unsafe(pfx_path),
+                                std::string(password))) {
+    LOG(ERROR) << "Failed to initialize proof source.";
+    return nullptr;
+  }
+  if (ticket_keys) {
+    proof_source->SetTicketCrypter(
+        std::make_unique<SessionTicketCrypter>(std::move(ticket_keys)));
+  }
+  return proof_source;
+}
+
+// Keys are shared by all shards of a server, so a client resumes its session
+// no matter which shard receives its packets. Returns false if the key file is
+// invalid.
+bool CreateSessionTicketKeys(const ServerOptions& options,
+                             scoped_refptr<SessionTicketKeys>* ticket_keys) {
+  if (!options.session_tickets_enabled) {
+    return true;
+  }
+  if (!options.session_ticket_key_file) {
+    *ticket_keys =
+        SessionTicketKeys::CreateRandom(kSessionTicketKeyRotationInterval);
+    return true;
+  }
+  *ticket_keys = SessionTicketKeys::CreateFromFile(
+      base::FilePath::FromUTF8Unsafe(options.session_ticket_key_file));
+  if (!*ticket_keys) {
+    LOG(ERROR) << "Failed to load session ticket keys.";
+    return false;
+  }
+  return true;
+}
+}  // namespace
+
 WebTransportFactory* WebTransportFactory::Create() {
   base::ThreadPoolInstance::CreateAndStartWithDefaultParams("web_transport_thread_pool");
   WebTransportFactoryImpl* factory = new WebTransportFactoryImpl();
@@ -60,27 +128,82 @@ WebTransportServerInterface* WebTransportFactoryImpl::CreateWebTransportServer(
     const char* cert_path,
     const char* key_path,
     const char* secret_path) {
-  auto proof_source = std::make_unique<net::ProofSourceChromium>();
-  if (!proof_source->Initialize(base::FilePath::FromUTF8Unsafe(cert_path),
-                                base::FilePath::FromUTF8Unsafe(key_path),
-                                base::FilePath())) {
-    LOG(ERROR) << "Failed to initialize proof source.";
+  return CreateWebTransportServer(port, cert_path, key_path, secret_path,
+                                  ServerOptions());
+}
+
+WebTransportServerInterface* WebTransportFactoryImpl::CreateWebTransportServer(
+    int port,
+    const char* pfx_path,
+    const char* password) {
+  return CreateWebTransportServer(port, pfx_path, password, ServerOptions());
+}
+
+WebTransportServerInterface* WebTransportFactoryImpl::CreateWebTransportServer(
+    int port,
+    const char* cert_path,
+    const char* key_path,
+    const char* secret_path,
+    const ServerOptions& options) {
+  scoped_refptr<SessionTicketKeys> ticket_keys;
+  if (!CreateSessionTicketKeys(options, &ticket_keys)) {
     return nullptr;
   }
-  return CreateWebTransportServerOnIOThread(port, std::move(proof_source));
+  std::vector<std::unique_ptr<::quic::ProofSource>> proof_sources;
+  for (size_t i = 0; i < std::max<size_t>(options.io_thread_count, 1); i++) {
+    auto proof_source = CreateProofSource(cert_path, key_path, ticket_keys);
+    if (!proof_source) {
+      return nullptr;
+    }
+    proof_sources.push_back(std::move(proof_source));
+  }
+  return CreateShardedWebTransportServer(port, std::move(proof_sources),
+                                         options);
 }
 
 WebTransportServerInterface* WebTransportFactoryImpl::CreateWebTransportServer(
     int port,
     const char* pfx_path,
-    const char* password) {
-  auto proof_source = std::make_unique<ProofSourceOwt>();
-  if (!proof_source->Initialize(base::FilePath::FromUTF8Unsafe(pfx_path),
-                                std::string(password))) {
-    LOG(ERROR) << "Failed to initialize proof source.";
+    const char* password,
+    const ServerOptions& options) {
+  scoped_refptr<SessionTicketKeys> ticket_keys;
+  if (!CreateSessionTicketKeys(options, &ticket_keys)) {
     return nullptr;
   }
-  return CreateWebTransportServerOnIOThread(port, std::move(proof_source));
+  std::vector<std::unique_ptr<::quic::ProofSource>> proof_sources;
+  for (size_t i = 0; i < std::max<size_t>(options.io_thread_count, 1); i++) {
+    auto proof_source = CreateProofSource(pfx_path, password, ticket_keys);
+    if (!proof_source) {
+      return nullptr;
+    }
+    proof_sources.push_back(std::move(proof_source));
+  }
+  return CreateShardedWebTransportServer(port, std::move(proof_sources),
+                                         options);
+}
+
+WebTransportServerInterface*
+WebTransportFactoryImpl::CreateShardedWebTransportServer(
+    int port,
+    size_t io_thread_count,
+    const char* cert_path,
+    const char* key_path,
+    const char* secret_path) {
+  ServerOptions options;
+  options.io_thread_count = io_thread_count;
+  return CreateWebTransportServer(port, cert_path, key_path, secret_path,
+                                  options);
+}
+
+WebTransportServerInterface*
+WebTransportFactoryImpl::CreateShardedWebTransportServer(
+    int port,
+    size_t io_thread_count,
+    const char* pfx_path,
+    const char* password) {
+  ServerOptions options;
+  options.io_thread_count = io_thread_count;
+  return CreateWebTransportServer(port, pfx_path, password, options);
 }
 
 WebTransportClientInterface*
@@ -111,23 +234,52 @@ WebTransportFactoryImpl::CreateWebTransportClient(
       FROM_HERE,
       base::BindOnce(
           [](const char* url, const net::WebTransportParameters& param,
+             CongestionControlAlgorithm congestion_control,
+             uint32_t initial_congestion_window,
+             CongestionControllerFactoryInterface* controller_factory,
+             scoped_refptr<SharedSessionCache> session_cache,
              base::Thread* io_thread, base::Thread* event_thread,
              WebTransportClientInterface** result,
              base::WaitableEvent* event) {
             url::Origin origin = url::Origin::Create(GURL(url));
-            WebTransportClientInterface* client =
+            WebTransportOwtClientImpl* client =
                 new WebTransportOwtClientImpl(GURL(std::string(url)), origin,
                                                param, io_thread, event_thread);
+            client->SetCongestionControl(congestion_control,
+                                         initial_congestion_window);
+            client->SetCongestionControllerFactory(controller_factory);
+            client->SetSessionCache(std::move(session_cache));
             *result = client;
             event->Signal();
           },
-          base::Unretained(url), param, base::Unretained(io_thread_.get()),
+          base::Unretained(url), param, parameters.congestion_control,
+          parameters.initial_congestion_window,
+          base::Unretained(parameters.congestion_controller_factory),
+          SessionCacheForFingerprints(param.server_certificate_fingerprints),
+          base::Unretained(io_thread_.get()),
           base::Unretained(event_thread_.get()), base::Unretained(&result),
           base::Unretained(&done)));
   done.Wait();
   return result;
 }
 
+scoped_refptr<SharedSessionCache>
+WebTransportFactoryImpl::SessionCacheForFingerprints(
+    const std::vector<::quic::CertificateFingerprint>& fingerprints) {
+  std::vector<std::string> values;
+  for (const auto& fingerprint : fingerprints) {
+    values.push_back(fingerprint.algorithm + ":" + fingerprint.fingerprint);
+  }
+  std::sort(values.begin(), values.end());
+  const std::string key = base::JoinString(values, ",");
+  base::AutoLock lock(session_caches_lock_);
+  scoped_refptr<SharedSessionCache>& session_cache = session_caches_[key];
+  if (!session_cache) {
+    session_cache = base::MakeRefCounted<SharedSessionCache>();
+  }
+  return session_cache;
+}
+
 void WebTransportFactoryImpl::Init() {
   base::CommandLine::Init(0, nullptr);
   base::CommandLine* command_line(base::CommandLine::ForCurrentProcess());
@@ -138,7 +290,8 @@ void WebTransportFactoryImpl::Init() {
 WebTransportServerInterface*
 WebTransportFactoryImpl::CreateWebTransportServerOnIOThread(
     int port,
-    std::unique_ptr<::quic::ProofSource> proof_source) {
+    std::unique_ptr<::quic::ProofSource> proof_source,
+    const ServerOptions& options) {
   WebTransportServerInterface* result(nullptr);
   base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
                            base::WaitableEvent::InitialState::NOT_SIGNALED);
@@ -146,19 +299,39 @@ WebTransportFactoryImpl::CreateWebTransportServerOnIOThread(
       FROM_HERE,
       base::BindOnce(
           [](int port, std::unique_ptr<::quic::ProofSource> proof_source,
-             base::Thread* io_thread, base::Thread* event_thread,
-             WebTransportServerInterface** result, base::WaitableEvent* event) {
+             const ServerOptions& options, base::Thread* io_thread,
+             base::Thread* event_thread, WebTransportServerInterface** result,
+             base::WaitableEvent* event) {
             *result = new WebTransportOwtServerImpl(
                 port, std::vector<url::Origin>(), std::move(proof_source),
-                io_thread, event_thread);
+                options, io_thread, event_thread);
             event->Signal();
           },
-          port, std::move(proof_source), base::Unretained(io_thread_.get()),
+          port, std::move(proof_source), options,
+          base::Unretained(io_thread_.get()),
           base::Unretained(event_thread_.get()), base::Unretained(&result),
           base::Unretained(&done)));
   done.Wait();
   return result;
 }
 
+WebTransportServerInterface*
+WebTransportFactoryImpl::CreateShardedWebTransportServer(
+    int port,
+    std::vector<std::unique_ptr<::quic::ProofSource>> proof_sources,
+    const ServerOptions& options) {
+#ifdef OWT_QUIC_USE_RECVMMSG
+  if (proof_sources.size() > 1) {
+    return new WebTransportShardedServer(port, std::move(proof_sources),
+                                         options, event_thread_.get());
+  }
+#else
+  LOG_IF(WARNING, proof_sources.size() > 1)
+      << "Sharded server is not supported on this platform.";
+#endif
+  return CreateWebTransportServerOnIOThread(port, std::move(proof_sources[0]),
+                                            options);
+}
+
 }  // namespace quic
 }  // namespace owt
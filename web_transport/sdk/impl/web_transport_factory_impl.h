@@ -7,9 +7,13 @@
 #ifndef OWT_WEB_TRANSPORT_WEB_TRANSPORT_FACTORY_IMPL_H_
 #define OWT_WEB_TRANSPORT_WEB_TRANSPORT_FACTORY_IMPL_H_
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
+#include "base/memory/scoped_refptr.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
 #include "owt/quic/export.h"
 #include "owt/quic/web_transport_factory.h"
 
@@ -21,6 +25,7 @@ class QuicRandom;
 class QuicCompressedCertsCache;
 class QuicCryptoServerConfig;
 class ProofSource;
+struct CertificateFingerprint;
 }  // namespace quic
 
 namespace base {
@@ -31,6 +36,12 @@ class AtExitManager;
 namespace owt {
 namespace quic {
 
+class SharedSessionCache;
+
+namespace test {
+class WebTransportFactoryImplTest;
+}  // namespace test
+
 class OWT_EXPORT WebTransportFactoryImpl : public WebTransportFactory {
  public:
   WebTransportFactoryImpl();
@@ -46,6 +57,28 @@ class OWT_EXPORT WebTransportFactoryImpl : public WebTransportFactory {
       int port,
       const char* pfx_path,
       const char* password) override;
+  WebTransportServerInterface* CreateWebTransportServer(
+      int port,
+      const char* cert_path,
+      const char* key_path,
+      const char* secret_path,
+      const ServerOptions& options) override;
+  WebTransportServerInterface* CreateWebTransportServer(
+      int port,
+      const char* pfx_path,
+      const char* password,
+      const ServerOptions& options) override;
+  WebTransportServerInterface* CreateShardedWebTransportServer(
+      int port,
+      size_t io_thread_count,
+      const char* cert_path,
+      const char* key_path,
+      const char* secret_path) override;
+  WebTransportServerInterface* CreateShardedWebTransportServer(
+      int port,
+      size_t io_thread_count,
+      const char* pfx_path,
+      const char* password) override;
   WebTransportClientInterface* CreateWebTransportClient(
       const char* url) override;
   WebTransportClientInterface* CreateWebTransportClient(
@@ -53,15 +86,33 @@ class OWT_EXPORT WebTransportFactoryImpl : public WebTransportFactory {
       const WebTransportClientInterface::Parameters& parameters) override;
 
  private:
+  friend class test::WebTransportFactoryImplTest;
+
   void Init();
 
   WebTransportServerInterface* CreateWebTransportServerOnIOThread(
       int port,
-      std::unique_ptr<::quic::ProofSource> proof_source);
+      std::unique_ptr<::quic::ProofSource> proof_source,
+      const ServerOptions& options);
+  WebTransportServerInterface* CreateShardedWebTransportServer(
+      int port,
+      std::vector<std::unique_ptr<::quic::ProofSource>> proof_sources,
+      const ServerOptions& options);
+  // Returns the session cache of clients verifying servers with
+  // `fingerprints`, or with the default verifier if it's empty.
+  scoped_refptr<SharedSessionCache> SessionCacheForFingerprints(
+      const std::vector<::quic::CertificateFingerprint>& fingerprints);
 
   std::unique_ptr<base::AtExitManager> at_exit_manager_;
   std::unique_ptr<base::Thread> io_thread_;
   std::unique_ptr<base::Thread> event_thread_;
+  // Shared by clients created by this factory with the same certificate
+  // fingerprints, so reconnecting to a server resumes the previous session.
+  // A session is only resumed by clients trusting the server the same way as
+  // the client establishing it. Key is the sorted fingerprints.
+  base::Lock session_caches_lock_;
+  std::map<std::string, scoped_refptr<SharedSessionCache>> session_caches_
+      GUARDED_BY(session_caches_lock_);
 };
 
 }  // namespace quic
@@ -6,13 +6,69 @@
 
 #include "owt/quic/web_transport_factory.h"
 #include "owt/web_transport/sdk/impl/web_transport_factory_impl.h"
+#include <memory>
+#include <string>
+#include <vector>
 #include "base/logging.h"
+#include "impl/shared_session_cache.h"
+#include "net/third_party/quiche/src/quic/quic_transport/web_transport_fingerprint_proof_verifier.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace owt {
 namespace quic {
 namespace test {
 
+class WebTransportFactoryImplTest : public testing::Test {
+ public:
+  WebTransportFactoryImplTest()
+      : factory_(std::make_unique<WebTransportFactoryImpl>()) {}
+
+ protected:
+  // Session caches are keyed by fingerprints as they are, so they don't need to
+  // be valid SHA-256 values here.
+  static ::quic::CertificateFingerprint Fingerprint(char value) {
+    ::quic::CertificateFingerprint fingerprint;
+    fingerprint.algorithm = ::quic::CertificateFingerprint::kSha256;
+    fingerprint.fingerprint = std::string(2, value);
+    return fingerprint;
+  }
+
+  scoped_refptr<SharedSessionCache> SessionCache(
+      const std::vector<::quic::CertificateFingerprint>& fingerprints) {
+    return factory_->SessionCacheForFingerprints(fingerprints);
+  }
+
+  std::unique_ptr<WebTransportFactoryImpl> factory_;
+};
+
+TEST_F(WebTransportFactoryImplTest, SameFingerprintsShareSessionCache) {
+  scoped_refptr<SharedSessionCache> cache =
+      SessionCache({Fingerprint('a'), Fingerprint('b')});
+  ASSERT_TRUE(cache);
+  // Order of fingerprints doesn't matter.
+  EXPECT_EQ(SessionCache({Fingerprint('b'), Fingerprint('a')}), cache);
+  EXPECT_EQ(SessionCache({Fingerprint('a'), Fingerprint('b')}), cache);
+  // Clients with the default verifier share another cache.
+  scoped_refptr<SharedSessionCache> default_cache = SessionCache({});
+  ASSERT_TRUE(default_cache);
+  EXPECT_EQ(SessionCache({}), default_cache);
+}
+
+TEST_F(WebTransportFactoryImplTest,
+       DifferentFingerprintsUseDifferentSessionCaches) {
+  scoped_refptr<SharedSessionCache> cache_a = SessionCache({Fingerprint('a')});
+  scoped_refptr<SharedSessionCache> cache_b = SessionCache({Fingerprint('b')});
+  scoped_refptr<SharedSessionCache> cache_ab =
+      SessionCache({Fingerprint('a'), Fingerprint('b')});
+  scoped_refptr<SharedSessionCache> default_cache = SessionCache({});
+  EXPECT_NE(cache_a, cache_b);
+  EXPECT_NE(cache_a, cache_ab);
+  EXPECT_NE(cache_b, cache_ab);
+  EXPECT_NE(default_cache, cache_a);
+  EXPECT_NE(default_cache, cache_b);
+  EXPECT_NE(default_cache, cache_ab);
+}
+
 // Disabled because the certificate path is hard coded.
 TEST(DISABLED_WebTransportFactoryImplTest, CreateWebTransportServer) {
   auto* factory = WebTransportFactory::Create();
@@ -30,6 +30,7 @@
 #include "net/third_party/quiche/src/quic/core/quic_connection.h"
 #include "net/third_party/quiche/src/quic/core/quic_utils.h"
 #include "net/url_request/url_request_context.h"
+#include "owt/web_transport/sdk/impl/utilities.h"
 #include "url/scheme_host_port.h"
 
 namespace owt {
@@ -217,7 +218,8 @@ WebTransportHttp3Client::WebTransportHttp3Client(
     WebTransportClientVisitor* visitor,
     const NetworkIsolationKey& isolation_key,
     URLRequestContext* context,
-    const WebTransportParameters& parameters)
+    const WebTransportParameters& parameters,
+    std::unique_ptr<::quic::SessionCache> session_cache)
     : url_(url),
       origin_(origin),
       isolation_key_(isolation_key),
@@ -236,8 +238,10 @@ WebTransportHttp3Client::WebTransportHttp3Client(
       // (currently, all certificate verification errors result in "TLS
       // handshake error" even when more detailed message is available).  This
       // requires implementing ProofHandler::OnProofVerifyDetailsAvailable.
+      // `session_cache` is added by owt developers. Sessions are resumed when
+      // it's shared by clients.
       crypto_config_(CreateProofVerifier(isolation_key_, context, parameters),
-                     /* session_cache */ nullptr) {}
+                     std::move(session_cache)) {}
 
 WebTransportHttp3Client::~WebTransportHttp3Client() = default;
 
@@ -281,6 +285,20 @@ void WebTransportHttp3Client::Close(
   return session_.get();
 }
 
+void WebTransportHttp3Client::SetCongestionControl(
+    CongestionControlAlgorithm algorithm,
+    uint32_t initial_congestion_window) {
+  DCHECK(state_ == WebTransportState::NEW);
+  congestion_control_ = algorithm;
+  initial_congestion_window_ = initial_congestion_window;
+}
+
+void WebTransportHttp3Client::SetCongestionControllerFactory(
+    CongestionControllerFactoryInterface* factory) {
+  DCHECK(state_ == WebTransportState::NEW);
+  congestion_controller_factory_ = factory;
+}
+
 void WebTransportHttp3Client::DoLoop(int rv) {
   do {
     ConnectState connect_state = next_connect_state_;
@@ -480,6 +498,16 @@ void WebTransportHttp3Client::CreateConnection() {
   connection_->set_creator_debug_delegate(event_logger_.get());
 
   session_->Initialize();
+  Utilities::ApplyCongestionControl(connection_, congestion_control_,
+                                    initial_congestion_window_);
+  if (congestion_controller_factory_) {
+    std::unique_ptr<CongestionControllerInterface> controller(
+        congestion_controller_factory_->CreateCongestionController());
+    if (controller) {
+      Utilities::InstallCongestionController(connection_,
+                                             std::move(controller));
+    }
+  }
   packet_reader_->StartReading();
 
   DCHECK(session_->WillNegotiateWebTransport());
@@ -31,6 +31,8 @@
 #include "net/third_party/quiche/src/quic/core/quic_versions.h"
 #include "net/third_party/quiche/src/quic/core/web_transport_interface.h"
 #include "net/third_party/quiche/src/quic/quic_transport/web_transport_fingerprint_proof_verifier.h"
+#include "owt/quic/congestion_controller_interface.h"
+#include "owt/quic/web_transport_definitions.h"
 #include "url/gurl.h"
 #include "url/origin.h"
 
@@ -58,7 +60,8 @@ class WebTransportHttp3Client : public net::WebTransportClient,
       net::WebTransportClientVisitor* visitor,
       const net::NetworkIsolationKey& isolation_key,
       net::URLRequestContext* context,
-      const net::WebTransportParameters& parameters);
+      const net::WebTransportParameters& parameters,
+      std::unique_ptr<::quic::SessionCache> session_cache);
   ~WebTransportHttp3Client() override;
 
   net::WebTransportState state() const { return state_; }
@@ -74,6 +77,15 @@ class WebTransportHttp3Client : public net::WebTransportClient,
   // Return a QUIC session. This method is added by owt developers.
   ::quic::QuicSpdyClientSession* quic_session();
 
+  // Congestion control settings applied when the connection is created. Must
+  // be called before Connect(). This method is added by owt developers.
+  void SetCongestionControl(CongestionControlAlgorithm algorithm,
+                            uint32_t initial_congestion_window);
+  // `factory` creates congestion controller when the connection is created.
+  // Must be called before Connect(). This method is added by owt developers.
+  void SetCongestionControllerFactory(
+      CongestionControllerFactoryInterface* factory);
+
   void OnSettingsReceived();
   void OnHeadersComplete();
   void OnConnectStreamWriteSideInDataRecvdState();
@@ -189,6 +201,11 @@ class WebTransportHttp3Client : public net::WebTransportClient,
   std::unique_ptr<net::QuicChromiumPacketReader> packet_reader_;
   std::unique_ptr<net::QuicEventLogger> event_logger_;
   ::quic::QuicClientPushPromiseIndex push_promise_index_;
+  CongestionControlAlgorithm congestion_control_ =
+      CongestionControlAlgorithm::kDefault;
+  uint32_t initial_congestion_window_ = 0;
+  CongestionControllerFactoryInterface* congestion_controller_factory_ =
+      nullptr;
 
   absl::optional<net::WebTransportCloseInfo> close_info_;
 
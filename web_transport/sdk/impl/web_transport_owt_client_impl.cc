@@ -5,7 +5,9 @@
  */
 
 #include "impl/web_transport_owt_client_impl.h"
+#include "base/containers/contains.h"
 #include "base/threading/thread.h"
+#include "impl/received_datagram_impl.h"
 #include "net/proxy_resolution/configured_proxy_resolution_service.h"
 #include "net/third_party/quiche/src/quic/core/web_transport_interface.h"
 #include "net/url_request/url_request_context.h"
@@ -48,7 +50,12 @@ WebTransportOwtClientImpl::WebTransportOwtClientImpl(
       origin_(origin),
       parameters_(parameters),
       event_runner_(event_thread->task_runner()),
-      context_(context) {
+      context_(context),
+      closed_(false),
+      datagrams_flush_scheduled_(false),
+      congestion_control_(CongestionControlAlgorithm::kDefault),
+      initial_congestion_window_(0),
+      congestion_controller_factory_(nullptr) {
   CHECK(event_runner_);
   if (!io_thread) {
     LOG(INFO) << "Create a new IO stream.";
@@ -74,9 +81,12 @@ WebTransportOwtClientImpl::~WebTransportOwtClientImpl() {
                            base::WaitableEvent::InitialState::NOT_SIGNALED);
   task_runner_->PostTask(
       FROM_HERE, base::BindOnce(
-                     [](std::unique_ptr<net::WebTransportClient> client,
+                     [](WebTransportOwtClientImpl* owt_client,
+                        std::unique_ptr<net::WebTransportClient> client,
                         std::unique_ptr<net::URLRequestContext> context,
                         base::WaitableEvent* event) {
+                       // Tasks posted to IO thread become no-ops.
+                       owt_client->io_weak_factory_.InvalidateWeakPtrs();
                        if (client) {
                          client.reset();
                        }
@@ -85,8 +95,26 @@ WebTransportOwtClientImpl::~WebTransportOwtClientImpl() {
                        }
                        event->Signal();
                      },
-                     std::move(client_), std::move(context_owned_), &done));
+                     base::Unretained(this), std::move(client_),
+                     std::move(context_owned_), &done));
   done.Wait();
+  // Tasks posted to event thread become no-ops.
+  if (event_runner_->BelongsToCurrentThread()) {
+    weak_factory_.InvalidateWeakPtrs();
+  } else {
+    event_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(
+            [](WebTransportOwtClientImpl* client, base::WaitableEvent* event) {
+              client->weak_factory_.InvalidateWeakPtrs();
+              event->Signal();
+            },
+            base::Unretained(this), &done));
+    done.Wait();
+  }
+  for (ReceivedDatagram* datagram : received_datagrams_) {
+    datagram->Release();
+  }
 }
 
 void WebTransportOwtClientImpl::Connect() {
@@ -109,7 +137,11 @@ void WebTransportOwtClientImpl::ConnectOnCurrentThread(
   CHECK(context_->quic_context());
   client_ = std::make_unique<WebTransportHttp3Client>(
       url_, origin_, this, net::NetworkIsolationKey(origin_, origin_), context_,
-      parameters_);
+      parameters_,
+      session_cache_ ? session_cache_->CreateClientCache() : nullptr);
+  client_->SetCongestionControl(congestion_control_,
+                                initial_congestion_window_);
+  client_->SetCongestionControllerFactory(congestion_controller_factory_);
   client_->Connect();
   event->Signal();
 }
@@ -138,6 +170,7 @@ void WebTransportOwtClientImpl::OnConnected(
 void WebTransportOwtClientImpl::OnConnectionFailed(
     const net::WebTransportError& error) {
   LOG(INFO) << "OnConnectionFailed.";
+  closed_ = true;
   event_runner_->PostTask(
       FROM_HERE,
       base::BindOnce(
@@ -151,11 +184,22 @@ void WebTransportOwtClientImpl::OnError(const net::WebTransportError& error) {
 
 void WebTransportOwtClientImpl::OnClosed(
     const absl::optional<net::WebTransportCloseInfo>& close_info) {
-  if (!visitor_)
-    return;
-  bool has_value(close_info.has_value());
-  visitor_->OnClosed(has_value ? close_info->code : 0,
-                     has_value ? nullptr : close_info->reason.c_str());
+  closed_ = true;
+  for (auto& stream : streams_) {
+    stream.second->OnSessionClosed();
+  }
+  // Posted to event thread after incoming streams, so visitor always sees a
+  // stream before the session is closed.
+  uint32_t code = close_info.has_value() ? close_info->code : 0;
+  std::string reason = close_info.has_value() ? close_info->reason : "";
+  event_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          &WebTransportOwtClientImpl::FireEvent, weak_factory_.GetWeakPtr(),
+          std::function<void(WebTransportClientInterface::Visitor&)>(
+              [code, reason](WebTransportClientInterface::Visitor& visitor) {
+                visitor.OnClosed(code, reason.c_str());
+              })));
 }
 
 WebTransportStreamInterface*
@@ -209,20 +253,17 @@ WebTransportOwtClientImpl::CreateOutgoingStreamOnCurrentThread(
 }
 
 void WebTransportOwtClientImpl::OnIncomingBidirectionalStreamAvailable() {
-  event_runner_->PostTask(
-      FROM_HERE,
-      base::BindOnce(&WebTransportOwtClientImpl::OnIncomingStreamAvailable,
-                     weak_factory_.GetWeakPtr(), true));
+  OnIncomingStreamAvailable(true);
 }
 
 void WebTransportOwtClientImpl::OnIncomingUnidirectionalStreamAvailable() {
-  event_runner_->PostTask(
-      FROM_HERE,
-      base::BindOnce(&WebTransportOwtClientImpl::OnIncomingStreamAvailable,
-                     weak_factory_.GetWeakPtr(), false));
+  OnIncomingStreamAvailable(false);
 }
 
 void WebTransportOwtClientImpl::OnIncomingStreamAvailable(bool bidirectional) {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  // Streams are accepted on IO thread because `streams_` is only accessed on
+  // IO thread. The visitor is notified on event thread.
   auto* stream = bidirectional
                      ? client_->session()->AcceptIncomingBidirectionalStream()
                      : client_->session()->AcceptIncomingUnidirectionalStream();
@@ -230,13 +271,122 @@ void WebTransportOwtClientImpl::OnIncomingStreamAvailable(bool bidirectional) {
   if (visitor_) {
     auto* owt_stream = OwtStreamForNativeStream(stream);
     CHECK(owt_stream);
-    visitor_->OnIncomingStream(owt_stream);
+    // `owt_stream` is kept in `streams_` until visitor sees it, even if the
+    // QUIC stream is closed before that.
+    undelivered_streams_.insert(owt_stream->Id());
+    event_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(&WebTransportOwtClientImpl::DeliverIncomingStream,
+                       weak_factory_.GetWeakPtr(), owt_stream));
   } else {
     // No one cares about incoming streams.
     DCHECK(stream->SendFin());
   }
 }
 
+void WebTransportOwtClientImpl::DeliverIncomingStream(
+    WebTransportStreamInterface* stream) {
+  DCHECK(event_runner_->BelongsToCurrentThread());
+  if (visitor_) {
+    visitor_->OnIncomingStream(stream);
+  }
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&WebTransportOwtClientImpl::OnIncomingStreamDelivered,
+                     io_weak_factory_.GetWeakPtr(), stream->Id()));
+}
+
+void WebTransportOwtClientImpl::OnIncomingStreamDelivered(uint32_t id) {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  undelivered_streams_.erase(id);
+  auto it = streams_.find(id);
+  if (it == streams_.end() || !it->second->IsClosed()) {
+    return;
+  }
+  // The QUIC stream was closed before visitor saw it.
+  it->second->MaybeReportClosed();
+  streams_.erase(it);
+}
+
+void WebTransportOwtClientImpl::OnDatagramReceived(
+    base::StringPiece datagram) {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  received_datagrams_.push_back(ReceivedDatagramImpl::Create(
+      absl::string_view(datagram.data(), datagram.size()),
+      client_->quic_session()->connection()->clock()->ApproximateNow()));
+  if (datagrams_flush_scheduled_) {
+    return;
+  }
+  // Datagrams are reported after the current task, which processes a batch of
+  // incoming packets.
+  datagrams_flush_scheduled_ = true;
+  task_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&WebTransportOwtClientImpl::FlushDatagrams,
+                                io_weak_factory_.GetWeakPtr()));
+}
+
+void WebTransportOwtClientImpl::FlushDatagrams() {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  datagrams_flush_scheduled_ = false;
+  if (visitor_ && !received_datagrams_.empty()) {
+    visitor_->OnDatagramsReceived(received_datagrams_.data(),
+                                  received_datagrams_.size());
+  }
+  for (ReceivedDatagram* datagram : received_datagrams_) {
+    datagram->Release();
+  }
+  received_datagrams_.clear();
+}
+
+void WebTransportOwtClientImpl::SetCongestionControl(
+    CongestionControlAlgorithm algorithm,
+    uint32_t initial_congestion_window) {
+  congestion_control_ = algorithm;
+  initial_congestion_window_ = initial_congestion_window;
+}
+
+void WebTransportOwtClientImpl::SetCongestionControllerFactory(
+    CongestionControllerFactoryInterface* factory) {
+  congestion_controller_factory_ = factory;
+}
+
+void WebTransportOwtClientImpl::SetSessionCache(
+    scoped_refptr<SharedSessionCache> session_cache) {
+  session_cache_ = std::move(session_cache);
+}
+
+ConnectionStats WebTransportOwtClientImpl::GetStats() {
+  ConnectionStats stats = ConnectionStats();
+  if (task_runner_->BelongsToCurrentThread()) {
+    FillStatsOnCurrentThread(&stats);
+    return stats;
+  }
+  base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                           base::WaitableEvent::InitialState::NOT_SIGNALED);
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](WebTransportOwtClientImpl* client, ConnectionStats* stats,
+             base::WaitableEvent* event) {
+            client->FillStatsOnCurrentThread(stats);
+            event->Signal();
+          },
+          base::Unretained(this), base::Unretained(&stats),
+          base::Unretained(&done)));
+  done.Wait();
+  return stats;
+}
+
+void WebTransportOwtClientImpl::FillStatsOnCurrentThread(
+    ConnectionStats* stats) {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  Utilities::FillConnectionStats(client_ ? client_->quic_session() : nullptr,
+                                 stats);
+  for (const auto& stream : streams_) {
+    stats->stream_buffered_bytes += stream.second->BufferedDataBytes();
+  }
+}
+
 void WebTransportOwtClientImpl::OnDatagramProcessed(
     absl::optional<::quic::MessageStatus> status) {
   if (visitor_) {
@@ -251,12 +401,21 @@ WebTransportOwtClientImpl::OwtStreamForNativeStream(
       std::make_unique<WebTransportStreamImpl>(
           stream,
           client_->quic_session()->GetOrCreateStream(stream->GetStreamId()),
-          task_runner_.get(), event_runner_.get());
+          task_runner_.get(), event_runner_.get(), this);
   WebTransportStreamImpl* stream_ptr(stream_impl.get());
-  streams_.push_back(std::move(stream_impl));
+  streams_[stream_ptr->Id()] = std::move(stream_impl);
   return stream_ptr;
 }
 
+void WebTransportOwtClientImpl::OnStreamClosed(WebTransportStreamImpl* stream) {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  auto it = streams_.find(stream->Id());
+  DCHECK(it != streams_.end() && it->second.get() == stream);
+  if (it != streams_.end() && !base::Contains(undelivered_streams_, stream->Id())) {
+    streams_.erase(it);
+  }
+}
+
 void WebTransportOwtClientImpl::FireEvent(
     std::function<void(WebTransportClientInterface::Visitor&)> func) {
   if (visitor_) {
@@ -300,5 +459,85 @@ MessageStatus WebTransportOwtClientImpl::SendOrQueueDatagram(uint8_t* data,
   return result;
 }
 
+AsyncIoStatus WebTransportOwtClientImpl::SendOrQueueDatagramAsync(
+    const uint8_t* data,
+    size_t length,
+    BufferReleaser* releaser) {
+  CHECK(releaser);
+  DCHECK_GT(length, 0u);
+  if (closed_) {
+    return AsyncIoStatus::kClosed;
+  }
+  ::quic::QuicMemSlice slice =
+      Utilities::WrapAsMemSlice(data, length, releaser);
+  if (task_runner_->BelongsToCurrentThread()) {
+    SendOrQueueDatagramOnCurrentThread(std::move(slice));
+  } else {
+    task_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(
+            &WebTransportOwtClientImpl::SendOrQueueDatagramOnCurrentThread,
+            base::Unretained(this), std::move(slice)));
+  }
+  return AsyncIoStatus::kAccepted;
+}
+
+void WebTransportOwtClientImpl::SendOrQueueDatagramOnCurrentThread(
+    ::quic::QuicMemSlice slice) {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  if (!client_ || !client_->session()) {
+    return;
+  }
+  // Result is reported by OnDatagramProcessed.
+  client_->session()->SendOrQueueDatagram(std::move(slice));
+}
+
+void WebTransportOwtClientImpl::SendDatagrams(const DataSpan* datagrams,
+                                              size_t datagram_count,
+                                              MessageStatus* statuses) {
+  std::vector<::quic::QuicMemSlice> slices;
+  slices.reserve(datagram_count);
+  for (size_t i = 0; i < datagram_count; i++) {
+    slices.push_back(Utilities::CopyToMemSlice(&datagrams[i], 1));
+  }
+  if (task_runner_->BelongsToCurrentThread()) {
+    SendDatagramsOnCurrentThread(std::move(slices), statuses);
+    return;
+  }
+  base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                           base::WaitableEvent::InitialState::NOT_SIGNALED);
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](WebTransportOwtClientImpl* client,
+             std::vector<::quic::QuicMemSlice> slices, MessageStatus* statuses,
+             base::WaitableEvent* event) {
+            client->SendDatagramsOnCurrentThread(std::move(slices), statuses);
+            event->Signal();
+          },
+          base::Unretained(this), std::move(slices), base::Unretained(statuses),
+          base::Unretained(&done)));
+  done.Wait();
+}
+
+void WebTransportOwtClientImpl::SendDatagramsOnCurrentThread(
+    std::vector<::quic::QuicMemSlice> slices,
+    MessageStatus* statuses) {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  if (!client_ || !client_->session()) {
+    for (size_t i = 0; i < slices.size(); i++) {
+      statuses[i] = MessageStatus::kUnavailable;
+    }
+    return;
+  }
+  // Datagrams are bundled until `flusher` goes out of scope.
+  ::quic::QuicConnection::ScopedPacketFlusher flusher(
+      client_->quic_session()->connection());
+  for (size_t i = 0; i < slices.size(); i++) {
+    statuses[i] = Utilities::ConvertMessageStatus(
+        client_->session()->SendOrQueueDatagram(std::move(slices[i])));
+  }
+}
+
 }  // namespace quic
 }  // namespace owt
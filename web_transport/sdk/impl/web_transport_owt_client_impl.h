@@ -7,9 +7,15 @@
 #ifndef OWT_WEB_TRANSPORT_WEB_TRANSPORT_WEB_TRANSPORT_OWT_CLIENT_IMPL_H_
 #define OWT_WEB_TRANSPORT_WEB_TRANSPORT_WEB_TRANSPORT_OWT_CLIENT_IMPL_H_
 
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "base/memory/weak_ptr.h"
 #include "base/threading/thread.h"
 #include "owt/quic/web_transport_client_interface.h"
+#include "owt/web_transport/sdk/impl/shared_session_cache.h"
 #include "owt/web_transport/sdk/impl/web_transport_http3_client.h"
 #include "owt/web_transport/sdk/impl/web_transport_stream_impl.h"
 #include "url/gurl.h"
@@ -20,7 +26,8 @@ namespace quic {
 // This class is thread-safe. All calls to //net will be delegated to
 // io_thread_.
 class WebTransportOwtClientImpl : public WebTransportClientInterface,
-                                  public net::WebTransportClientVisitor {
+                                  public net::WebTransportClientVisitor,
+                                  public WebTransportStreamImpl::Delegate {
  public:
   WebTransportOwtClientImpl(const GURL& url,
                             const url::Origin& origin,
@@ -47,6 +54,24 @@ class WebTransportOwtClientImpl : public WebTransportClientInterface,
   WebTransportStreamInterface* CreateBidirectionalStream() override;
   WebTransportStreamInterface* CreateOutgoingUnidirectionalStream() override;
   MessageStatus SendOrQueueDatagram(uint8_t* data, size_t length) override;
+  AsyncIoStatus SendOrQueueDatagramAsync(const uint8_t* data,
+                                         size_t length,
+                                         BufferReleaser* releaser) override;
+  void SendDatagrams(const DataSpan* datagrams,
+                     size_t datagram_count,
+                     MessageStatus* statuses) override;
+  ConnectionStats GetStats() override;
+
+  // Congestion control settings for the connection. Must be called before
+  // Connect.
+  void SetCongestionControl(CongestionControlAlgorithm algorithm,
+                            uint32_t initial_congestion_window);
+  // `factory` is not owned. Must be called before Connect.
+  void SetCongestionControllerFactory(
+      CongestionControllerFactoryInterface* factory);
+  // Sessions in `session_cache` are resumed, and new sessions are stored into
+  // it. Must be called before Connect.
+  void SetSessionCache(scoped_refptr<SharedSessionCache> session_cache);
 
  protected:
   // Overrides net::WebTransportClientVisitor.
@@ -58,12 +83,15 @@ class WebTransportOwtClientImpl : public WebTransportClientInterface,
   void OnError(const net::WebTransportError& error) override;
   void OnIncomingBidirectionalStreamAvailable() override;
   void OnIncomingUnidirectionalStreamAvailable() override;
-  void OnDatagramReceived(base::StringPiece datagram) override {}
+  void OnDatagramReceived(base::StringPiece datagram) override;
   void OnCanCreateNewOutgoingBidirectionalStream() override {}
   void OnCanCreateNewOutgoingUnidirectionalStream() override {}
   void OnDatagramProcessed(
       absl::optional<::quic::MessageStatus> status) override;
 
+  // Overrides WebTransportStreamImpl::Delegate.
+  void OnStreamClosed(WebTransportStreamImpl* stream) override;
+
  private:
   void ConnectOnCurrentThread(base::WaitableEvent* event);
   void CloseOnCurrentThread(base::WaitableEvent* event);
@@ -71,9 +99,19 @@ class WebTransportOwtClientImpl : public WebTransportClientInterface,
   WebTransportStreamInterface* CreateOutgoingStreamOnCurrentThread(
       bool bidirectional);
   void OnIncomingStreamAvailable(bool bidirectional);
+  // Reports an incoming stream to visitor on event thread.
+  void DeliverIncomingStream(WebTransportStreamInterface* stream);
+  // Called on IO thread after visitor has seen stream `id`.
+  void OnIncomingStreamDelivered(uint32_t id);
+  void SendOrQueueDatagramOnCurrentThread(::quic::QuicMemSlice slice);
+  void SendDatagramsOnCurrentThread(std::vector<::quic::QuicMemSlice> slices,
+                                    MessageStatus* statuses);
   // This method also adds created stream to `streams_`.
   WebTransportStreamInterface* OwtStreamForNativeStream(
       ::quic::WebTransportStream* stream);
+  void FillStatsOnCurrentThread(ConnectionStats* stats);
+  // Reports datagrams collected by OnDatagramReceived to visitor.
+  void FlushDatagrams();
   void FireEvent(
       std::function<void(WebTransportClientInterface::Visitor&)> func);
 
@@ -87,10 +125,29 @@ class WebTransportOwtClientImpl : public WebTransportClientInterface,
   net::URLRequestContext* context_;
   std::unique_ptr<WebTransportHttp3Client> client_;
   WebTransportClientInterface::Visitor* visitor_;
-  // TODO: Pop from the vector when a stream is closed.
-  std::vector<std::unique_ptr<WebTransportStreamImpl>> streams_;
+  // Written on IO thread, read on any thread.
+  std::atomic<bool> closed_;
+  // Open streams indexed by stream ID. Closed streams are removed. Only
+  // accessed on IO thread.
+  std::unordered_map<uint32_t, std::unique_ptr<WebTransportStreamImpl>>
+      streams_;
+  // IDs of incoming streams not reported to visitor yet. They're not removed
+  // from `streams_` until they're reported. Only accessed on IO thread.
+  std::unordered_set<uint32_t> undelivered_streams_;
+  // Datagrams received since last FlushDatagrams. Each of them holds a
+  // reference owned by this client. Only accessed on IO thread.
+  std::vector<ReceivedDatagram*> received_datagrams_;
+  bool datagrams_flush_scheduled_;
+  CongestionControlAlgorithm congestion_control_;
+  uint32_t initial_congestion_window_;
+  CongestionControllerFactoryInterface* congestion_controller_factory_;
+  scoped_refptr<SharedSessionCache> session_cache_;
 
+  // WeakPtrs are bound to one sequence. `weak_factory_` is for tasks on event
+  // thread, and `io_weak_factory_` is for tasks on IO thread. The latter is
+  // invalidated on IO thread when this client is destroyed.
   base::WeakPtrFactory<WebTransportOwtClientImpl> weak_factory_{this};
+  base::WeakPtrFactory<WebTransportOwtClientImpl> io_weak_factory_{this};
 };
 }  // namespace quic
 }  // namespace owt
@@ -16,9 +16,11 @@
 #include <memory>
 #include "impl/http3_server_session.h"
 #include "net/third_party/quiche/src/quic/core/quic_connection.h"
+#include "net/third_party/quiche/src/quic/core/quic_constants.h"
 #include "net/third_party/quiche/src/quic/core/quic_dispatcher.h"
 #include "net/third_party/quiche/src/quic/core/quic_types.h"
 #include "net/third_party/quiche/src/quic/core/quic_versions.h"
+#include "owt/web_transport/sdk/impl/utilities.h"
 
 namespace owt {
 namespace quic {
@@ -48,7 +50,17 @@ WebTransportOwtServerDispatcher::WebTransportOwtServerDispatcher(
       visitor_(nullptr),
       backend_(backend),
       runner_(task_runner),
-      event_runner_(event_runner) {
+      event_runner_(event_runner),
+      congestion_control_(CongestionControlAlgorithm::kDefault),
+      initial_congestion_window_(0),
+      max_packet_size_(0),
+      handshake_admission_(helper()->GetClock(),
+                           helper()->GetRandomGenerator()),
+      zero_rtt_enabled_(true),
+      full_handshakes_(0),
+      resumed_handshakes_(0),
+      zero_rtt_handshakes_(0),
+      retry_packets_dropped_(0) {
   CHECK(backend_);
   CHECK(runner_);
   CHECK(event_runner_);
@@ -71,7 +83,23 @@ std::unique_ptr<QuicSession> WebTransportOwtServerDispatcher::CreateQuicSession(
       config(), GetSupportedVersions(), connection.release(), this,
       session_helper(), crypto_config(), compressed_certs_cache(), backend_,
       runner_, event_runner_);
+  session->SetHandshakeObserver(this);
+  session->SetZeroRttEnabled(zero_rtt_enabled_);
   session->Initialize();
+  absl::optional<QuicConnectionId> original_connection_id =
+      handshake_admission_.OnSessionCreated(server_connection_id);
+  if (original_connection_id.has_value()) {
+    // Client is validated by a Retry packet. Transport parameters must carry
+    // connection IDs before and after Retry.
+    session->connection()->SetOriginalDestinationConnectionId(
+        *original_connection_id);
+    session->config()->SetRetrySourceConnectionIdToSend(server_connection_id);
+  }
+  Utilities::ApplyCongestionControl(session->connection(), congestion_control_,
+                                    initial_congestion_window_);
+  if (max_packet_size_ > 0) {
+    session->connection()->SetMaxPacketLength(max_packet_size_);
+  }
   DLOG(INFO) << "Create a new session for " << peer_address.ToString();
   return session;
 }
@@ -79,5 +107,85 @@ std::unique_ptr<QuicSession> WebTransportOwtServerDispatcher::CreateQuicSession(
 void WebTransportOwtServerDispatcher::SetVisitor(Visitor* visitor) {
   visitor_ = visitor;
 }
+
+void WebTransportOwtServerDispatcher::SetCongestionControl(
+    CongestionControlAlgorithm algorithm,
+    uint32_t initial_congestion_window) {
+  congestion_control_ = algorithm;
+  initial_congestion_window_ = initial_congestion_window;
+}
+
+void WebTransportOwtServerDispatcher::SetMaxPacketSize(
+    QuicByteCount max_packet_size) {
+  max_packet_size_ = max_packet_size;
+}
+
+void WebTransportOwtServerDispatcher::SetHandshakeLimits(
+    uint32_t handshakes_per_second,
+    size_t max_pending_handshakes) {
+  handshake_admission_.SetLimits(handshakes_per_second, max_pending_handshakes);
+}
+
+void WebTransportOwtServerDispatcher::SetZeroRttEnabled(bool enabled) {
+  zero_rtt_enabled_ = enabled;
+}
+
+void WebTransportOwtServerDispatcher::OnHandshakeComplete(bool resumed,
+                                                          bool zero_rtt) {
+  if (!resumed) {
+    full_handshakes_++;
+    return;
+  }
+  resumed_handshakes_++;
+  if (zero_rtt) {
+    zero_rtt_handshakes_++;
+  }
+}
+
+bool WebTransportOwtServerDispatcher::MaybeDispatchPacket(
+    const ReceivedPacketInfo& packet_info) {
+  if (QuicDispatcher::MaybeDispatchPacket(packet_info)) {
+    // Processed by an existing session or the time wait list, or dropped.
+    return true;
+  }
+  // Initial packets too small to carry a CHLO are dropped by QuicDispatcher,
+  // so they don't get a Retry.
+  if (packet_info.form != IETF_QUIC_LONG_HEADER_PACKET ||
+      packet_info.long_packet_type != INITIAL ||
+      packet_info.packet.length() < kMinClientInitialPacketLength ||
+      !HandshakeAdmission::SupportsRetry(packet_info.version)) {
+    return false;
+  }
+  switch (handshake_admission_.OnInitialPacket(
+      packet_info.destination_connection_id, packet_info.peer_address,
+      packet_info.retry_token.value_or(absl::string_view()))) {
+    case HandshakeAdmission::Decision::kAccept:
+      return false;
+    case HandshakeAdmission::Decision::kRetry: {
+      if (writer()->IsWriteBlocked()) {
+        retry_packets_dropped_++;
+        return true;
+      }
+      const std::string retry = handshake_admission_.BuildRetryPacket(
+          packet_info.version, packet_info.destination_connection_id,
+          packet_info.source_connection_id, packet_info.peer_address);
+      WriteResult result = writer()->WritePacket(
+          retry.data(), retry.size(), packet_info.self_address.host(),
+          packet_info.peer_address, nullptr);
+      // A batch writer only buffers the packet. Nothing else flushes it for
+      // packets without a session.
+      if (result.status == WRITE_STATUS_OK && writer()->IsBatchMode()) {
+        result = writer()->Flush();
+      }
+      if (IsWriteBlockedStatus(result.status) || IsWriteError(result.status)) {
+        retry_packets_dropped_++;
+      }
+      return true;
+    }
+    case HandshakeAdmission::Decision::kReject:
+      return true;
+  }
+  return true;
+}
 }  // namespace quic
 }  // namespace owt
\ No newline at end of file
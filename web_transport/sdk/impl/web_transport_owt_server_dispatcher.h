@@ -16,7 +16,10 @@
 #define OWT_WEB_TRANSPORT_WEB_TRANSPORT_WEB_TRANSPORT_OWT_SERVER_DISPATCHER_H_
 
 #include "base/task/single_thread_task_runner.h"
+#include "owt/web_transport/sdk/impl/handshake_admission.h"
+#include "owt/web_transport/sdk/impl/http3_server_session.h"
 #include "net/third_party/quiche/src/quic/core/quic_dispatcher.h"
+#include "owt/quic/web_transport_definitions.h"
 #include "url/origin.h"
 
 namespace owt {
@@ -25,7 +28,9 @@ namespace quic {
 class WebTransportSessionInterface;
 class WebTransportServerBackend;
 
-class WebTransportOwtServerDispatcher : public ::quic::QuicDispatcher {
+class WebTransportOwtServerDispatcher
+    : public ::quic::QuicDispatcher,
+      public Http3ServerSession::HandshakeObserver {
  public:
   class Visitor {
    public:
@@ -46,6 +51,31 @@ class WebTransportOwtServerDispatcher : public ::quic::QuicDispatcher {
       base::SingleThreadTaskRunner* task_runner,
       base::SingleThreadTaskRunner* event_runner);
   void SetVisitor(Visitor* visitor);
+  // Congestion control settings for sessions created afterwards.
+  void SetCongestionControl(CongestionControlAlgorithm algorithm,
+                            uint32_t initial_congestion_window);
+  // Maximum size of packets sent by sessions created afterwards. 0 keeps QUIC
+  // stack's default.
+  void SetMaxPacketSize(::quic::QuicByteCount max_packet_size);
+  // Limits new handshakes. See ServerOptions::max_handshakes_per_second and
+  // ServerOptions::max_pending_handshakes.
+  void SetHandshakeLimits(uint32_t handshakes_per_second,
+                          size_t max_pending_handshakes);
+  const HandshakeAdmission& handshake_admission() const {
+    return handshake_admission_;
+  }
+  // Retry packets not sent because the socket is blocked or fails.
+  uint64_t retry_packets_dropped() const { return retry_packets_dropped_; }
+  // Whether sessions created afterwards accept 0-RTT data.
+  void SetZeroRttEnabled(bool enabled);
+
+  // Completed handshakes by kind. Resumed handshakes include 0-RTT ones.
+  uint64_t full_handshakes() const { return full_handshakes_; }
+  uint64_t resumed_handshakes() const { return resumed_handshakes_; }
+  uint64_t zero_rtt_handshakes() const { return zero_rtt_handshakes_; }
+
+  // Overrides Http3ServerSession::HandshakeObserver.
+  void OnHandshakeComplete(bool resumed, bool zero_rtt) override;
 
   ~WebTransportOwtServerDispatcher() override;
 
@@ -58,6 +88,9 @@ class WebTransportOwtServerDispatcher : public ::quic::QuicDispatcher {
       absl::string_view alpn,
       const ::quic::ParsedQuicVersion& version,
       const ::quic::ParsedClientHello& parsed_chlo) override;
+  // Applies handshake admission to Initial packets of unknown connections.
+  bool MaybeDispatchPacket(
+      const ::quic::ReceivedPacketInfo& packet_info) override;
 
  private:
   std::vector<url::Origin> accepted_origins_;
@@ -65,6 +98,15 @@ class WebTransportOwtServerDispatcher : public ::quic::QuicDispatcher {
   WebTransportServerBackend* backend_;
   base::SingleThreadTaskRunner* runner_;
   base::SingleThreadTaskRunner* event_runner_;
+  CongestionControlAlgorithm congestion_control_;
+  uint32_t initial_congestion_window_;
+  ::quic::QuicByteCount max_packet_size_;
+  HandshakeAdmission handshake_admission_;
+  bool zero_rtt_enabled_;
+  uint64_t full_handshakes_;
+  uint64_t resumed_handshakes_;
+  uint64_t zero_rtt_handshakes_;
+  uint64_t retry_packets_dropped_;
 };
 }  // namespace quic
 }  // namespace owt
@@ -13,16 +13,21 @@
 // with modifications.
 
 #include "impl/web_transport_owt_server_impl.h"
+#include <algorithm>
 #include "base/bind.h"
+#include "base/numerics/safe_conversions.h"
 #include "base/threading/thread.h"
 #include "base/threading/thread_task_runner_handle.h"
+#include "impl/async_proof_source.h"
 #include "impl/http3_server_session.h"
+#include "impl/utilities.h"
 #include "impl/web_transport_owt_server_dispatcher.h"
 #include "net/base/net_errors.h"
 #include "net/quic/address_utils.h"
 #include "net/quic/platform/impl/quic_chromium_clock.h"
 #include "net/quic/quic_chromium_alarm_factory.h"
 #include "net/quic/quic_chromium_connection_helper.h"
+#include "net/third_party/quiche/src/quic/core/http/quic_spdy_session.h"
 #include "net/third_party/quiche/src/quic/core/quic_crypto_server_stream_base.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_default_proof_providers.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_system_event_loop.h"
@@ -31,13 +36,29 @@
 #include "net/tools/quic/quic_simple_server_packet_writer.h"
 #include "net/tools/quic/quic_simple_server_socket.h"
 
+#ifdef OWT_QUIC_USE_RECVMMSG
+#include "impl/udp_batch_packet_writer.h"
+#endif
+
 namespace owt {
 namespace quic {
 
 constexpr char kSourceAddressTokenSecret[] = "owt";
-constexpr size_t kMaxReadsPerEvent = 32;
-constexpr size_t kMaxNewConnectionsPerEvent = 32;
+constexpr size_t kDefaultMaxReadsPerEvent = 32;
+constexpr size_t kDefaultMaxNewConnectionsPerEvent = 32;
 constexpr int kReadBufferSize = 2 * ::quic::kMaxIncomingPacketSize;
+constexpr uint32_t kDefaultPacketReadBatchSize = 16;
+constexpr base::TimeDelta kDefaultDrainTimeout = base::Seconds(10);
+constexpr base::TimeDelta kDrainCheckInterval = base::Milliseconds(100);
+
+std::unique_ptr<::quic::ProofSource> MaybeSignAsync(
+    std::unique_ptr<::quic::ProofSource> proof_source,
+    bool async_signing) {
+  if (!async_signing) {
+    return proof_source;
+  }
+  return std::make_unique<AsyncProofSource>(std::move(proof_source));
+}
 
 class WebTransportOwtServerImplSessionHelper
     : public ::quic::QuicCryptoServerStreamBase::Helper {
@@ -55,16 +76,23 @@ WebTransportOwtServerImpl::WebTransportOwtServerImpl(
     int port,
     std::vector<url::Origin> accepted_origins,
     std::unique_ptr<::quic::ProofSource> proof_source,
+    const ServerOptions& options,
     base::Thread* io_thread,
     base::Thread* event_thread)
     : port_(port),
+      reuse_port_(false),
       version_manager_({::quic::ParsedQuicVersion::RFCv1(),
                         ::quic::ParsedQuicVersion::Draft29()}),
       clock_(::quic::QuicChromiumClock::GetInstance()),
       crypto_config_(kSourceAddressTokenSecret,
                      ::quic::QuicRandom::GetInstance(),
-                     std::move(proof_source),
+                     MaybeSignAsync(std::move(proof_source),
+                                    options.async_signing),
                      ::quic::KeyExchangeSource::Default()),
+      async_proof_source_(
+          options.async_signing
+              ? static_cast<AsyncProofSource*>(crypto_config_.proof_source())
+              : nullptr),
       dispatcher_(nullptr),
       socket_(nullptr),
       backend_(std::make_unique<WebTransportServerBackend>(
@@ -73,10 +101,31 @@ WebTransportOwtServerImpl::WebTransportOwtServerImpl(
       task_runner_(io_thread->task_runner()),
       event_runner_(event_thread->task_runner()),
       read_buffer_(
-          base::MakeRefCounted<net::IOBufferWithSize>(kReadBufferSize)) {
+          base::MakeRefCounted<net::IOBufferWithSize>(kReadBufferSize)),
+      socket_receive_buffer_size_(
+          base::saturated_cast<int>(options.socket_receive_buffer_size)),
+      socket_send_buffer_size_(
+          base::saturated_cast<int>(options.socket_send_buffer_size)),
+      max_reads_per_event_(options.max_reads_per_event > 0
+                               ? options.max_reads_per_event
+                               : kDefaultMaxReadsPerEvent),
+      max_new_connections_per_event_(
+          options.max_new_connections_per_event > 0
+              ? options.max_new_connections_per_event
+              : kDefaultMaxNewConnectionsPerEvent),
+      drain_timeout_(options.drain_timeout_ms > 0
+                         ? base::Milliseconds(options.drain_timeout_ms)
+                         : kDefaultDrainTimeout),
+      packet_read_batch_size_(options.packet_read_batch_size > 0
+                                  ? options.packet_read_batch_size
+                                  : kDefaultPacketReadBatchSize),
+      udp_gro_enabled_(options.udp_gro_enabled),
+      draining_(false),
+      stopped_(false) {
   CHECK(backend_);
   CHECK(task_runner_);
   CHECK(event_runner_);
+  Utilities::ApplyServerOptions(options, &config_);
   dispatcher_ = std::make_unique<WebTransportOwtServerDispatcher>(
       &config_, &crypto_config_, &version_manager_,
       std::make_unique<net::QuicChromiumConnectionHelper>(
@@ -87,6 +136,14 @@ WebTransportOwtServerImpl::WebTransportOwtServerImpl(
       ::quic::kQuicDefaultConnectionIdLength, accepted_origins, backend_.get(),
       task_runner_.get(), event_runner_.get());
   dispatcher_->SetVisitor(this);
+  dispatcher_->SetMaxPacketSize(options.max_packet_size);
+  dispatcher_->SetHandshakeLimits(options.max_handshakes_per_second,
+                                  options.max_pending_handshakes);
+  dispatcher_->SetZeroRttEnabled(options.zero_rtt_enabled);
+#ifndef OWT_QUIC_USE_RECVMMSG
+  packets_read_ = 0;
+  packet_read_calls_ = 0;
+#endif
 }
 
 WebTransportOwtServerImpl::~WebTransportOwtServerImpl() {
@@ -97,8 +154,15 @@ WebTransportOwtServerImpl::~WebTransportOwtServerImpl() {
       base::BindOnce(
           [](WebTransportOwtServerImpl* server, base::WaitableEvent* done) {
             server->weak_factory_.InvalidateWeakPtrs();
+#ifdef OWT_QUIC_USE_RECVMMSG
+            server->read_watcher_.reset();
+#endif
             server->socket_.reset();
             server->dispatcher_.reset();
+#ifdef OWT_QUIC_USE_RECVMMSG
+            // Packet writer owned by `dispatcher_` writes to this socket.
+            server->posix_socket_.reset();
+#endif
             done->Signal();
           },
           base::Unretained(this), &done));
@@ -113,7 +177,12 @@ int WebTransportOwtServerImpl::Start() {
       base::BindOnce(&WebTransportOwtServerImpl::StartOnCurrentThread,
                      base::Unretained(this), &done));
   done.Wait();
-  if (socket_) {
+#ifdef OWT_QUIC_USE_RECVMMSG
+  const bool started = !!posix_socket_;
+#else
+  const bool started = !!socket_;
+#endif
+  if (started) {
     LOG(INFO) << "WebTransport server is listening "
               << server_address_.ToString();
     return EXIT_SUCCESS;
@@ -125,27 +194,265 @@ int WebTransportOwtServerImpl::Start() {
 
 void WebTransportOwtServerImpl::StartOnCurrentThread(
     base::WaitableEvent* done) {
+#ifdef OWT_QUIC_USE_RECVMMSG
+  auto socket = std::make_unique<UdpServerSocketPosix>();
+  if (reuse_port_) {
+    socket->AllowReusePort();
+  }
+  socket->SetBufferSizes(socket_receive_buffer_size_, socket_send_buffer_size_);
+  int result = socket->Listen(port_);
+  if (result != net::OK) {
+    LOG(ERROR) << "Failed to listen on port " << port_ << ": "
+               << net::ErrorToString(result);
+    done->Signal();
+    return;
+  }
+  posix_socket_ = std::move(socket);
+  self_address_ = posix_socket_->local_address();
+  server_address_ = net::ToIPEndPoint(self_address_);
+  bool gro_enabled = false;
+  if (udp_gro_enabled_) {
+    gro_enabled = posix_socket_->EnableGro() == net::OK;
+  }
+  batch_reader_ = std::make_unique<UdpBatchReader>(packet_read_batch_size_,
+                                                   gro_enabled, clock_);
+  dispatcher_->InitializeWithWriter(
+      new UdpBatchPacketWriter(posix_socket_->fd(), dispatcher_.get()));
+  // The watcher keeps notifying while the socket is readable, so ReadPackets
+  // doesn't reschedule itself.
+  read_watcher_ = base::FileDescriptorWatcher::WatchReadable(
+      posix_socket_->fd(),
+      base::BindRepeating(&WebTransportOwtServerImpl::ReadPackets,
+                          base::Unretained(this)));
+  done->Signal();
+#else
+  LOG_IF(WARNING, reuse_port_) << "SO_REUSEPORT is not supported.";
   socket_ = net::CreateQuicSimpleServerSocket(
       net::IPEndPoint{net::IPAddress::IPv6AllZeros(), port_}, &server_address_);
   if (socket_ == nullptr) {
     done->Signal();
     return;
   }
+  if (socket_receive_buffer_size_ > 0) {
+    socket_->SetReceiveBufferSize(socket_receive_buffer_size_);
+  }
+  if (socket_send_buffer_size_ > 0) {
+    socket_->SetSendBufferSize(socket_send_buffer_size_);
+  }
 
   dispatcher_->InitializeWithWriter(
       new net::QuicSimpleServerPacketWriter(socket_.get(), dispatcher_.get()));
   ScheduleReadPackets();
   done->Signal();
-  return;
+#endif
 }
 
-void WebTransportOwtServerImpl::Stop() {}
+void WebTransportOwtServerImpl::Stop() {
+  GracefulStop(base::BindOnce(&WebTransportServerBackend::OnServerEnded,
+                              base::Unretained(backend_.get())));
+}
+
+void WebTransportOwtServerImpl::GracefulStop(base::OnceClosure on_stopped) {
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&WebTransportOwtServerImpl::GracefulStopOnCurrentThread,
+                     weak_factory_.GetWeakPtr(), std::move(on_stopped)));
+}
+
+void WebTransportOwtServerImpl::GracefulStopOnCurrentThread(
+    base::OnceClosure on_stopped) {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+  if (stopped_) {
+    std::move(on_stopped).Run();
+    return;
+  }
+  if (draining_) {
+    // Runs after the ongoing drain is completed.
+    on_stopped_callbacks_.push_back(std::move(on_stopped));
+    return;
+  }
+#ifdef OWT_QUIC_USE_RECVMMSG
+  const bool started = !!posix_socket_;
+#else
+  const bool started = !!socket_;
+#endif
+  if (!started) {
+    stopped_ = true;
+    std::move(on_stopped).Run();
+    return;
+  }
+  draining_ = true;
+  on_stopped_callbacks_.push_back(std::move(on_stopped));
+  // Buffered CHLOs are dropped, and new connections are rejected. Packets of
+  // existing sessions are still processed.
+  dispatcher_->StopAcceptingNewConnections();
+  dispatcher_->PerformActionOnActiveSessions([](::quic::QuicSession* session) {
+    // All sessions created by the dispatcher are HTTP/3 sessions.
+    static_cast<::quic::QuicSpdySession*>(session)->SendHttp3GoAway(
+        ::quic::QUIC_PEER_GOING_AWAY, "Server is stopping.");
+  });
+  drain_deadline_ = base::TimeTicks::Now() + drain_timeout_;
+  LOG(INFO) << "Draining " << dispatcher_->NumSessions() << " sessions.";
+  CheckDrained();
+}
+
+void WebTransportOwtServerImpl::CheckDrained() {
+  DCHECK(draining_);
+  const size_t session_count = dispatcher_->NumSessions();
+  if (session_count > 0 && base::TimeTicks::Now() < drain_deadline_) {
+    task_runner_->PostDelayedTask(
+        FROM_HERE,
+        base::BindOnce(&WebTransportOwtServerImpl::CheckDrained,
+                       weak_factory_.GetWeakPtr()),
+        kDrainCheckInterval);
+    return;
+  }
+  LOG_IF(INFO, session_count > 0)
+      << "Drain timeout expired, closing " << session_count << " sessions.";
+  dispatcher_->Shutdown();
+#ifdef OWT_QUIC_USE_RECVMMSG
+  read_watcher_.reset();
+#endif
+  draining_ = false;
+  stopped_ = true;
+  // A callback may destroy this server.
+  std::vector<base::OnceClosure> callbacks;
+  callbacks.swap(on_stopped_callbacks_);
+  for (auto& callback : callbacks) {
+    std::move(callback).Run();
+  }
+}
+
+void WebTransportOwtServerImpl::SetReusePort(bool enabled) {
+  reuse_port_ = enabled;
+}
+
+void WebTransportOwtServerImpl::SetListenPort(uint16_t port) {
+  port_ = port;
+}
+
+uint16_t WebTransportOwtServerImpl::ListenPort() const {
+  return server_address_.port();
+}
 
 void WebTransportOwtServerImpl::SetVisitor(
     WebTransportServerInterface::Visitor* visitor) {
   backend_->SetVisitor(visitor);
 }
 
+void WebTransportOwtServerImpl::SetCongestionControl(
+    CongestionControlAlgorithm algorithm,
+    uint32_t initial_congestion_window) {
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](base::WeakPtr<WebTransportOwtServerImpl> server,
+             CongestionControlAlgorithm algorithm,
+             uint32_t initial_congestion_window) {
+            if (server && server->dispatcher_) {
+              server->dispatcher_->SetCongestionControl(
+                  algorithm, initial_congestion_window);
+            }
+          },
+          weak_factory_.GetWeakPtr(), algorithm, initial_congestion_window));
+}
+
+void WebTransportOwtServerImpl::SetPacketReadBatchSize(uint32_t batch_size) {
+  task_runner_->PostTask(
+      FROM_HERE, base::BindOnce(
+                     [](base::WeakPtr<WebTransportOwtServerImpl> server,
+                        uint32_t batch_size) {
+                       if (server) {
+                         server->packet_read_batch_size_ = batch_size;
+                       }
+                     },
+                     weak_factory_.GetWeakPtr(), batch_size));
+}
+
+void WebTransportOwtServerImpl::SetUdpGroEnabled(bool enabled) {
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](base::WeakPtr<WebTransportOwtServerImpl> server, bool enabled) {
+            if (server) {
+              server->udp_gro_enabled_ = enabled;
+            }
+          },
+          weak_factory_.GetWeakPtr(), enabled));
+}
+
+ServerStats WebTransportOwtServerImpl::GetStats() {
+  ServerStats stats = ServerStats();
+  if (task_runner_->BelongsToCurrentThread()) {
+    FillStatsOnCurrentThread(&stats);
+    return stats;
+  }
+  base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                           base::WaitableEvent::InitialState::NOT_SIGNALED);
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](WebTransportOwtServerImpl* server, ServerStats* stats,
+             base::WaitableEvent* event) {
+            server->FillStatsOnCurrentThread(stats);
+            event->Signal();
+          },
+          base::Unretained(this), base::Unretained(&stats),
+          base::Unretained(&done)));
+  done.Wait();
+  return stats;
+}
+
+void WebTransportOwtServerImpl::FillStatsOnCurrentThread(ServerStats* stats) {
+  DCHECK(task_runner_->BelongsToCurrentThread());
+#ifdef OWT_QUIC_USE_RECVMMSG
+  stats->packet_read_batch_size =
+      batch_reader_ ? batch_reader_->batch_size() : packet_read_batch_size_;
+  stats->packets_read = batch_reader_ ? batch_reader_->packets_read() : 0;
+  stats->packet_read_calls = batch_reader_ ? batch_reader_->read_calls() : 0;
+#else
+  stats->packet_read_batch_size = 1;
+  stats->packets_read = packets_read_;
+  stats->packet_read_calls = packet_read_calls_;
+#endif
+  stats->handshakes_deferred =
+      dispatcher_->handshake_admission().handshakes_deferred();
+  stats->retry_packets_dropped = dispatcher_->retry_packets_dropped();
+  stats->handshakes_rejected =
+      dispatcher_->handshake_admission().handshakes_rejected();
+  stats->full_handshakes = dispatcher_->full_handshakes();
+  stats->resumed_handshakes = dispatcher_->resumed_handshakes();
+  stats->zero_rtt_handshakes = dispatcher_->zero_rtt_handshakes();
+  if (async_proof_source_) {
+    stats->pending_signatures = async_proof_source_->pending_signatures();
+    stats->signatures_computed = async_proof_source_->signatures_computed();
+    stats->signing_time_us =
+        async_proof_source_->total_signing_time().InMicroseconds();
+  }
+}
+
+#ifdef OWT_QUIC_USE_RECVMMSG
+void WebTransportOwtServerImpl::ReadPackets() {
+  dispatcher_->ProcessBufferedChlos(max_new_connections_per_event_);
+  int result = batch_reader_->ReadPackets(
+      posix_socket_->fd(),
+      std::max<size_t>(max_reads_per_event_, batch_reader_->batch_size()),
+      this);
+  if (result == net::OK || result == net::ERR_IO_PENDING) {
+    return;
+  }
+  LOG(ERROR) << "WebTransportOwtServer read failed: "
+             << net::ErrorToString(result);
+  read_watcher_.reset();
+  dispatcher_->Shutdown();
+}
+
+void WebTransportOwtServerImpl::OnPacketRead(
+    const ::quic::QuicReceivedPacket& packet,
+    const ::quic::QuicSocketAddress& peer_address) {
+  dispatcher_->ProcessPacket(self_address_, peer_address, packet);
+}
+#else
 void WebTransportOwtServerImpl::ScheduleReadPackets() {
   task_runner_->PostTask(FROM_HERE,
                          base::BindOnce(&WebTransportOwtServerImpl::ReadPackets,
@@ -153,12 +460,16 @@ void WebTransportOwtServerImpl::ScheduleReadPackets() {
 }
 
 void WebTransportOwtServerImpl::ReadPackets() {
-  dispatcher_->ProcessBufferedChlos(kMaxNewConnectionsPerEvent);
-  for (size_t i = 0; i < kMaxReadsPerEvent; i++) {
+  if (stopped_) {
+    return;
+  }
+  dispatcher_->ProcessBufferedChlos(max_new_connections_per_event_);
+  for (size_t i = 0; i < max_reads_per_event_; i++) {
     int result = socket_->RecvFrom(
         read_buffer_.get(), read_buffer_->size(), &client_address_,
         base::BindOnce(&WebTransportOwtServerImpl::OnReadComplete,
                        base::Unretained(this)));
+    packet_read_calls_++;
     if (result == net::ERR_IO_PENDING) {
       return;
     }
@@ -168,6 +479,9 @@ void WebTransportOwtServerImpl::ReadPackets() {
 }
 
 void WebTransportOwtServerImpl::OnReadComplete(int result) {
+  if (stopped_) {
+    return;
+  }
   ProcessReadPacket(result);
   ReadPackets();
 }
@@ -182,11 +496,13 @@ void WebTransportOwtServerImpl::ProcessReadPacket(int result) {
     return;
   }
 
+  packets_read_++;
   ::quic::QuicReceivedPacket packet(read_buffer_->data(), /*length=*/result,
                                     clock_->Now(), /*owns_buffer=*/false);
   dispatcher_->ProcessPacket(net::ToQuicSocketAddress(server_address_),
                              net::ToQuicSocketAddress(client_address_), packet);
 }
+#endif
 
 void WebTransportOwtServerImpl::OnSession(
     WebTransportSessionInterface* session) {
@@ -18,7 +18,11 @@
 #include <string>
 #include <vector>
 #include "base/memory/scoped_refptr.h"
+#include "base/callback.h"
+#include "base/synchronization/waitable_event.h"
 #include "base/task/single_thread_task_runner.h"
+#include "base/time/time.h"
+#include "build/build_config.h"
 #include "net/base/io_buffer.h"
 #include "net/base/ip_endpoint.h"
 #include "net/quic/platform/impl/quic_chromium_clock.h"
@@ -28,16 +32,27 @@
 #include "net/third_party/quiche/src/quic/core/quic_version_manager.h"
 #include "net/third_party/quiche/src/quic/tools/quic_transport_simple_server_dispatcher.h"
 #include "owt/quic/web_transport_server_interface.h"
+#include "owt/web_transport/sdk/impl/async_proof_source.h"
 #include "owt/web_transport/sdk/impl/web_transport_owt_server_dispatcher.h"
 #include "owt/web_transport/sdk/impl/web_transport_server_backend.h"
 #include "url/origin.h"
 
+#if defined(OS_LINUX) || defined(OS_CHROMEOS) || defined(OS_ANDROID)
+#define OWT_QUIC_USE_RECVMMSG 1
+#include "base/files/file_descriptor_watcher_posix.h"
+#include "owt/web_transport/sdk/impl/udp_batch_reader.h"
+#include "owt/web_transport/sdk/impl/udp_server_socket_posix.h"
+#endif
+
 namespace owt {
 namespace quic {
 // An HTTP/3 server accepts WebTransport connections. HTTP/2 fallback is not
-// supported.
+// supported. On Linux, packets are read in batches by recvmmsg.
 class WebTransportOwtServerImpl
     : public WebTransportServerInterface,
+#ifdef OWT_QUIC_USE_RECVMMSG
+      public UdpBatchReader::Visitor,
+#endif
       public WebTransportOwtServerDispatcher::Visitor {
  public:
   WebTransportOwtServerImpl() = delete;
@@ -45,6 +60,7 @@ class WebTransportOwtServerImpl
       int port,
       std::vector<url::Origin> accepted_origins,
       std::unique_ptr<::quic::ProofSource> proof_source,
+      const ServerOptions& options,
       base::Thread* io_thread,
       base::Thread* event_thread);
   ~WebTransportOwtServerImpl() override;
@@ -52,12 +68,43 @@ class WebTransportOwtServerImpl
   int Start() override;
   void Stop() override;
   void SetVisitor(WebTransportServerInterface::Visitor* visitor) override;
+  void SetCongestionControl(CongestionControlAlgorithm algorithm,
+                            uint32_t initial_congestion_window) override;
+  void SetPacketReadBatchSize(uint32_t batch_size) override;
+  void SetUdpGroEnabled(bool enabled) override;
+  ServerStats GetStats() override;
+
+  // Lets other servers listen on the same port with SO_REUSEPORT. Must be
+  // called before Start. Only supported on Linux.
+  void SetReusePort(bool enabled);
+  // Overrides the port passed to the constructor. Must be called before Start.
+  void SetListenPort(uint16_t port);
+  // Port the server is listening on. Only valid after Start succeeds.
+  uint16_t ListenPort() const;
+  // Stops accepting new connections and sends GOAWAY to existing sessions.
+  // Sessions still open when the drain timeout expires are closed. Then the
+  // server stops reading packets and runs `on_stopped` on IO thread. Calling it
+  // again while draining runs `on_stopped` after the drain, and calling it
+  // after the server is stopped runs `on_stopped` immediately. Stop calls
+  // GracefulStop and notifies the visitor, while a sharded server notifies the
+  // visitor after all shards are stopped.
+  void GracefulStop(base::OnceClosure on_stopped);
 
  protected:
   // Implements WebTransportOwtServerDispatcher::Visitor.
   void OnSession(WebTransportSessionInterface* session) override;
+#ifdef OWT_QUIC_USE_RECVMMSG
+  // Implements UdpBatchReader::Visitor.
+  void OnPacketRead(const ::quic::QuicReceivedPacket& packet,
+                    const ::quic::QuicSocketAddress& peer_address) override;
+#endif
 
  private:
+#ifdef OWT_QUIC_USE_RECVMMSG
+  // Reads a fixed number of packets in batches. Called when the socket is
+  // readable.
+  void ReadPackets();
+#else
   // Schedules a ReadPackets() call on the next iteration of the event loop.
   void ScheduleReadPackets();
   // Reads a fixed number of packets and then reschedules itself.
@@ -66,15 +113,24 @@ class WebTransportOwtServerImpl
   void OnReadComplete(int result);
   // Passes the most recently read packet into the dispatcher.
   void ProcessReadPacket(int result);
+#endif
 
   void StartOnCurrentThread(base::WaitableEvent* done);
+  void GracefulStopOnCurrentThread(base::OnceClosure on_stopped);
+  // Closes remaining sessions and stops reading packets when all sessions are
+  // closed or the drain deadline is reached. Otherwise, checks again later.
+  void CheckDrained();
+  void FillStatsOnCurrentThread(ServerStats* stats);
 
  private:
-  const uint16_t port_;
+  uint16_t port_;
+  bool reuse_port_;
   ::quic::QuicVersionManager version_manager_;
   ::quic::QuicChromiumClock* clock_;  // Not owned.
   ::quic::QuicConfig config_;
   ::quic::QuicCryptoServerConfig crypto_config_;
+  // Owned by `crypto_config_`. Null if signing is synchronous.
+  AsyncProofSource* async_proof_source_;
 
   std::unique_ptr<WebTransportOwtServerDispatcher> dispatcher_;
   std::unique_ptr<net::UDPServerSocket> socket_;
@@ -87,6 +143,30 @@ class WebTransportOwtServerImpl
   scoped_refptr<net::IOBufferWithSize> read_buffer_;
   net::IPEndPoint client_address_;
 
+  const int socket_receive_buffer_size_;
+  const int socket_send_buffer_size_;
+  const size_t max_reads_per_event_;
+  const size_t max_new_connections_per_event_;
+  const base::TimeDelta drain_timeout_;
+
+  // Only accessed on IO thread.
+  uint32_t packet_read_batch_size_;
+  bool udp_gro_enabled_;
+  bool draining_;
+  bool stopped_;
+  base::TimeTicks drain_deadline_;
+  std::vector<base::OnceClosure> on_stopped_callbacks_;
+
+#ifdef OWT_QUIC_USE_RECVMMSG
+  std::unique_ptr<UdpServerSocketPosix> posix_socket_;
+  std::unique_ptr<UdpBatchReader> batch_reader_;
+  std::unique_ptr<base::FileDescriptorWatcher::Controller> read_watcher_;
+  ::quic::QuicSocketAddress self_address_;
+#else
+  uint64_t packets_read_;
+  uint64_t packet_read_calls_;
+#endif
+
   base::WeakPtrFactory<WebTransportOwtServerImpl> weak_factory_{this};
 };
 }  // namespace quic
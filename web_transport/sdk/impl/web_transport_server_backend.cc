@@ -5,6 +5,8 @@
  */
 
 #include "impl/web_transport_server_backend.h"
+#include "base/bind.h"
+#include "impl/http3_server_session.h"
 #include "impl/web_transport_server_session.h"
 
 namespace owt {
@@ -28,6 +30,17 @@ void WebTransportServerBackend::SetVisitor(
   visitor_ = visitor;
 }
 
+void WebTransportServerBackend::OnServerEnded() {
+  DCHECK(io_thread_checker_.CalledOnValidThread());
+  if (!visitor_) {
+    return;
+  }
+  event_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&WebTransportServerInterface::Visitor::OnEnded,
+                     base::Unretained(visitor_)));
+}
+
 void WebTransportServerBackend::OnSessionReady(
     ::quic::WebTransportHttp3* session,
     ::quic::QuicSpdySession* http3_session) {
@@ -38,12 +51,20 @@ void WebTransportServerBackend::OnSessionReady(
       std::make_unique<WebTransportServerSession>(session, http3_session,
                                                   io_runner_, event_runner_);
   WebTransportServerSession* session_ptr = wt_session.get();
-  if (sessions_.count(http3_session->connection_id().ToString()) > 0) {
+  const std::string connection_id = http3_session->connection_id().ToString();
+  auto old_session = sessions_.find(connection_id);
+  if (old_session != sessions_.end()) {
     LOG(WARNING) << "Session with the same connection ID exits, the old one "
                     "will be terminated. Only one WebTransport session for a "
                     "QUIC connection is supported.";
+    // Destroy the old session before observing `http3_session` for the new
+    // one, so it doesn't reset the new observer.
+    sessions_.erase(old_session);
   }
-  sessions_[http3_session->connection_id().ToString()] = std::move(wt_session);
+  // Only Http3ServerSession creates streams reporting to this backend.
+  static_cast<Http3ServerSession*>(http3_session)
+      ->SetCongestionObserver(session_ptr);
+  sessions_[connection_id] = std::move(wt_session);
   if (visitor_) {
     visitor_->OnSession(session_ptr);
   } else {
@@ -34,6 +34,8 @@ class WebTransportServerBackend : public WebTransportSessionVisitor {
   ~WebTransportServerBackend() override;
 
   void SetVisitor(WebTransportServerInterface::Visitor* visitor);
+  // Notifies the visitor on event thread that the server is stopped.
+  void OnServerEnded();
 
   // Overrides WebTransportSessionVisitor.
   void OnSessionReady(::quic::WebTransportHttp3* session,
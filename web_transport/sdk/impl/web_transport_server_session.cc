@@ -18,11 +18,27 @@
 #include "impl/web_transport_stream_impl.h"
 #include "net/third_party/quiche/src/quic/core/http/quic_server_initiated_spdy_stream.h"
 #include "net/third_party/quiche/src/quic/core/http/quic_spdy_stream.h"
+#include "net/third_party/quiche/src/quic/core/quic_sent_packet_manager.h"
 #include "owt/web_transport/sdk/impl/utilities.h"
 
 namespace owt {
 namespace quic {
 
+namespace {
+// Returns true if `current` differs from `previous` by at least `percent`
+// percent of `previous`. Always returns false when `percent` is 0.
+bool ChangedBeyondThreshold(uint64_t previous,
+                            uint64_t current,
+                            uint32_t percent) {
+  if (percent == 0 || previous == current) {
+    return false;
+  }
+  uint64_t difference =
+      previous > current ? previous - current : current - previous;
+  return difference * 100 >= previous * percent;
+}
+}  // namespace
+
 // Copied from net/quic/dedicated_web_transport_http3_client.cc.
 class WebTransportVisitorProxy : public ::quic::WebTransportVisitor {
  public:
@@ -65,7 +81,17 @@ WebTransportServerSession::WebTransportServerSession(
       http3_session_(http3_session),
       io_runner_(io_runner),
       event_runner_(event_runner),
-      visitor_(nullptr) {
+      visitor_(nullptr),
+      closed_(false),
+      batched_stream_events_(false),
+      stream_events_flush_scheduled_(false),
+      batched_datagram_delivery_(false),
+      datagrams_flush_scheduled_(false),
+      network_estimate_enabled_(false),
+      network_estimate_thresholds_(),
+      network_estimate_reported_(false),
+      last_network_estimate_(),
+      last_network_estimate_time_(::quic::QuicTime::Zero()) {
   CHECK(session_);
   CHECK(http3_session_);
   CHECK(io_runner_);
@@ -73,7 +99,12 @@ WebTransportServerSession::WebTransportServerSession(
   session_->SetVisitor(std::make_unique<WebTransportVisitorProxy>(this));
 }
 
-WebTransportServerSession::~WebTransportServerSession() {}
+WebTransportServerSession::~WebTransportServerSession() {
+  ResetCongestionObserver();
+  for (ReceivedDatagram* datagram : received_datagrams_) {
+    datagram->Release();
+  }
+}
 
 WebTransportStreamInterface*
 WebTransportServerSession::CreateBidirectionalStream() {
@@ -136,9 +167,10 @@ WebTransportServerSession::CreateBidirectionalStreamOnCurrentThread() {
       std::make_unique<WebTransportStreamImpl>(
           wt_stream,
           http3_session_->GetOrCreateStream(wt_stream->GetStreamId()),
-          io_runner_, event_runner_);
+          io_runner_, event_runner_, this);
+  stream->SetBatchedEvents(batched_stream_events_);
   WebTransportStreamInterface* stream_ptr(stream.get());
-  streams_.push_back(std::move(stream));
+  streams_[stream_ptr->Id()] = std::move(stream);
   return stream_ptr;
 }
 
@@ -146,6 +178,83 @@ uint64_t WebTransportServerSession::SessionId() const {
   return session_->id();
 }
 
+AsyncIoStatus WebTransportServerSession::SendOrQueueDatagramAsync(
+    const uint8_t* data,
+    size_t length,
+    BufferReleaser* releaser) {
+  CHECK(releaser);
+  DCHECK_GT(length, 0u);
+  if (closed_) {
+    return AsyncIoStatus::kClosed;
+  }
+  ::quic::QuicMemSlice slice =
+      Utilities::WrapAsMemSlice(data, length, releaser);
+  if (io_runner_->BelongsToCurrentThread()) {
+    SendOrQueueDatagramOnCurrentThread(std::move(slice));
+  } else {
+    io_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(
+            &WebTransportServerSession::SendOrQueueDatagramOnCurrentThread,
+            weak_factory_.GetWeakPtr(), std::move(slice)));
+  }
+  return AsyncIoStatus::kAccepted;
+}
+
+void WebTransportServerSession::SendOrQueueDatagramOnCurrentThread(
+    ::quic::QuicMemSlice slice) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (closed_) {
+    return;
+  }
+  ::quic::MessageStatus status =
+      session_->SendOrQueueDatagram(std::move(slice));
+  if (status != ::quic::MESSAGE_STATUS_SUCCESS) {
+    DVLOG(1) << "Failed to send datagram, status: " << status;
+  }
+}
+
+void WebTransportServerSession::SendDatagrams(const DataSpan* datagrams,
+                                              size_t datagram_count,
+                                              MessageStatus* statuses) {
+  std::vector<::quic::QuicMemSlice> slices;
+  slices.reserve(datagram_count);
+  for (size_t i = 0; i < datagram_count; i++) {
+    slices.push_back(Utilities::CopyToMemSlice(&datagrams[i], 1));
+  }
+  if (io_runner_->BelongsToCurrentThread()) {
+    SendDatagramsOnCurrentThread(std::move(slices), statuses);
+    return;
+  }
+  base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                           base::WaitableEvent::InitialState::NOT_SIGNALED);
+  io_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](WebTransportServerSession* session,
+             std::vector<::quic::QuicMemSlice> slices, MessageStatus* statuses,
+             base::WaitableEvent* event) {
+            session->SendDatagramsOnCurrentThread(std::move(slices), statuses);
+            event->Signal();
+          },
+          base::Unretained(this), std::move(slices), base::Unretained(statuses),
+          base::Unretained(&done)));
+  done.Wait();
+}
+
+void WebTransportServerSession::SendDatagramsOnCurrentThread(
+    std::vector<::quic::QuicMemSlice> slices,
+    MessageStatus* statuses) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  // Datagrams are bundled until `flusher` goes out of scope.
+  ::quic::QuicConnection::ScopedPacketFlusher flusher(
+      http3_session_->connection());
+  for (size_t i = 0; i < slices.size(); i++) {
+    statuses[i] = Utilities::ConvertMessageStatus(
+        session_->SendOrQueueDatagram(std::move(slices[i])));
+  }
+}
+
 const char* WebTransportServerSession::ConnectionId() const {
   const std::string& session_id_str =
       http3_session_->connection_id().ToString();
@@ -164,10 +273,212 @@ void WebTransportServerSession::SetVisitor(
   visitor_ = visitor;
 }
 
-const ConnectionStats& WebTransportServerSession::GetStats() {
-  const auto& stats = http3_session_->connection()->GetStats();
-  stats_.estimated_bandwidth = stats.estimated_bandwidth.ToBitsPerSecond();
-  return stats_;
+ConnectionStats WebTransportServerSession::GetStats() {
+  ConnectionStats stats = ConnectionStats();
+  if (io_runner_->BelongsToCurrentThread()) {
+    FillStatsOnCurrentThread(&stats);
+    return stats;
+  }
+  base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                           base::WaitableEvent::InitialState::NOT_SIGNALED);
+  io_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](WebTransportServerSession* session, ConnectionStats* stats,
+             base::WaitableEvent* event) {
+            session->FillStatsOnCurrentThread(stats);
+            event->Signal();
+          },
+          base::Unretained(this), base::Unretained(&stats),
+          base::Unretained(&done)));
+  done.Wait();
+  return stats;
+}
+
+void WebTransportServerSession::FillStatsOnCurrentThread(
+    ConnectionStats* stats) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  Utilities::FillConnectionStats(http3_session_, stats);
+  for (const auto& stream : streams_) {
+    stats->stream_buffered_bytes += stream.second->BufferedDataBytes();
+  }
+}
+
+void WebTransportServerSession::SetBatchedStreamEvents(bool enabled) {
+  if (io_runner_->BelongsToCurrentThread()) {
+    SetBatchedStreamEventsOnCurrentThread(enabled);
+    return;
+  }
+  io_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          &WebTransportServerSession::SetBatchedStreamEventsOnCurrentThread,
+          weak_factory_.GetWeakPtr(), enabled));
+}
+
+void WebTransportServerSession::SetBatchedStreamEventsOnCurrentThread(
+    bool enabled) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  batched_stream_events_ = enabled;
+  for (auto& stream : streams_) {
+    stream.second->SetBatchedEvents(enabled);
+  }
+}
+
+void WebTransportServerSession::SetBatchedDatagramDelivery(bool enabled) {
+  if (io_runner_->BelongsToCurrentThread()) {
+    SetBatchedDatagramDeliveryOnCurrentThread(enabled);
+    return;
+  }
+  io_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          &WebTransportServerSession::SetBatchedDatagramDeliveryOnCurrentThread,
+          weak_factory_.GetWeakPtr(), enabled));
+}
+
+void WebTransportServerSession::SetBatchedDatagramDeliveryOnCurrentThread(
+    bool enabled) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  batched_datagram_delivery_ = enabled;
+}
+
+void WebTransportServerSession::SetNetworkEstimateThresholds(
+    const NetworkEstimateThresholds* thresholds) {
+  bool enabled = thresholds != nullptr;
+  NetworkEstimateThresholds thresholds_copy =
+      enabled ? *thresholds : NetworkEstimateThresholds();
+  if (io_runner_->BelongsToCurrentThread()) {
+    SetNetworkEstimateThresholdsOnCurrentThread(enabled, thresholds_copy);
+    return;
+  }
+  io_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&WebTransportServerSession::
+                         SetNetworkEstimateThresholdsOnCurrentThread,
+                     weak_factory_.GetWeakPtr(), enabled, thresholds_copy));
+}
+
+void WebTransportServerSession::SetNetworkEstimateThresholdsOnCurrentThread(
+    bool enabled,
+    NetworkEstimateThresholds thresholds) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  network_estimate_enabled_ = enabled;
+  network_estimate_thresholds_ = thresholds;
+  network_estimate_reported_ = false;
+}
+
+void WebTransportServerSession::SetCongestionControl(
+    CongestionControlAlgorithm algorithm,
+    uint32_t initial_congestion_window) {
+  if (io_runner_->BelongsToCurrentThread()) {
+    SetCongestionControlOnCurrentThread(algorithm, initial_congestion_window);
+    return;
+  }
+  io_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          &WebTransportServerSession::SetCongestionControlOnCurrentThread,
+          weak_factory_.GetWeakPtr(), algorithm, initial_congestion_window));
+}
+
+void WebTransportServerSession::SetCongestionControlOnCurrentThread(
+    CongestionControlAlgorithm algorithm,
+    uint32_t initial_congestion_window) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (closed_) {
+    return;
+  }
+  Utilities::ApplyCongestionControl(http3_session_->connection(), algorithm,
+                                    initial_congestion_window);
+}
+
+void WebTransportServerSession::SetCongestionController(
+    CongestionControllerInterface* controller) {
+  CHECK(controller);
+  std::unique_ptr<CongestionControllerInterface> controller_owned(controller);
+  if (io_runner_->BelongsToCurrentThread()) {
+    SetCongestionControllerOnCurrentThread(std::move(controller_owned));
+    return;
+  }
+  io_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          &WebTransportServerSession::SetCongestionControllerOnCurrentThread,
+          weak_factory_.GetWeakPtr(), std::move(controller_owned)));
+}
+
+void WebTransportServerSession::SetCongestionControllerOnCurrentThread(
+    std::unique_ptr<CongestionControllerInterface> controller) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (closed_) {
+    return;
+  }
+  Utilities::InstallCongestionController(http3_session_->connection(),
+                                         std::move(controller));
+}
+
+void WebTransportServerSession::OnHttp3SessionDestroyed() {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  // `session_` is owned by `http3_session_`.
+  session_ = nullptr;
+  http3_session_ = nullptr;
+}
+
+void WebTransportServerSession::ResetCongestionObserver() {
+  if (!http3_session_) {
+    return;
+  }
+  Http3ServerSession* http3_session =
+      static_cast<Http3ServerSession*>(http3_session_);
+  // A newer session for the same connection may have replaced this one as the
+  // observer.
+  if (http3_session->congestion_observer() == this) {
+    http3_session->SetCongestionObserver(nullptr);
+  }
+}
+
+void WebTransportServerSession::OnCongestionWindowChange(::quic::QuicTime now) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (!network_estimate_enabled_ || !visitor_ || closed_) {
+    return;
+  }
+  if (network_estimate_reported_ &&
+      now - last_network_estimate_time_ <
+          ::quic::QuicTime::Delta::FromMilliseconds(
+              network_estimate_thresholds_.min_interval_ms)) {
+    return;
+  }
+  const ::quic::QuicSentPacketManager& sent_packet_manager =
+      http3_session_->connection()->sent_packet_manager();
+  const ::quic::RttStats* rtt_stats = sent_packet_manager.GetRttStats();
+  NetworkEstimate estimate;
+  estimate.estimated_bandwidth =
+      sent_packet_manager.BandwidthEstimate().ToBitsPerSecond();
+  estimate.smoothed_rtt_us = rtt_stats->smoothed_rtt().ToMicroseconds();
+  estimate.min_rtt_us = rtt_stats->min_rtt().ToMicroseconds();
+  estimate.congestion_window = sent_packet_manager.GetCongestionWindowInBytes();
+  estimate.pacing_rate =
+      sent_packet_manager.GetSendAlgorithm()
+          ->PacingRate(sent_packet_manager.GetBytesInFlight())
+          .ToBitsPerSecond();
+  if (network_estimate_reported_ &&
+      !ChangedBeyondThreshold(
+          last_network_estimate_.estimated_bandwidth,
+          estimate.estimated_bandwidth,
+          network_estimate_thresholds_.bandwidth_change_percent) &&
+      !ChangedBeyondThreshold(
+          last_network_estimate_.smoothed_rtt_us, estimate.smoothed_rtt_us,
+          network_estimate_thresholds_.rtt_change_percent) &&
+      !ChangedBeyondThreshold(
+          last_network_estimate_.congestion_window, estimate.congestion_window,
+          network_estimate_thresholds_.congestion_window_change_percent)) {
+    return;
+  }
+  network_estimate_reported_ = true;
+  last_network_estimate_ = estimate;
+  last_network_estimate_time_ = now;
+  visitor_->OnNetworkEstimateChanged(estimate);
 }
 
 void WebTransportServerSession::Close(uint32_t code, const char* reason) {
@@ -205,8 +516,11 @@ void WebTransportServerSession::OnIncomingUnidirectionalStreamAvailable() {
 void WebTransportServerSession::OnSessionClosed(
     ::quic::WebTransportSessionError error_code,
     const std::string& error_message) {
+  closed_ = true;
+  // No more network estimates after the session is closed.
+  ResetCongestionObserver();
   for (auto& stream : streams_) {
-    stream->OnSessionClosed();
+    stream.second->OnSessionClosed();
   }
   if (visitor_) {
     visitor_->OnConnectionClosed();
@@ -218,19 +532,104 @@ void WebTransportServerSession::AcceptIncomingStream(
   std::unique_ptr<WebTransportStreamImpl> wt_stream =
       std::make_unique<WebTransportStreamImpl>(
           stream, http3_session_->GetOrCreateStream(stream->GetStreamId()),
-          io_runner_, event_runner_);
+          io_runner_, event_runner_, this);
+  wt_stream->SetBatchedEvents(batched_stream_events_);
   WebTransportStreamInterface* stream_ptr = wt_stream.get();
-  streams_.push_back(std::move(wt_stream));
+  streams_[stream_ptr->Id()] = std::move(wt_stream);
   if (visitor_) {
     visitor_->OnIncomingStream(stream_ptr);
   }
 }
 
+void WebTransportServerSession::OnStreamClosed(
+    WebTransportStreamImpl* stream) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  auto it = streams_.find(stream->Id());
+  DCHECK(it != streams_.end() && it->second.get() == stream);
+  if (it != streams_.end()) {
+    streams_.erase(it);
+  }
+}
+
+void WebTransportServerSession::OnStreamReady(WebTransportStreamImpl* stream,
+                                              bool readable) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (readable) {
+    readable_stream_ids_.insert(stream->Id());
+  } else {
+    writable_stream_ids_.insert(stream->Id());
+  }
+  if (stream_events_flush_scheduled_) {
+    return;
+  }
+  // Events are reported after the current task, which processes a batch of
+  // incoming packets.
+  stream_events_flush_scheduled_ = true;
+  io_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&WebTransportServerSession::FlushStreamEvents,
+                                weak_factory_.GetWeakPtr()));
+}
+
+void WebTransportServerSession::FlushStreamEvents() {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  stream_events_flush_scheduled_ = false;
+  readable_streams_.clear();
+  writable_streams_.clear();
+  // Streams closed after their events are recorded are skipped.
+  for (uint32_t id : readable_stream_ids_) {
+    auto it = streams_.find(id);
+    if (it != streams_.end()) {
+      readable_streams_.push_back(it->second.get());
+    }
+  }
+  for (uint32_t id : writable_stream_ids_) {
+    auto it = streams_.find(id);
+    if (it != streams_.end()) {
+      writable_streams_.push_back(it->second.get());
+    }
+  }
+  readable_stream_ids_.clear();
+  writable_stream_ids_.clear();
+  if (!visitor_ || (readable_streams_.empty() && writable_streams_.empty())) {
+    return;
+  }
+  visitor_->OnStreamsReady(readable_streams_.data(), readable_streams_.size(),
+                           writable_streams_.data(), writable_streams_.size());
+}
+
 void WebTransportServerSession::OnDatagramReceived(absl::string_view datagram) {
-  if (visitor_) {
-    visitor_->OnDatagramReceived(
-        reinterpret_cast<const uint8_t*>(datagram.data()), datagram.size());
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (!batched_datagram_delivery_) {
+    if (visitor_) {
+      visitor_->OnDatagramReceived(
+          reinterpret_cast<const uint8_t*>(datagram.data()), datagram.size());
+    }
+    return;
+  }
+  received_datagrams_.push_back(ReceivedDatagramImpl::Create(
+      datagram, http3_session_->connection()->clock()->ApproximateNow()));
+  if (datagrams_flush_scheduled_) {
+    return;
+  }
+  // Datagrams are reported after the current task, which processes a batch of
+  // incoming packets.
+  datagrams_flush_scheduled_ = true;
+  io_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&WebTransportServerSession::FlushDatagrams,
+                                weak_factory_.GetWeakPtr()));
+}
+
+void WebTransportServerSession::FlushDatagrams() {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  datagrams_flush_scheduled_ = false;
+  if (visitor_ && !received_datagrams_.empty()) {
+    visitor_->OnDatagramsReceived(received_datagrams_.data(),
+                                  received_datagrams_.size());
+  }
+  for (ReceivedDatagram* datagram : received_datagrams_) {
+    datagram->Release();
   }
+  received_datagrams_.clear();
 }
 
 }  // namespace quic
@@ -11,20 +11,29 @@
 #ifndef OWT_QUIC_WEB_TRANSPORT_WEB_TRANSPORT_SERVER_SESSION_H_
 #define OWT_QUIC_WEB_TRANSPORT_WEB_TRANSPORT_SERVER_SESSION_H_
 
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "base/containers/flat_set.h"
+#include "base/memory/weak_ptr.h"
 #include "base/task/single_thread_task_runner.h"
 #include "impl/http3_server_session.h"
+#include "impl/received_datagram_impl.h"
+#include "impl/web_transport_stream_impl.h"
 #include "net/third_party/quiche/src/quic/core/http/web_transport_http3.h"
 #include "owt/quic/web_transport_session_interface.h"
 
 namespace owt {
 namespace quic {
 
-class WebTransportStreamImpl;
-
 // A proxy of ::quic::WebTransportHttp3. WebTransport over HTTP/2 is not
 // supported.
-class WebTransportServerSession : public WebTransportSessionInterface,
-                                  public ::quic::WebTransportVisitor {
+class WebTransportServerSession
+    : public WebTransportSessionInterface,
+      public ::quic::WebTransportVisitor,
+      public WebTransportStreamImpl::Delegate,
+      public Http3ServerSession::CongestionObserver {
  public:
   explicit WebTransportServerSession(
       ::quic::WebTransportHttp3* session,
@@ -42,8 +51,21 @@ class WebTransportServerSession : public WebTransportSessionInterface,
   bool IsSessionReady() const override;
   WebTransportStreamInterface* CreateBidirectionalStream() override;
   MessageStatus SendOrQueueDatagram(uint8_t* data, size_t length) override;
-  // TODO: This method is not implemented.
-  const ConnectionStats& GetStats() override;
+  AsyncIoStatus SendOrQueueDatagramAsync(const uint8_t* data,
+                                         size_t length,
+                                         BufferReleaser* releaser) override;
+  void SendDatagrams(const DataSpan* datagrams,
+                     size_t datagram_count,
+                     MessageStatus* statuses) override;
+  void SetBatchedStreamEvents(bool enabled) override;
+  void SetBatchedDatagramDelivery(bool enabled) override;
+  void SetNetworkEstimateThresholds(
+      const NetworkEstimateThresholds* thresholds) override;
+  void SetCongestionControl(CongestionControlAlgorithm algorithm,
+                            uint32_t initial_congestion_window) override;
+  void SetCongestionController(
+      CongestionControllerInterface* controller) override;
+  ConnectionStats GetStats() override;
   void Close(uint32_t code, const char* reason) override;
 
   // Overrides ::quic::WebTransportVisitor.
@@ -56,6 +78,14 @@ class WebTransportServerSession : public WebTransportSessionInterface,
   void OnCanCreateNewOutgoingUnidirectionalStream() override {}
   void OnCanCreateNewOutgoingBidirectionalStream() override {}
 
+  // Overrides WebTransportStreamImpl::Delegate.
+  void OnStreamClosed(WebTransportStreamImpl* stream) override;
+  void OnStreamReady(WebTransportStreamImpl* stream, bool readable) override;
+
+  // Overrides Http3ServerSession::CongestionObserver.
+  void OnCongestionWindowChange(::quic::QuicTime now) override;
+  void OnHttp3SessionDestroyed() override;
+
   void AcceptIncomingStream(::quic::WebTransportStream* stream);
 
  protected:
@@ -63,14 +93,61 @@ class WebTransportServerSession : public WebTransportSessionInterface,
 
  private:
   void CloseOnCurrentThread(uint32_t code, const char* reason);
+  void SetBatchedStreamEventsOnCurrentThread(bool enabled);
+  void FillStatsOnCurrentThread(ConnectionStats* stats);
+  void SetBatchedDatagramDeliveryOnCurrentThread(bool enabled);
+  void SetNetworkEstimateThresholdsOnCurrentThread(
+      bool enabled,
+      NetworkEstimateThresholds thresholds);
+  void SetCongestionControlOnCurrentThread(
+      CongestionControlAlgorithm algorithm,
+      uint32_t initial_congestion_window);
+  void SetCongestionControllerOnCurrentThread(
+      std::unique_ptr<CongestionControllerInterface> controller);
+  void SendOrQueueDatagramOnCurrentThread(::quic::QuicMemSlice slice);
+  void SendDatagramsOnCurrentThread(std::vector<::quic::QuicMemSlice> slices,
+                                    MessageStatus* statuses);
+  // Reports streams collected by OnStreamReady to visitor.
+  void FlushStreamEvents();
+  // Reports datagrams collected by OnDatagramReceived to visitor.
+  void FlushDatagrams();
+  // Stops observing `http3_session_` if this session is still its observer.
+  void ResetCongestionObserver();
 
   ::quic::WebTransportHttp3* session_;
+  // Both are reset to nullptr when `http3_session_` is destroyed before this
+  // session.
   ::quic::QuicSpdySession* http3_session_;
   base::SingleThreadTaskRunner* io_runner_;
   base::SingleThreadTaskRunner* event_runner_;
-  std::vector<std::unique_ptr<WebTransportStreamImpl>> streams_;
+  // Open streams indexed by stream ID. Closed streams are removed.
+  std::unordered_map<uint32_t, std::unique_ptr<WebTransportStreamImpl>>
+      streams_;
   WebTransportSessionInterface::Visitor* visitor_;
-  ConnectionStats stats_;
+  // Written on IO thread, read on any thread.
+  std::atomic<bool> closed_;
+  bool batched_stream_events_;
+  // IDs of streams that become readable or writable since last
+  // FlushStreamEvents.
+  base::flat_set<uint32_t> readable_stream_ids_;
+  base::flat_set<uint32_t> writable_stream_ids_;
+  bool stream_events_flush_scheduled_;
+  // Reused by FlushStreamEvents to avoid allocations.
+  std::vector<WebTransportStreamInterface*> readable_streams_;
+  std::vector<WebTransportStreamInterface*> writable_streams_;
+  bool batched_datagram_delivery_;
+  // Datagrams received since last FlushDatagrams. Each of them holds a
+  // reference owned by this session.
+  std::vector<ReceivedDatagram*> received_datagrams_;
+  bool datagrams_flush_scheduled_;
+  bool network_estimate_enabled_;
+  NetworkEstimateThresholds network_estimate_thresholds_;
+  // Last estimate reported to visitor. Only valid when
+  // `network_estimate_reported_` is true.
+  bool network_estimate_reported_;
+  NetworkEstimate last_network_estimate_;
+  ::quic::QuicTime last_network_estimate_time_;
+  base::WeakPtrFactory<WebTransportServerSession> weak_factory_{this};
 };
 }  // namespace quic
 }  // namespace owt
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/web_transport_sharded_server.h"
+#include <string>
+#include "base/barrier_closure.h"
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/check.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/waitable_event.h"
+#include "impl/handshake_admission.h"
+#include "url/origin.h"
+
+namespace owt {
+namespace quic {
+
+namespace {
+// Handshake limits in `options` are for the whole server. Each shard gets an
+// equal part, rounded up.
+ServerOptions OptionsForShard(const ServerOptions& options,
+                              size_t shard_count) {
+  ServerOptions shard_options = options;
+  shard_options.max_handshakes_per_second =
+      (options.max_handshakes_per_second + shard_count - 1) / shard_count;
+  const size_t max_pending_handshakes =
+      options.max_pending_handshakes > 0
+          ? options.max_pending_handshakes
+          : HandshakeAdmission::kDefaultMaxPendingHandshakes;
+  shard_options.max_pending_handshakes =
+      (max_pending_handshakes + shard_count - 1) / shard_count;
+  return shard_options;
+}
+}  // namespace
+
+WebTransportShardedServer::WebTransportShardedServer(
+    int port,
+    std::vector<std::unique_ptr<::quic::ProofSource>> proof_sources,
+    const ServerOptions& options,
+    base::Thread* event_thread)
+    : event_runner_(event_thread->task_runner()),
+      visitor_(nullptr) {
+  CHECK(!proof_sources.empty());
+  const ServerOptions shard_options =
+      OptionsForShard(options, proof_sources.size());
+  for (size_t i = 0; i < proof_sources.size(); i++) {
+    auto io_thread = std::make_unique<base::Thread>(
+        "web_transport_server_io_thread_" + base::NumberToString(i));
+    io_thread->StartWithOptions(
+        base::Thread::Options(base::MessagePumpType::IO, 0));
+    // Like WebTransportFactoryImpl, a server is created on its IO thread.
+    WebTransportOwtServerImpl* shard(nullptr);
+    base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                             base::WaitableEvent::InitialState::NOT_SIGNALED);
+    io_thread->task_runner()->PostTask(
+        FROM_HERE,
+        base::BindOnce(
+            [](int port, std::unique_ptr<::quic::ProofSource> proof_source,
+               const ServerOptions& options, base::Thread* io_thread,
+               base::Thread* event_thread, WebTransportOwtServerImpl** result,
+               base::WaitableEvent* event) {
+              *result = new WebTransportOwtServerImpl(
+                  port, std::vector<url::Origin>(), std::move(proof_source),
+                  options, io_thread, event_thread);
+              event->Signal();
+            },
+            port, std::move(proof_sources[i]), shard_options,
+            base::Unretained(io_thread.get()), base::Unretained(event_thread),
+            base::Unretained(&shard), base::Unretained(&done)));
+    done.Wait();
+    shard->SetReusePort(true);
+    io_threads_.push_back(std::move(io_thread));
+    shards_.emplace_back(shard);
+  }
+}
+
+WebTransportShardedServer::~WebTransportShardedServer() {
+  // Each shard is destroyed on its IO thread, so threads must be running.
+  shards_.clear();
+  for (auto& io_thread : io_threads_) {
+    io_thread->Stop();
+  }
+}
+
+int WebTransportShardedServer::Start() {
+  // The first shard picks a port if it's not specified. Others listen on the
+  // same port.
+  int result = shards_[0]->Start();
+  if (result != EXIT_SUCCESS) {
+    return result;
+  }
+  const uint16_t port = shards_[0]->ListenPort();
+  for (size_t i = 1; i < shards_.size(); i++) {
+    shards_[i]->SetListenPort(port);
+    result = shards_[i]->Start();
+    if (result != EXIT_SUCCESS) {
+      LOG(ERROR) << "Failed to start server shard " << i << ".";
+      StopShards(i);
+      return result;
+    }
+  }
+  LOG(INFO) << "WebTransport server runs " << shards_.size()
+            << " shards on port " << port;
+  return EXIT_SUCCESS;
+}
+
+void WebTransportShardedServer::Stop() {
+  // Shards drain in parallel. The visitor is notified once when the last shard
+  // is stopped.
+  base::RepeatingClosure on_shard_stopped = base::BarrierClosure(
+      shards_.size(),
+      base::BindOnce(
+          [](scoped_refptr<base::SingleThreadTaskRunner> event_runner,
+             WebTransportServerInterface::Visitor* visitor) {
+            if (!visitor) {
+              return;
+            }
+            event_runner->PostTask(
+                FROM_HERE,
+                base::BindOnce(&WebTransportServerInterface::Visitor::OnEnded,
+                               base::Unretained(visitor)));
+          },
+          event_runner_, base::Unretained(visitor_)));
+  for (auto& shard : shards_) {
+    shard->GracefulStop(on_shard_stopped);
+  }
+}
+
+void WebTransportShardedServer::SetVisitor(
+    WebTransportServerInterface::Visitor* visitor) {
+  visitor_ = visitor;
+  for (auto& shard : shards_) {
+    shard->SetVisitor(visitor);
+  }
+}
+
+void WebTransportShardedServer::SetCongestionControl(
+    CongestionControlAlgorithm algorithm,
+    uint32_t initial_congestion_window) {
+  for (auto& shard : shards_) {
+    shard->SetCongestionControl(algorithm, initial_congestion_window);
+  }
+}
+
+void WebTransportShardedServer::SetPacketReadBatchSize(uint32_t batch_size) {
+  for (auto& shard : shards_) {
+    shard->SetPacketReadBatchSize(batch_size);
+  }
+}
+
+void WebTransportShardedServer::SetUdpGroEnabled(bool enabled) {
+  for (auto& shard : shards_) {
+    shard->SetUdpGroEnabled(enabled);
+  }
+}
+
+ServerStats WebTransportShardedServer::GetStats() {
+  ServerStats stats = ServerStats();
+  for (auto& shard : shards_) {
+    ServerStats shard_stats = shard->GetStats();
+    stats.packet_read_batch_size = shard_stats.packet_read_batch_size;
+    stats.packets_read += shard_stats.packets_read;
+    stats.packet_read_calls += shard_stats.packet_read_calls;
+    stats.handshakes_deferred += shard_stats.handshakes_deferred;
+    stats.retry_packets_dropped += shard_stats.retry_packets_dropped;
+    stats.handshakes_rejected += shard_stats.handshakes_rejected;
+    stats.full_handshakes += shard_stats.full_handshakes;
+    stats.resumed_handshakes += shard_stats.resumed_handshakes;
+    stats.zero_rtt_handshakes += shard_stats.zero_rtt_handshakes;
+    stats.pending_signatures += shard_stats.pending_signatures;
+    stats.signatures_computed += shard_stats.signatures_computed;
+    stats.signing_time_us += shard_stats.signing_time_us;
+  }
+  return stats;
+}
+
+void WebTransportShardedServer::StopShards(size_t count) {
+  // Shards just started have no sessions, so they stop right away.
+  for (size_t i = 0; i < count; i++) {
+    shards_[i]->GracefulStop(base::DoNothing());
+  }
+}
+
+}  // namespace quic
+}  // namespace owt
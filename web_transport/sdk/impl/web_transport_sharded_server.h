@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OWT_QUIC_WEB_TRANSPORT_WEB_TRANSPORT_SHARDED_SERVER_H_
+#define OWT_QUIC_WEB_TRANSPORT_WEB_TRANSPORT_SHARDED_SERVER_H_
+
+#include <memory>
+#include <vector>
+#include "base/memory/scoped_refptr.h"
+#include "base/task/single_thread_task_runner.h"
+#include "base/threading/thread.h"
+#include "net/third_party/quiche/src/quic/core/crypto/proof_source.h"
+#include "owt/quic/web_transport_server_interface.h"
+#include "owt/web_transport/sdk/impl/web_transport_owt_server_impl.h"
+
+namespace owt {
+namespace quic {
+
+// A WebTransport server listening on one port with several SO_REUSEPORT
+// sockets. Each socket is served by a shard, which is a
+// WebTransportOwtServerImpl running on its own IO thread with its own
+// dispatcher and crypto config. The kernel distributes incoming connections
+// among shards by 4-tuple hash. All shards share `event_thread`, so sessions
+// from all of them are reported to one visitor on the same thread. Linux only.
+class WebTransportShardedServer : public WebTransportServerInterface {
+ public:
+  // One shard is created for each proof source. `options` are applied to
+  // every shard.
+  WebTransportShardedServer(
+      int port,
+      std::vector<std::unique_ptr<::quic::ProofSource>> proof_sources,
+      const ServerOptions& options,
+      base::Thread* event_thread);
+  ~WebTransportShardedServer() override;
+  WebTransportShardedServer(const WebTransportShardedServer&) = delete;
+  WebTransportShardedServer& operator=(const WebTransportShardedServer&) =
+      delete;
+
+  // Overrides WebTransportServerInterface.
+  int Start() override;
+  void Stop() override;
+  void SetVisitor(WebTransportServerInterface::Visitor* visitor) override;
+  void SetCongestionControl(CongestionControlAlgorithm algorithm,
+                            uint32_t initial_congestion_window) override;
+  void SetPacketReadBatchSize(uint32_t batch_size) override;
+  void SetUdpGroEnabled(bool enabled) override;
+  ServerStats GetStats() override;
+
+  size_t shard_count() const { return shards_.size(); }
+
+ private:
+  // Stops the first `count` shards after another shard fails to start.
+  void StopShards(size_t count);
+
+  std::vector<std::unique_ptr<base::Thread>> io_threads_;
+  // Shards are destroyed before `io_threads_`.
+  std::vector<std::unique_ptr<WebTransportOwtServerImpl>> shards_;
+  scoped_refptr<base::SingleThreadTaskRunner> event_runner_;
+  WebTransportServerInterface::Visitor* visitor_;
+};
+
+}  // namespace quic
+}  // namespace owt
+
+#endif
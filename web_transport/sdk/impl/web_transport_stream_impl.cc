@@ -13,21 +13,67 @@
 // with modifications.
 
 #include "impl/web_transport_stream_impl.h"
+#include <algorithm>
 #include "base/logging.h"
 #include "base/synchronization/waitable_event.h"
+#include "impl/utilities.h"
 #include "net/third_party/quiche/src/quic/core/http/web_transport_stream_adapter.h"
+#include "net/third_party/quiche/src/quic/core/quic_stream.h"
+#include "net/third_party/quiche/src/quic/core/quic_stream_sequencer.h"
+#include "net/third_party/quiche/src/spdy/core/spdy_protocol.h"
 
 namespace owt {
 namespace quic {
 
+namespace {
+// Max number of readable regions reported by one OnDataAvailable.
+const size_t kMaxReadableRegions = 16;
+// Default urgency of HTTP/3 streams. Ref: RFC 9218 section 4.1.
+const int32_t kDefaultUrgency = 3;
+// Send order 0 is mapped to default urgency. Higher send orders are mapped to
+// more urgent priorities.
+const int32_t kMaxSendOrder = kDefaultUrgency - ::spdy::kV3HighestPriority;
+const int32_t kMinSendOrder = kDefaultUrgency - ::spdy::kV3LowestPriority;
+
+// ::quic::WebTransportStream of this QUIC version only reads data by copying
+// it, and ::quic::QuicStream only exposes its sequencer to subclasses. Push
+// mode reports readable regions of the sequencer in place, so the sequencer is
+// accessed through a member pointer named by this subclass. It's never
+// instantiated.
+class SequencerAccessor : public ::quic::QuicStream {
+ public:
+  static ::quic::QuicStreamSequencer* Get(::quic::QuicStream* stream) {
+    ::quic::QuicStreamSequencer* (::quic::QuicStream::*sequencer)() =
+        &SequencerAccessor::sequencer;
+    return (stream->*sequencer)();
+  }
+};
+}  // namespace
+
 class WebTransportStreamVisitorAdapter
     : public ::quic::WebTransportStreamVisitor {
  public:
-  explicit WebTransportStreamVisitorAdapter(
-      ::quic::WebTransportStreamVisitor* visitor)
+  explicit WebTransportStreamVisitorAdapter(WebTransportStreamImpl* visitor)
       : visitor_(visitor) {}
-  void OnCanRead() override { visitor_->OnCanRead(); }
-  void OnCanWrite() override { visitor_->OnCanWrite(); }
+  // The visitor is owned by the QUIC stream, so it's destroyed together with
+  // the QUIC stream.
+  ~WebTransportStreamVisitorAdapter() override {
+    if (visitor_) {
+      visitor_->OnQuicStreamDestroyed();
+    }
+  }
+  // Called when `visitor_` is destroyed before the QUIC stream.
+  void Detach() { visitor_ = nullptr; }
+  void OnCanRead() override {
+    if (visitor_) {
+      visitor_->OnCanRead();
+    }
+  }
+  void OnCanWrite() override {
+    if (visitor_) {
+      visitor_->OnCanWrite();
+    }
+  }
   void OnResetStreamReceived(::quic::WebTransportStreamError error) override {
     LOG(INFO)<<"OnResetStream received.";
     if (visitor_) {
@@ -39,45 +85,79 @@ class WebTransportStreamVisitorAdapter
       visitor_->OnStopSendingReceived(error);
     }
   }
-  void OnWriteSideInDataRecvdState() override {}
+  void OnWriteSideInDataRecvdState() override {
+    if (visitor_) {
+      visitor_->OnWriteSideInDataRecvdState();
+    }
+  }
 
  private:
-  ::quic::WebTransportStreamVisitor* visitor_;
+  WebTransportStreamImpl* visitor_;
 };
 
 WebTransportStreamImpl::WebTransportStreamImpl(
     ::quic::WebTransportStream* stream,
     ::quic::QuicStream* quic_stream,
     base::SingleThreadTaskRunner* io_runner,
-    base::SingleThreadTaskRunner* event_runner)
-    : stream_(stream),
+    base::SingleThreadTaskRunner* event_runner,
+    Delegate* delegate)
+    : id_(stream->GetStreamId()),
+      stream_(stream),
       quic_stream_(quic_stream),
+      visitor_adapter_(nullptr),
       io_runner_(io_runner),
       event_runner_(event_runner),
+      delegate_(delegate),
       visitor_(nullptr),
-      write_side_closed_(false) {
+      write_side_closed_(false),
+      fin_read_(false),
+      read_side_closed_(false),
+      write_blocked_(false),
+      read_pending_(false),
+      readable_bytes_(0),
+      buffered_data_bytes_(0),
+      can_write_(false),
+      push_mode_(false),
+      unconsumed_bytes_(0),
+      batched_events_(false),
+      closed_reported_(false),
+      has_pending_read_(false),
+      pending_read_({nullptr, 0, nullptr}) {
   CHECK(stream_);
   CHECK(quic_stream_);
   CHECK(io_runner_);
   CHECK(event_runner_);
-  stream_->SetVisitor(std::make_unique<WebTransportStreamVisitorAdapter>(this));
+  CHECK(delegate_);
+  auto visitor_adapter =
+      std::make_unique<WebTransportStreamVisitorAdapter>(this);
+  visitor_adapter_ = visitor_adapter.get();
+  stream_->SetVisitor(std::move(visitor_adapter));
+  PublishState();
 }
 
-WebTransportStreamImpl::~WebTransportStreamImpl() {}
+WebTransportStreamImpl::~WebTransportStreamImpl() {
+  if (visitor_adapter_) {
+    visitor_adapter_->Detach();
+  }
+  CancelPendingWrites();
+  CancelPendingRead();
+}
 
 uint32_t WebTransportStreamImpl::Id() const {
-  return stream_->GetStreamId();
+  return id_;
 }
 
 size_t WebTransportStreamImpl::Write(const uint8_t* data, size_t length) {
   DCHECK_EQ(sizeof(uint8_t), sizeof(char));
   CHECK(io_runner_);
   if (io_runner_->BelongsToCurrentThread()) {
-    if (write_side_closed_) {
+    if (write_side_closed_ || !pending_writes_.empty()) {
       return 0;
     }
-    return stream_->Write(
+    bool result = stream_->Write(
         absl::string_view(reinterpret_cast<const char*>(data), length));
+    PublishState();
+    return result ? length : 0;
   }
   bool result = false;
   base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
@@ -87,7 +167,8 @@ size_t WebTransportStreamImpl::Write(const uint8_t* data, size_t length) {
       base::BindOnce(
           [](base::WeakPtr<WebTransportStreamImpl> stream, const uint8_t* data,
              size_t& length, bool& result, base::WaitableEvent* event) {
-            if (!stream || stream->write_side_closed_) {
+            if (!stream || stream->write_side_closed_ ||
+                !stream->pending_writes_.empty()) {
               event->Signal();
               return;
             }
@@ -97,6 +178,7 @@ size_t WebTransportStreamImpl::Write(const uint8_t* data, size_t length) {
             } else {
               result = false;
             }
+            stream->PublishState();
             event->Signal();
           },
           weak_factory_.GetWeakPtr(), base::Unretained(data), std::ref(length),
@@ -113,7 +195,11 @@ void WebTransportStreamImpl::SetVisitor(
 size_t WebTransportStreamImpl::Read(uint8_t* data, size_t length) {
   DCHECK_EQ(sizeof(uint8_t), sizeof(char));
   if (io_runner_->BelongsToCurrentThread()) {
+    if (!stream_) {
+      return 0;
+    }
     auto read_result = stream_->Read(reinterpret_cast<char*>(data), length);
+    PublishState();
     // TODO: FIN is not handled.
     return read_result.bytes_read;
   }
@@ -125,12 +211,13 @@ size_t WebTransportStreamImpl::Read(uint8_t* data, size_t length) {
       base::BindOnce(
           [](base::WeakPtr<WebTransportStreamImpl> stream, uint8_t* data,
              size_t& length, size_t& result, base::WaitableEvent* event) {
-            if (!stream) {
+            if (!stream || !stream->stream_) {
               event->Signal();
               return;
             }
             auto read_result =
                 stream->stream_->Read(reinterpret_cast<char*>(data), length);
+            stream->PublishState();
             // TODO: FIN is not handled.
             result = read_result.bytes_read;
             event->Signal();
@@ -141,35 +228,388 @@ size_t WebTransportStreamImpl::Read(uint8_t* data, size_t length) {
   return result;
 }
 
-size_t WebTransportStreamImpl::ReadableBytes() const {
+AsyncIoStatus WebTransportStreamImpl::WriteAsync(const uint8_t* data,
+                                                 size_t length,
+                                                 WriteCallback* callback) {
+  CHECK(callback);
+  if (write_side_closed_) {
+    return AsyncIoStatus::kClosed;
+  }
+  if (write_blocked_) {
+    return AsyncIoStatus::kWouldBlock;
+  }
+  PendingWrite write = {data, length, callback, {}};
   if (io_runner_->BelongsToCurrentThread()) {
-    return stream_->ReadableBytes();
+    WriteAsyncOnCurrentThread(std::move(write));
+  } else {
+    io_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(&WebTransportStreamImpl::RunPendingWrite,
+                       weak_factory_.GetWeakPtr(), std::move(write)));
   }
-  size_t result = 0;
+  return AsyncIoStatus::kAccepted;
+}
+
+size_t WebTransportStreamImpl::Writev(const DataSpan* spans,
+                                      size_t span_count) {
+  size_t length = 0;
+  for (size_t i = 0; i < span_count; i++) {
+    length += spans[i].length;
+  }
+  if (length == 0) {
+    return 0;
+  }
+  std::vector<::quic::QuicMemSlice> slices;
+  slices.push_back(Utilities::CopyToMemSlice(spans, span_count));
+  if (io_runner_->BelongsToCurrentThread()) {
+    return WriteMemSlicesOnCurrentThread(std::move(slices)) ? length : 0;
+  }
+  bool result = false;
   base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
                            base::WaitableEvent::InitialState::NOT_SIGNALED);
-  io_runner_->PostTask(FROM_HERE,
-                       base::BindOnce(
-                           [](base::WeakPtr<WebTransportStreamImpl> stream,
-                              size_t& result, base::WaitableEvent* event) {
-                             if (!stream) {
-                               event->Signal();
-                               return;
-                             }
-                             result = stream->stream_->ReadableBytes();
-                             event->Signal();
-                           },
-                           weak_factory_.GetWeakPtr(), std::ref(result),
-                           base::Unretained(&done)));
+  io_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(
+          [](base::WeakPtr<WebTransportStreamImpl> stream,
+             std::vector<::quic::QuicMemSlice> slices, bool& result,
+             base::WaitableEvent* event) {
+            if (stream) {
+              result = stream->WriteMemSlicesOnCurrentThread(std::move(slices));
+            }
+            event->Signal();
+          },
+          weak_factory_.GetWeakPtr(), std::move(slices), std::ref(result),
+          base::Unretained(&done)));
   done.Wait();
-  return result;
+  return result ? length : 0;
+}
+
+bool WebTransportStreamImpl::WriteMemSlicesOnCurrentThread(
+    std::vector<::quic::QuicMemSlice> slices) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (write_side_closed_ || !pending_writes_.empty() || !stream_->CanWrite()) {
+    return false;
+  }
+  size_t length = 0;
+  for (const auto& slice : slices) {
+    length += slice.length();
+  }
+  // ::quic::WebTransportStream only accepts contiguous data, so slices are
+  // written to `quic_stream_` directly. Data is not copied.
+  ::quic::QuicConsumedData consumed =
+      quic_stream_->WriteMemSlices(absl::MakeSpan(slices), /*fin=*/false);
+  PublishState();
+  return consumed.bytes_consumed == length;
+}
+
+AsyncIoStatus WebTransportStreamImpl::WritevWithOwnership(
+    const DataSpan* spans,
+    size_t span_count,
+    BufferReleaser* releaser) {
+  CHECK(releaser);
+  if (write_side_closed_) {
+    return AsyncIoStatus::kClosed;
+  }
+  if (write_blocked_) {
+    return AsyncIoStatus::kWouldBlock;
+  }
+  PendingWrite write = {nullptr, 0, nullptr, {}};
+  for (size_t i = 0; i < span_count; i++) {
+    if (spans[i].length == 0) {
+      continue;
+    }
+    write.slices.push_back(
+        Utilities::WrapAsMemSlice(spans[i].data, spans[i].length, releaser));
+    write.length += spans[i].length;
+  }
+  if (write.slices.empty()) {
+    return AsyncIoStatus::kAccepted;
+  }
+  if (io_runner_->BelongsToCurrentThread()) {
+    WriteAsyncOnCurrentThread(std::move(write));
+  } else {
+    io_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(&WebTransportStreamImpl::RunPendingWrite,
+                       weak_factory_.GetWeakPtr(), std::move(write)));
+  }
+  return AsyncIoStatus::kAccepted;
+}
+
+// static
+void WebTransportStreamImpl::RunPendingWrite(
+    base::WeakPtr<WebTransportStreamImpl> stream,
+    PendingWrite write) {
+  if (stream) {
+    stream->WriteAsyncOnCurrentThread(std::move(write));
+    return;
+  }
+  // Owned slices are released when `write` is destroyed.
+  if (write.callback) {
+    write.callback->OnWriteCompleted(write.data, 0);
+  }
+}
+
+void WebTransportStreamImpl::WriteAsyncOnCurrentThread(PendingWrite write) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (write_side_closed_) {
+    // Owned slices are released when `write` is destroyed.
+    if (write.callback) {
+      write.callback->OnWriteCompleted(write.data, 0);
+    }
+    return;
+  }
+  pending_writes_.push_back(std::move(write));
+  FlushPendingWrites();
+}
+
+void WebTransportStreamImpl::FlushPendingWrites() {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  while (!pending_writes_.empty() && !write_side_closed_ &&
+         stream_->CanWrite()) {
+    PendingWrite write = std::move(pending_writes_.front());
+    pending_writes_.pop_front();
+    if (!write.slices.empty()) {
+      ::quic::QuicConsumedData consumed = quic_stream_->WriteMemSlices(
+          absl::MakeSpan(write.slices), /*fin=*/false);
+      DCHECK_EQ(consumed.bytes_consumed, write.length);
+      continue;
+    }
+    bool result = stream_->Write(absl::string_view(
+        reinterpret_cast<const char*>(write.data), write.length));
+    write.callback->OnWriteCompleted(write.data, result ? write.length : 0);
+  }
+  if (write_side_closed_) {
+    CancelPendingWrites();
+  }
+  PublishState();
+}
+
+void WebTransportStreamImpl::CancelPendingWrites() {
+  while (!pending_writes_.empty()) {
+    PendingWrite write = std::move(pending_writes_.front());
+    pending_writes_.pop_front();
+    if (write.callback) {
+      write.callback->OnWriteCompleted(write.data, 0);
+    }
+  }
+}
+
+AsyncIoStatus WebTransportStreamImpl::ReadAsync(uint8_t* data,
+                                                size_t length,
+                                                ReadCallback* callback) {
+  CHECK(callback);
+  if (fin_read_ || read_side_closed_) {
+    return AsyncIoStatus::kClosed;
+  }
+  if (read_pending_.exchange(true)) {
+    return AsyncIoStatus::kWouldBlock;
+  }
+  PendingRead read = {data, length, callback};
+  if (io_runner_->BelongsToCurrentThread()) {
+    ReadAsyncOnCurrentThread(read);
+  } else {
+    io_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(&WebTransportStreamImpl::RunPendingRead,
+                       weak_factory_.GetWeakPtr(), read));
+  }
+  return AsyncIoStatus::kAccepted;
+}
+
+// static
+void WebTransportStreamImpl::RunPendingRead(
+    base::WeakPtr<WebTransportStreamImpl> stream,
+    PendingRead read) {
+  if (stream) {
+    stream->ReadAsyncOnCurrentThread(read);
+    return;
+  }
+  read.callback->OnReadCompleted(read.data, 0, false);
+}
+
+void WebTransportStreamImpl::ReadAsyncOnCurrentThread(PendingRead read) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  DCHECK(!has_pending_read_);
+  if (read_side_closed_) {
+    // The stream is closed after accepting `read`.
+    read_pending_ = false;
+    read.callback->OnReadCompleted(read.data, 0, false);
+    return;
+  }
+  pending_read_ = read;
+  has_pending_read_ = true;
+  MaybeCompletePendingRead();
+}
+
+void WebTransportStreamImpl::MaybeCompletePendingRead() {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (!has_pending_read_) {
+    return;
+  }
+  auto read_result = stream_->Read(reinterpret_cast<char*>(pending_read_.data),
+                                   pending_read_.length);
+  if (read_result.bytes_read == 0 && !read_result.fin) {
+    return;
+  }
+  PublishState();
+  PendingRead read = pending_read_;
+  has_pending_read_ = false;
+  if (read_result.fin) {
+    fin_read_ = true;
+  }
+  // Allow the callback to submit next read.
+  read_pending_ = false;
+  read.callback->OnReadCompleted(read.data, read_result.bytes_read,
+                                 read_result.fin);
+}
+
+void WebTransportStreamImpl::CancelPendingRead() {
+  if (!has_pending_read_) {
+    return;
+  }
+  PendingRead read = pending_read_;
+  has_pending_read_ = false;
+  read_pending_ = false;
+  read.callback->OnReadCompleted(read.data, 0, false);
+}
+
+void WebTransportStreamImpl::SetPushMode(bool enabled) {
+  if (io_runner_->BelongsToCurrentThread()) {
+    SetPushModeOnCurrentThread(enabled);
+    return;
+  }
+  io_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&WebTransportStreamImpl::SetPushModeOnCurrentThread,
+                     weak_factory_.GetWeakPtr(), enabled));
+}
+
+void WebTransportStreamImpl::SetPushModeOnCurrentThread(bool enabled) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  push_mode_ = enabled;
+  if (push_mode_) {
+    DeliverReadableRegions();
+  }
+}
+
+void WebTransportStreamImpl::Consume(size_t bytes) {
+  if (io_runner_->BelongsToCurrentThread()) {
+    ConsumeOnCurrentThread(bytes);
+    return;
+  }
+  io_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&WebTransportStreamImpl::ConsumeOnCurrentThread,
+                                weak_factory_.GetWeakPtr(), bytes));
+}
+
+void WebTransportStreamImpl::ConsumeOnCurrentThread(size_t bytes) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (bytes > unconsumed_bytes_) {
+    LOG(ERROR) << "Consumed bytes exceed reported bytes.";
+    bytes = unconsumed_bytes_;
+  }
+  unconsumed_bytes_ -= bytes;
+  if (!quic_stream_) {
+    return;
+  }
+  if (bytes > 0) {
+    SequencerAccessor::Get(quic_stream_)->MarkConsumed(bytes);
+  }
+  PublishState();
+  if (!push_mode_ || unconsumed_bytes_ > 0) {
+    return;
+  }
+  // Next regions or FIN are reported in a separate task, so visitor is not
+  // called again before Consume returns.
+  io_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&WebTransportStreamImpl::DeliverReadableRegions,
+                     weak_factory_.GetWeakPtr()));
+}
+
+void WebTransportStreamImpl::DeliverReadableRegions() {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (fin_read_ || !quic_stream_) {
+    return;
+  }
+  ::quic::QuicStreamSequencer* sequencer =
+      SequencerAccessor::Get(quic_stream_);
+  if (sequencer->IsClosed()) {
+    // All data before FIN is consumed. Let `stream_` close its read side. No
+    // data is copied.
+    char unused;
+    stream_->Read(&unused, 0);
+    DeliverFin();
+    return;
+  }
+  iovec iov[kMaxReadableRegions];
+  int region_count = sequencer->GetReadableRegions(iov, kMaxReadableRegions);
+  if (region_count <= 0) {
+    return;
+  }
+  DataSpan regions[kMaxReadableRegions];
+  unconsumed_bytes_ = 0;
+  for (int i = 0; i < region_count; i++) {
+    regions[i].data = static_cast<const uint8_t*>(iov[i].iov_base);
+    regions[i].length = iov[i].iov_len;
+    unconsumed_bytes_ += iov[i].iov_len;
+  }
+  if (visitor_) {
+    visitor_->OnDataAvailable(regions, region_count, false);
+  }
+}
+
+void WebTransportStreamImpl::DeliverFin() {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (fin_read_) {
+    return;
+  }
+  fin_read_ = true;
+  PublishState();
+  if (visitor_) {
+    visitor_->OnDataAvailable(nullptr, 0, true);
+    visitor_->OnFinRead();
+  }
+}
+
+size_t WebTransportStreamImpl::ReadableBytes() const {
+  if (io_runner_->BelongsToCurrentThread()) {
+    return stream_ ? stream_->ReadableBytes() : 0;
+  }
+  return readable_bytes_.load(std::memory_order_acquire);
+}
+
+void WebTransportStreamImpl::SetSendOrder(int32_t send_order) {
+  if (io_runner_->BelongsToCurrentThread()) {
+    SetSendOrderOnCurrentThread(send_order);
+    return;
+  }
+  io_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&WebTransportStreamImpl::SetSendOrderOnCurrentThread,
+                     weak_factory_.GetWeakPtr(), send_order));
+}
+
+void WebTransportStreamImpl::SetSendOrderOnCurrentThread(int32_t send_order) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (!quic_stream_) {
+    return;
+  }
+  send_order = std::max(kMinSendOrder, std::min(kMaxSendOrder, send_order));
+  ::spdy::SpdyPriority urgency = kDefaultUrgency - send_order;
+  quic_stream_->SetPriority(::spdy::SpdyStreamPrecedence(urgency));
 }
 
 void WebTransportStreamImpl::Close() {
   if (io_runner_->BelongsToCurrentThread()) {
+    if (!stream_) {
+      return;
+    }
     if (!stream_->SendFin()) {
       LOG(ERROR) << "Failed to send FIN.";
     }
+    PublishState();
     return;
   }
   base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
@@ -178,13 +618,14 @@ void WebTransportStreamImpl::Close() {
       FROM_HERE, base::BindOnce(
                      [](base::WeakPtr<WebTransportStreamImpl> stream,
                         base::WaitableEvent* event) {
-                       if (!stream) {
+                       if (!stream || !stream->stream_) {
                          event->Signal();
                          return;
                        }
                        if (!stream->stream_->SendFin()) {
                          LOG(ERROR) << "Failed to send FIN.";
                        }
+                       stream->PublishState();
                        event->Signal();
                      },
                      weak_factory_.GetWeakPtr(), base::Unretained(&done)));
@@ -193,74 +634,115 @@ void WebTransportStreamImpl::Close() {
 
 uint64_t WebTransportStreamImpl::BufferedDataBytes() const {
   if (io_runner_->BelongsToCurrentThread()) {
-    return quic_stream_->BufferedDataBytes();
+    return quic_stream_ ? quic_stream_->BufferedDataBytes() : 0;
   }
-  uint64_t result = 0;
-  base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
-                           base::WaitableEvent::InitialState::NOT_SIGNALED);
-  io_runner_->PostTask(FROM_HERE,
-                       base::BindOnce(
-                           [](base::WeakPtr<WebTransportStreamImpl> stream,
-                              uint64_t& result, base::WaitableEvent* event) {
-                             if (!stream) {
-                               event->Signal();
-                               return;
-                             }
-                             result = stream->quic_stream_->BufferedDataBytes();
-                             event->Signal();
-                           },
-                           weak_factory_.GetWeakPtr(), std::ref(result),
-                           base::Unretained(&done)));
-  done.Wait();
-  return result;
+  return buffered_data_bytes_.load(std::memory_order_acquire);
 }
 
 bool WebTransportStreamImpl::CanWrite() const {
   if (io_runner_->BelongsToCurrentThread()) {
-    return stream_->CanWrite();
+    return stream_ && stream_->CanWrite();
   }
-  bool result = false;
-  base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
-                           base::WaitableEvent::InitialState::NOT_SIGNALED);
-  io_runner_->PostTask(FROM_HERE,
-                       base::BindOnce(
-                           [](base::WeakPtr<WebTransportStreamImpl> stream,
-                              bool& result, base::WaitableEvent* event) {
-                             if (!stream) {
-                               event->Signal();
-                               return;
-                             }
-                             result = stream->stream_->CanWrite();
-                             event->Signal();
-                           },
-                           weak_factory_.GetWeakPtr(), std::ref(result),
-                           base::Unretained(&done)));
-  done.Wait();
-  return result;
+  return can_write_.load(std::memory_order_acquire);
+}
+
+void WebTransportStreamImpl::PublishState() {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (!stream_) {
+    // Snapshot of a closed stream is published by OnQuicStreamDestroyed.
+    return;
+  }
+  bool can_write = !write_side_closed_ && stream_->CanWrite();
+  readable_bytes_.store(stream_->ReadableBytes(), std::memory_order_release);
+  buffered_data_bytes_.store(quic_stream_->BufferedDataBytes(),
+                             std::memory_order_release);
+  can_write_.store(can_write, std::memory_order_release);
+  write_blocked_.store(!can_write || !pending_writes_.empty(),
+                       std::memory_order_release);
 }
 
 void WebTransportStreamImpl::OnCanRead() {
+  PublishState();
+  if (push_mode_) {
+    DeliverReadableRegions();
+    return;
+  }
+  MaybeCompletePendingRead();
+  if (batched_events_) {
+    delegate_->OnStreamReady(this, true);
+    return;
+  }
   if (visitor_) {
     visitor_->OnCanRead();
   }
 }
 
 void WebTransportStreamImpl::OnCanWrite() {
+  FlushPendingWrites();
+  if (batched_events_) {
+    delegate_->OnStreamReady(this, false);
+    return;
+  }
   if (visitor_) {
     visitor_->OnCanWrite();
   }
 }
 
+void WebTransportStreamImpl::SetBatchedEvents(bool enabled) {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  batched_events_ = enabled;
+}
+
 void WebTransportStreamImpl::OnResetStreamReceived(
     ::quic::WebTransportStreamError error) {
   write_side_closed_ = true;
+  read_side_closed_ = true;
+  CancelPendingWrites();
+  CancelPendingRead();
+  PublishState();
 }
 
 void WebTransportStreamImpl::OnStopSendingReceived(
     ::quic::WebTransportStreamError error) {}
 
+void WebTransportStreamImpl::OnWriteSideInDataRecvdState() {
+  PublishState();
+}
+
+void WebTransportStreamImpl::OnQuicStreamDestroyed() {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  stream_ = nullptr;
+  quic_stream_ = nullptr;
+  visitor_adapter_ = nullptr;
+  write_side_closed_ = true;
+  fin_read_ = true;
+  read_side_closed_ = true;
+  can_write_ = false;
+  write_blocked_ = true;
+  readable_bytes_ = 0;
+  buffered_data_bytes_ = 0;
+  CancelPendingWrites();
+  CancelPendingRead();
+  MaybeReportClosed();
+  // `this` may be destroyed by delegate.
+  delegate_->OnStreamClosed(this);
+}
+
+void WebTransportStreamImpl::MaybeReportClosed() {
+  DCHECK(io_runner_->BelongsToCurrentThread());
+  if (stream_ || closed_reported_ || !visitor_) {
+    return;
+  }
+  closed_reported_ = true;
+  visitor_->OnClosed();
+}
+
 void WebTransportStreamImpl::OnSessionClosed() {
   write_side_closed_ = true;
+  read_side_closed_ = true;
+  CancelPendingWrites();
+  CancelPendingRead();
+  PublishState();
 }
 
 }  // namespace quic
@@ -15,26 +15,47 @@
 #ifndef OWT_QUIC_WEB_TRANSPORT_WEB_TRANSPORT_STREAM_IMPL_H_
 #define OWT_QUIC_WEB_TRANSPORT_WEB_TRANSPORT_STREAM_IMPL_H_
 
+#include <atomic>
+#include <vector>
+#include "base/containers/circular_deque.h"
 #include "base/memory/weak_ptr.h"
 #include "base/task/single_thread_task_runner.h"
 #include "base/threading/thread_checker.h"
 #include "impl/http3_server_stream.h"
 #include "net/third_party/quiche/src/quic/core/http/quic_spdy_stream.h"
+#include "net/third_party/quiche/src/quic/core/quic_mem_slice.h"
 #include "net/third_party/quiche/src/quic/core/web_transport_interface.h"
 #include "owt/quic/web_transport_stream_interface.h"
 
 namespace owt {
 namespace quic {
 
+class WebTransportStreamVisitorAdapter;
+
 // WebTransportStreamImpl is a proxy for ::quic::WebTransportStream. All calls
 // to ::quic::WebTransportStream run in runner_.
 class WebTransportStreamImpl : public WebTransportStreamInterface,
                                public ::quic::WebTransportStreamVisitor {
  public:
+  // Owner of WebTransportStreamImpl.
+  class Delegate {
+   public:
+    virtual ~Delegate() = default;
+    // Called on IO thread when the underlying QUIC stream is destroyed. The
+    // delegate is expected to destroy `stream` synchronously, unless its
+    // visitor hasn't seen the stream yet. Methods of a closed stream fail
+    // without accessing the QUIC stream.
+    virtual void OnStreamClosed(WebTransportStreamImpl* stream) = 0;
+    // Called on IO thread instead of visitor's OnCanRead and OnCanWrite when
+    // batched events are enabled.
+    virtual void OnStreamReady(WebTransportStreamImpl* stream, bool readable) {}
+  };
+
   explicit WebTransportStreamImpl(::quic::WebTransportStream* stream,
                                   ::quic::QuicStream* quic_stream,
                                   base::SingleThreadTaskRunner* io_runner,
-                                  base::SingleThreadTaskRunner* event_runner);
+                                  base::SingleThreadTaskRunner* event_runner,
+                                  Delegate* delegate);
   ~WebTransportStreamImpl() override;
 
   // Overrides WebTransportStreamInterface.
@@ -43,33 +64,132 @@ class WebTransportStreamImpl : public WebTransportStreamInterface,
   uint32_t Id() const override;
   size_t Write(const uint8_t* data, size_t length) override;
   size_t Read(uint8_t* data, size_t length) override;
+  size_t Writev(const DataSpan* spans, size_t span_count) override;
+  AsyncIoStatus WritevWithOwnership(const DataSpan* spans,
+                                    size_t span_count,
+                                    BufferReleaser* releaser) override;
+  AsyncIoStatus WriteAsync(const uint8_t* data,
+                           size_t length,
+                           WriteCallback* callback) override;
+  AsyncIoStatus ReadAsync(uint8_t* data,
+                          size_t length,
+                          ReadCallback* callback) override;
+  void SetPushMode(bool enabled) override;
+  void Consume(size_t bytes) override;
   size_t ReadableBytes() const override;
+  void SetSendOrder(int32_t send_order) override;
   void Close() override;
   uint64_t BufferedDataBytes() const override;
   bool CanWrite() const override;
 
   void OnSessionClosed();
+  // Reports readiness events to delegate instead of visitor when `enabled`.
+  // Only called on IO thread.
+  void SetBatchedEvents(bool enabled);
+  // Called when `stream_` and `quic_stream_` are destroyed. This object may be
+  // destroyed by `delegate_` before this method returns.
+  void OnQuicStreamDestroyed();
+  // Returns true if the underlying QUIC stream is destroyed. Only called on IO
+  // thread.
+  bool IsClosed() const { return !stream_; }
+  // Calls visitor's OnClosed if the stream is closed and it's not reported yet.
+  // For visitors set after the stream is closed.
+  void MaybeReportClosed();
 
   // Overrides ::quic::WebTransportStreamVisitor.
   void OnCanRead() override;
   void OnCanWrite() override;
   void OnResetStreamReceived(::quic::WebTransportStreamError error) override;
   void OnStopSendingReceived(::quic::WebTransportStreamError error) override;
-  void OnWriteSideInDataRecvdState() override {}
+  void OnWriteSideInDataRecvdState() override;
 
  private:
+  struct PendingWrite {
+    const uint8_t* data;
+    size_t length;
+    WriteCallback* callback;
+    // Data of WritevWithOwnership. `data` and `callback` are not used if it's
+    // not empty.
+    std::vector<::quic::QuicMemSlice> slices;
+  };
+  struct PendingRead {
+    uint8_t* data;
+    size_t length;
+    ReadCallback* callback;
+  };
+
   void OnCanReadOnCurrentThread();
   void OnCanWriteOnCurrentThread();
+  // Runs an asynchronous operation posted to IO thread, or fails it if
+  // `stream` is destroyed after accepting it.
+  static void RunPendingWrite(base::WeakPtr<WebTransportStreamImpl> stream,
+                              PendingWrite write);
+  static void RunPendingRead(base::WeakPtr<WebTransportStreamImpl> stream,
+                             PendingRead read);
+  void WriteAsyncOnCurrentThread(PendingWrite write);
+  // Writes `slices` as a whole. Returns true on success.
+  bool WriteMemSlicesOnCurrentThread(std::vector<::quic::QuicMemSlice> slices);
+  void ReadAsyncOnCurrentThread(PendingRead read);
+  // Writes pending asynchronous writes until the stream is blocked.
+  void FlushPendingWrites();
+  // Completes pending asynchronous read if data or FIN is available.
+  void MaybeCompletePendingRead();
+  // Fails all pending asynchronous operations.
+  void CancelPendingWrites();
+  void CancelPendingRead();
+  void SetPushModeOnCurrentThread(bool enabled);
+  void SetSendOrderOnCurrentThread(int32_t send_order);
+  void ConsumeOnCurrentThread(size_t bytes);
+  // Reports readable regions, or FIN after all data is consumed, to visitor in
+  // push mode.
+  void DeliverReadableRegions();
+  // Reports FIN to visitor in push mode.
+  void DeliverFin();
+  // Publishes a snapshot of stream state for other threads. It's called after
+  // every read, write and stream event on IO thread.
+  void PublishState();
 
+  uint32_t id_;
   ::quic::WebTransportStream* stream_;
   // `stream_` is supposed to be an instance of `WebTransportStreamAdapter`,
   // which holds a pointer to `QuicStream`. However, the `QuicStream` associated
   // is not public, so we maintain a pointer to `QuicStream` here.
   ::quic::QuicStream* quic_stream_;
+  // Owned by `stream_`. It's detached when this object is destroyed before
+  // `stream_`.
+  WebTransportStreamVisitorAdapter* visitor_adapter_;
   base::SingleThreadTaskRunner* io_runner_;
   base::SingleThreadTaskRunner* event_runner_;
+  Delegate* delegate_;
   owt::quic::WebTransportStreamInterface::Visitor* visitor_;
-  bool write_side_closed_;
+  // Following flags are written on IO thread, but they can be read on any
+  // thread for asynchronous operations.
+  std::atomic<bool> write_side_closed_;
+  std::atomic<bool> fin_read_;
+  // True if no more data can be read because the stream is reset, or the
+  // session is closed.
+  std::atomic<bool> read_side_closed_;
+  // True if asynchronous writes cannot be accepted right now. Updated on IO
+  // thread after writes and OnCanWrite.
+  std::atomic<bool> write_blocked_;
+  // True if an asynchronous read is submitted but not completed yet.
+  std::atomic<bool> read_pending_;
+  // Snapshot of stream state published by PublishState. ReadableBytes,
+  // BufferedDataBytes and CanWrite return these values when they are called
+  // on other threads.
+  std::atomic<size_t> readable_bytes_;
+  std::atomic<uint64_t> buffered_data_bytes_;
+  std::atomic<bool> can_write_;
+  // Following members are only accessed on IO thread.
+  bool push_mode_;
+  // Bytes reported by the last OnDataAvailable but not consumed yet. Next
+  // regions are reported when they are all consumed.
+  size_t unconsumed_bytes_;
+  bool batched_events_;
+  bool closed_reported_;
+  base::circular_deque<PendingWrite> pending_writes_;
+  bool has_pending_read_;
+  PendingRead pending_read_;
   base::WeakPtrFactory<WebTransportStreamImpl> weak_factory_{this};
 };
 }  // namespace quic
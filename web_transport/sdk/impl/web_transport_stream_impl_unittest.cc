@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2021 Intel Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "impl/web_transport_stream_impl.h"
+#include <memory>
+#include <vector>
+#include "base/test/task_environment.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "net/third_party/quiche/src/quic/core/http/quic_spdy_stream.h"
+#include "net/third_party/quiche/src/quic/test_tools/quic_session_peer.h"
+#include "net/third_party/quiche/src/quic/test_tools/quic_test_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace owt {
+namespace quic {
+namespace test {
+
+namespace {
+class TestStream : public ::quic::QuicSpdyStream {
+ public:
+  TestStream(::quic::QuicStreamId id, ::quic::QuicSpdySession* session)
+      : ::quic::QuicSpdyStream(id, session, ::quic::BIDIRECTIONAL) {}
+
+  void OnBodyAvailable() override {}
+};
+}  // namespace
+
+class WebTransportStreamImplTest : public testing::Test,
+                                   public WebTransportStreamImpl::Delegate {
+ public:
+  WebTransportStreamImplTest()
+      : connection_(new ::quic::test::MockQuicConnection(
+            &helper_,
+            &alarm_factory_,
+            ::quic::Perspective::IS_SERVER,
+            ::quic::test::SupportedVersions(
+                ::quic::ParsedQuicVersion::RFCv1()))),
+        session_(connection_) {
+    session_.Initialize();
+  }
+
+  ~WebTransportStreamImplTest() override {
+    // Destroys QUIC streams before the session. Stream proxies are destroyed
+    // by OnStreamClosed.
+    quic_streams_.clear();
+  }
+
+  // Overrides WebTransportStreamImpl::Delegate.
+  void OnStreamClosed(WebTransportStreamImpl* stream) override {
+    for (auto it = streams_.begin(); it != streams_.end(); ++it) {
+      if (it->get() == stream) {
+        streams_.erase(it);
+        return;
+      }
+    }
+  }
+
+ protected:
+  // Creates a WebTransport data stream and its proxy. Returns the proxy.
+  WebTransportStreamImpl* CreateStream() {
+    auto quic_stream = std::make_unique<TestStream>(
+        ::quic::test::GetNthServerInitiatedBidirectionalStreamId(
+            connection_->transport_version(), quic_streams_.size()),
+        &session_);
+    quic_stream->ConvertToWebTransportDataStream(/*session_id=*/0);
+    auto runner = base::ThreadTaskRunnerHandle::Get();
+    streams_.push_back(std::make_unique<WebTransportStreamImpl>(
+        quic_stream->web_transport_stream(), quic_stream.get(), runner.get(),
+        runner.get(), this));
+    quic_streams_.push_back(std::move(quic_stream));
+    return streams_.back().get();
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  ::quic::test::MockQuicConnectionHelper helper_;
+  ::quic::test::MockAlarmFactory alarm_factory_;
+  ::quic::test::MockQuicConnection* connection_;  // Owned by `session_`.
+  ::quic::test::MockQuicSpdySession session_;
+  std::vector<std::unique_ptr<TestStream>> quic_streams_;
+  std::vector<std::unique_ptr<WebTransportStreamImpl>> streams_;
+};
+
+TEST_F(WebTransportStreamImplTest, SendOrderSetsPriority) {
+  WebTransportStreamImpl* stream = CreateStream();
+  TestStream* quic_stream = quic_streams_.back().get();
+  EXPECT_EQ(quic_stream->precedence().spdy3_priority(), 3);
+  stream->SetSendOrder(1);
+  EXPECT_EQ(quic_stream->precedence().spdy3_priority(), 2);
+  stream->SetSendOrder(-2);
+  EXPECT_EQ(quic_stream->precedence().spdy3_priority(), 5);
+  // Out of range send orders are clamped.
+  stream->SetSendOrder(100);
+  EXPECT_EQ(quic_stream->precedence().spdy3_priority(), 0);
+  stream->SetSendOrder(-100);
+  EXPECT_EQ(quic_stream->precedence().spdy3_priority(), 7);
+}
+
+TEST_F(WebTransportStreamImplTest, HigherSendOrderIsWrittenFirst) {
+  WebTransportStreamImpl* low = CreateStream();
+  WebTransportStreamImpl* high = CreateStream();
+  low->SetSendOrder(-1);
+  high->SetSendOrder(1);
+  ::quic::QuicWriteBlockedList* write_blocked_streams =
+      ::quic::test::QuicSessionPeer::GetWriteBlockedStreams(&session_);
+  write_blocked_streams->AddStream(low->Id());
+  write_blocked_streams->AddStream(high->Id());
+  EXPECT_EQ(write_blocked_streams->PopFront(), high->Id());
+  EXPECT_EQ(write_blocked_streams->PopFront(), low->Id());
+}
+
+TEST_F(WebTransportStreamImplTest, QuicStreamOutlivesProxy) {
+  CreateStream();
+  ASSERT_EQ(streams_.size(), 1u);
+  // A session destroys its stream proxies when it's closed, before QUIC
+  // streams are destroyed.
+  streams_.clear();
+  quic_streams_.back()->OnCanWrite();
+  quic_streams_.clear();
+}
+
+TEST_F(WebTransportStreamImplTest, ProxyIsClosedWithQuicStream) {
+  CreateStream();
+  ASSERT_EQ(streams_.size(), 1u);
+  quic_streams_.clear();
+  EXPECT_TRUE(streams_.empty());
+}
+
+}  // namespace test
+}  // namespace quic
+}  // namespace owt